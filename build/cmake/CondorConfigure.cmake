@@ -472,6 +472,10 @@ if( NOT WINDOWS)
 	endif()
 
     find_multiple( "z" ZLIB_FOUND)
+	find_path(HAVE_ZLIB_H "zlib.h")
+	if (ZLIB_FOUND AND HAVE_ZLIB_H)
+		set( HAVE_LIBZ ON )
+	endif()
 	find_multiple( "expat" EXPAT_FOUND )
 	find_multiple( "uuid" LIBUUID_FOUND )
 		# UUID appears to be available in the C runtime on Darwin.
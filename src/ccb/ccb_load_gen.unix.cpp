@@ -0,0 +1,247 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Synthetic load for a CCB server.
+//
+// usage: ccb_load_gen <ccb address> [targets] [heartbeat interval] [seconds]
+//
+// Registers the given number of fake target daemons (default 1000) with
+// the CCB server, then has each of them send a heartbeat every interval
+// (default 10s) for the given time (default 60s), spread evenly over the
+// interval.  CCB requests forwarded to the fake targets are refused.
+// Prints the registration rate and the heartbeat round trip times.
+// Raise the open file limit to run with many targets.
+
+#include "condor_common.h"
+
+#include "condor_config.h"
+#include "condor_debug.h"
+#include "condor_attributes.h"
+#include "condor_commands.h"
+#include "daemon.h"
+#include "reli_sock.h"
+#include "selector.h"
+#include "condor_classad.h"
+
+#include <chrono>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct FakeTarget {
+	ReliSock *sock;
+	std::string ccbid;
+	bool heartbeat_pending;
+	Clock::time_point heartbeat_sent;
+};
+
+static bool
+register_target( char const *ccb_address, int n, FakeTarget &target )
+{
+	Daemon ccb( DT_COLLECTOR, ccb_address );
+	CondorError errstack;
+	target.sock = (ReliSock *)ccb.startCommand( CCB_REGISTER, Stream::reli_sock, 20, &errstack,
+	                                            NULL, false, USE_TMP_SEC_SESSION );
+	if( !target.sock ) {
+		fprintf( stderr, "failed to connect to %s: %s\n", ccb_address, errstack.getFullText().c_str() );
+		return false;
+	}
+
+	ClassAd msg;
+	std::string name;
+	formatstr( name, "ccb_load_gen target %d", n );
+	msg.Assign( ATTR_COMMAND, CCB_REGISTER );
+	msg.Assign( ATTR_NAME, name );
+
+	target.sock->encode();
+	if( !putClassAd( target.sock, msg ) || !target.sock->end_of_message() ) {
+		fprintf( stderr, "failed to send registration of target %d\n", n );
+		return false;
+	}
+
+	ClassAd reply;
+	target.sock->decode();
+	if( !getClassAd( target.sock, reply ) || !target.sock->end_of_message() ||
+		!reply.LookupString( ATTR_CCBID, target.ccbid ) )
+	{
+		fprintf( stderr, "failed to receive registration reply for target %d\n", n );
+		return false;
+	}
+	target.heartbeat_pending = false;
+	return true;
+}
+
+static bool
+send_heartbeat( FakeTarget &target )
+{
+	ClassAd msg;
+	msg.Assign( ATTR_COMMAND, ALIVE );
+	target.sock->encode();
+	if( !putClassAd( target.sock, msg ) || !target.sock->end_of_message() ) {
+		return false;
+	}
+	target.heartbeat_pending = true;
+	target.heartbeat_sent = Clock::now();
+	return true;
+}
+
+	// returns the heartbeat round trip time, 0 for other messages,
+	// or -1 on error
+static double
+read_msg( FakeTarget &target )
+{
+	ClassAd msg;
+	target.sock->decode();
+	if( !getClassAd( target.sock, msg ) || !target.sock->end_of_message() ) {
+		return -1;
+	}
+
+	int cmd = 0;
+	msg.LookupInteger( ATTR_COMMAND, cmd );
+	if( cmd == ALIVE ) {
+		if( !target.heartbeat_pending ) {
+			return 0;
+		}
+		target.heartbeat_pending = false;
+		return std::chrono::duration<double>( Clock::now() - target.heartbeat_sent ).count();
+	}
+	if( cmd == CCB_REQUEST ) {
+		std::string request_id, connect_id;
+		msg.LookupString( ATTR_REQUEST_ID, request_id );
+		msg.LookupString( ATTR_CLAIM_ID, connect_id );
+
+		ClassAd reply;
+		reply.Assign( ATTR_RESULT, false );
+		reply.Assign( ATTR_ERROR_STRING, "ccb_load_gen targets do not connect back" );
+		reply.Assign( ATTR_REQUEST_ID, request_id );
+		reply.Assign( ATTR_CLAIM_ID, connect_id );
+		target.sock->encode();
+		if( !putClassAd( target.sock, reply ) || !target.sock->end_of_message() ) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int main( int argc, char *argv[] )
+{
+	if( argc < 2 ) {
+		fprintf( stderr, "usage: %s <ccb address> [targets] [heartbeat interval] [seconds]\n", argv[0] );
+		return 1;
+	}
+	char const *ccb_address = argv[1];
+	int num_targets = argc > 2 ? atoi( argv[2] ) : 1000;
+	int interval = argc > 3 ? atoi( argv[3] ) : 10;
+	int duration = argc > 4 ? atoi( argv[4] ) : 60;
+	if( num_targets <= 0 || interval <= 0 || duration <= 0 ) {
+		fprintf( stderr, "usage: %s <ccb address> [targets] [heartbeat interval] [seconds]\n", argv[0] );
+		return 1;
+	}
+
+	config();
+
+	std::vector<FakeTarget> targets( num_targets );
+
+	auto start = Clock::now();
+	for( int i = 0; i < num_targets; i++ ) {
+		if( !register_target( ccb_address, i, targets[i] ) ) {
+			num_targets = i;
+			targets.resize( i );
+			break;
+		}
+	}
+	std::chrono::duration<double> elapsed = Clock::now() - start;
+	printf( "registered %d targets in %.3fs: %.1f/s\n", num_targets, elapsed.count(),
+			elapsed.count() > 0 ? num_targets / elapsed.count() : 0.0 );
+	if( num_targets == 0 ) {
+		return 1;
+	}
+
+	long heartbeats_sent = 0, heartbeats_received = 0, failures = 0;
+	double rtt_sum = 0, rtt_max = 0;
+
+	auto begin = Clock::now();
+	auto end = begin + std::chrono::seconds( duration );
+	auto per_target = std::chrono::duration<double>( (double)interval / num_targets );
+	long next = 0;  // total number of heartbeats due so far
+
+	Selector selector;
+	while( Clock::now() < end ) {
+			// send the heartbeats that are due, round robin
+		long due = (long)( std::chrono::duration<double>( Clock::now() - begin ) / per_target ) + 1;
+		for( ; next < due; next++ ) {
+			FakeTarget &target = targets[next % num_targets];
+			if( !target.sock || target.heartbeat_pending ) {
+				continue;
+			}
+			if( !send_heartbeat( target ) ) {
+				failures++;
+				delete target.sock;
+				target.sock = NULL;
+				continue;
+			}
+			heartbeats_sent++;
+		}
+
+		selector.reset();
+		selector.set_timeout( 0, 10000 );
+		for( auto &target : targets ) {
+			if( target.sock ) {
+				selector.add_fd( target.sock->get_file_desc(), Selector::IO_READ );
+			}
+		}
+		selector.execute();
+		if( selector.failed() ) {
+			fprintf( stderr, "select failed: %s\n", strerror( selector.select_errno() ) );
+			return 1;
+		}
+		if( !selector.has_ready() ) {
+			continue;
+		}
+		for( auto &target : targets ) {
+			if( !target.sock || !selector.fd_ready( target.sock->get_file_desc(), Selector::IO_READ ) ) {
+				continue;
+			}
+			double rtt = read_msg( target );
+			if( rtt < 0 ) {
+				failures++;
+				delete target.sock;
+				target.sock = NULL;
+				continue;
+			}
+			if( rtt > 0 ) {
+				heartbeats_received++;
+				rtt_sum += rtt;
+				if( rtt > rtt_max ) {
+					rtt_max = rtt;
+				}
+			}
+		}
+	}
+
+	printf( "heartbeats sent %ld, answered %ld, round trip avg %.3fms max %.3fms, disconnected targets %ld\n",
+			heartbeats_sent, heartbeats_received,
+			heartbeats_received ? 1000 * rtt_sum / heartbeats_received : 0.0,
+			1000 * rtt_max, failures );
+
+	for( auto &target : targets ) {
+		delete target.sock;
+	}
+	return 0;
+}
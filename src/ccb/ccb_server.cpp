@@ -79,6 +79,8 @@ CCBServer::CCBServer():
 	m_next_request_id(1),
 	m_read_buffer_size(0),
 	m_write_buffer_size(0),
+	m_nonblocking_writes(true),
+	m_defer_heartbeats(false),
 	m_requests(ccbid_hash),
 	m_polling_timer(-1),
 	m_epfd(-1)
@@ -161,6 +163,7 @@ CCBServer::InitAndReconfig()
 
 	m_read_buffer_size = param_integer("CCB_SERVER_READ_BUFFER",2*1024);
 	m_write_buffer_size = param_integer("CCB_SERVER_WRITE_BUFFER",2*1024);
+	m_nonblocking_writes = param_boolean("CCB_SERVER_NONBLOCKING_WRITES",true);
 
 	m_last_reconnect_info_sweep = time(NULL);
 
@@ -308,13 +311,14 @@ CCBServer::EpollSockets(int)
 		m_epfd = -1;
 		return -1;
 	}
-	struct epoll_event events[10];
+	struct epoll_event events[64];
 	bool needs_poll = true;
 	unsigned counter = 0;
+	m_defer_heartbeats = true;
 	while (needs_poll && counter++ < 100)
 	{
 		needs_poll = false;
-		int result = epoll_wait(epfd, events, 10, 0);
+		int result = epoll_wait(epfd, events, 64, 0);
 		if (result > 0)
 		{
 			for (int idx=0; idx<result; idx++)
@@ -326,9 +330,17 @@ CCBServer::EpollSockets(int)
 					dprintf(D_FULLDEBUG, "No target found for CCBID %ld.\n", id);
 					continue;
 				}
-				if (target->getSock()->readReady())
+				if ((events[idx].events & EPOLLIN) && target->getSock()->readReady())
 				{
 					HandleRequestResultsMsg(target);
+						// the target may have disconnected
+					if (m_targets.lookup(id, target) == -1) {
+						continue;
+					}
+				}
+				if ((events[idx].events & (EPOLLOUT|EPOLLERR|EPOLLHUP)) && target->writePending())
+				{
+					FlushTarget(target);
 				}
 			}
 			// We always want to drain out the queue of events.
@@ -340,6 +352,8 @@ CCBServer::EpollSockets(int)
 		}
 			// Fall through silently on timeout or signal interrupt; DC will call us later.
 	}
+	m_defer_heartbeats = false;
+	SendHeartbeatResponses();
 #endif
 	return 0;
 }
@@ -392,6 +406,31 @@ CCBServer::EpollRemove(CCBTarget *target)
 #endif
 }
 
+bool
+CCBServer::EpollWatchWrites(CCBTarget *target, bool watch)
+{
+	if ((-1 == m_epfd) || !target) {return false;}
+#ifdef CONDOR_HAVE_EPOLL
+	int epfd = -1;
+	if (daemonCore->Get_Pipe_FD(m_epfd, &epfd) == FALSE || epfd == -1) {
+		dprintf(D_ALWAYS, "Unable to lookup epoll FD\n");
+		return false;
+	}
+	struct epoll_event event;
+	event.events = watch ? (EPOLLIN|EPOLLOUT) : EPOLLIN;
+	event.data.u64 = target->getCCBID();
+	if (-1 == epoll_ctl(epfd, EPOLL_CTL_MOD, target->getSock()->get_file_desc(), &event))
+	{
+		dprintf(D_ALWAYS, "CCB: failed to modify watch for target daemon %s with ccbid %lu: %s (errno=%d).\n", target->getSock()->peer_description(), target->getCCBID(), strerror(errno), errno);
+		return false;
+	}
+	return true;
+#else
+	(void)watch;
+	return false;
+#endif
+}
+
 void
 CCBServer::PollSockets()
 {
@@ -404,12 +443,15 @@ CCBServer::PollSockets()
 	if (m_epfd == -1)
 	{
 		CCBTarget *target=NULL;
+		m_defer_heartbeats = true;
 		m_targets.startIterations();
 		while( m_targets.iterate(target) ) {
 			if( target->getSock()->readReady() ) {
 				HandleRequestResultsMsg(target);
 			}
 		}
+		m_defer_heartbeats = false;
+		SendHeartbeatResponses();
 	}
 
 	// periodically call the following
@@ -632,7 +674,12 @@ CCBServer::HandleRequestResultsMsg( CCBTarget *target )
 
 	int command = 0;
 	if( msg.LookupInteger( ATTR_COMMAND, command ) && command == ALIVE ) {
-		SendHeartbeatResponse( target );
+		if( m_defer_heartbeats ) {
+			m_heartbeats.push_back( target->getCCBID() );
+		}
+		else {
+			SendHeartbeatResponse( target );
+		}
 		return;
 	}
 
@@ -725,6 +772,38 @@ CCBServer::HandleRequestResultsMsg( CCBTarget *target )
 	RequestFinished( request, success, error_msg.c_str() );
 }
 
+void
+CCBServer::SendHeartbeatResponses()
+{
+	if( m_heartbeats.empty() ) {
+		return;
+	}
+
+	ClassAd msg;
+	msg.Assign( ATTR_COMMAND, ALIVE );
+
+	size_t sent = 0;
+	for( auto itr = m_heartbeats.begin(); itr != m_heartbeats.end(); itr++ ) {
+		CCBTarget *target = GetTarget( *itr );
+		if( !target ) {
+			continue; // disconnected since sending its heartbeat
+		}
+		if( !WriteMsgToTarget( target, msg ) ) {
+			dprintf(D_ALWAYS,
+					"CCB: failed to send heartbeat to target "
+					"daemon %s with ccbid %lu\n",
+					target->getSock()->peer_description(),
+					target->getCCBID());
+			RemoveTarget( target );
+			continue;
+		}
+		sent++;
+	}
+	dprintf(D_FULLDEBUG,"CCB: sent %lu heartbeats to targets\n",
+			(unsigned long)sent);
+	m_heartbeats.clear();
+}
+
 void
 CCBServer::SendHeartbeatResponse( CCBTarget *target )
 {
@@ -732,8 +811,7 @@ CCBServer::SendHeartbeatResponse( CCBTarget *target )
 
 	ClassAd msg;
 	msg.Assign( ATTR_COMMAND, ALIVE );
-	sock->encode();
-	if( !putClassAd( sock, msg ) || !sock->end_of_message() ) {
+	if( !WriteMsgToTarget( target, msg ) ) {
 		dprintf(D_ALWAYS,
 				"CCB: failed to send heartbeat to target "
 				"daemon %s with ccbid %lu\n",
@@ -750,8 +828,6 @@ CCBServer::SendHeartbeatResponse( CCBTarget *target )
 void
 CCBServer::ForwardRequestToTarget( CCBServerRequest *request, CCBTarget *target )
 {
-	Sock *sock = target->getSock();
-
 	ClassAd msg;
 	msg.Assign( ATTR_COMMAND, CCB_REQUEST );
 	msg.Assign( ATTR_MY_ADDRESS, request->getReturnAddr() );
@@ -763,8 +839,7 @@ CCBServer::ForwardRequestToTarget( CCBServerRequest *request, CCBTarget *target
 	CCBIDToString( request->getRequestID(), reqid_str);
 	msg.Assign( ATTR_REQUEST_ID, reqid_str );
 
-	sock->encode();
-	if( !putClassAd( sock, msg ) || !sock->end_of_message() ) {
+	if( !WriteMsgToTarget( target, msg ) ) {
 		dprintf(D_ALWAYS,
 				"CCB: failed to forward request id %lu from %s to target "
 				"daemon %s with ccbid %lu\n",
@@ -783,6 +858,75 @@ CCBServer::ForwardRequestToTarget( CCBServerRequest *request, CCBTarget *target
 		// now, if it has not already been registered.
 }
 
+bool
+CCBServer::WriteMsgToTarget( CCBTarget *target, ClassAd &msg )
+{
+	if( target->writePending() ) {
+		target->queueMsg( msg );
+		return true;
+	}
+
+	ReliSock *sock = static_cast<ReliSock *>(target->getSock());
+	sock->encode();
+
+	if( !m_nonblocking_writes || m_epfd == -1 ) {
+		return putClassAd( sock, msg ) && sock->end_of_message();
+	}
+
+		// Do not wait for a busy target to drain its socket; leave
+		// the rest of the message in our buffer and send it from
+		// EpollSockets() when the socket becomes writable.
+	if( !putClassAd( sock, msg, PUT_CLASSAD_NON_BLOCKING ) ) {
+		return false;
+	}
+	int rc = sock->end_of_message_nonblocking();
+	if( sock->clear_backlog_flag() ) {
+		target->setWritePending( true );
+			// if we cannot hear when it is writable, give up on it;
+			// the target will reconnect
+		return EpollWatchWrites( target, true );
+	}
+	return rc == TRUE;
+}
+
+void
+CCBServer::FlushTarget( CCBTarget *target )
+{
+	ReliSock *sock = static_cast<ReliSock *>(target->getSock());
+
+	sock->encode();
+	int rc = sock->finish_end_of_message();
+	if( sock->clear_backlog_flag() ) {
+		return; // still more to send
+	}
+	target->setWritePending( false );
+	if( !rc ) {
+		dprintf(D_ALWAYS,
+				"CCB: failed to send message to target daemon %s "
+				"with ccbid %lu\n",
+				sock->peer_description(),
+				target->getCCBID());
+		RemoveTarget( target );
+		return;
+	}
+
+	ClassAd msg;
+	while( !target->writePending() && target->nextQueuedMsg( msg ) ) {
+		if( !WriteMsgToTarget( target, msg ) ) {
+			dprintf(D_ALWAYS,
+					"CCB: failed to send message to target daemon %s "
+					"with ccbid %lu\n",
+					sock->peer_description(),
+					target->getCCBID());
+			RemoveTarget( target );
+			return;
+		}
+	}
+	if( !target->writePending() ) {
+		EpollWatchWrites( target, false );
+	}
+}
+
 void
 CCBServer::RequestReply( Sock *sock, bool success, char const *error_msg, CCBID request_cid, CCBID target_cid )
 {
@@ -1085,6 +1229,8 @@ CCBTarget::CCBTarget(Sock *sock):
 	m_ccbid(-1),
 	m_pending_request_results(0),
 	m_socket_is_registered(false),
+	m_write_pending(false),
+	m_queued_msgs(NULL),
 	m_requests(NULL)
 {
 }
@@ -1100,6 +1246,33 @@ CCBTarget::~CCBTarget()
 	if( m_requests ) {
 		delete m_requests;
 	}
+	if( m_queued_msgs ) {
+		delete m_queued_msgs;
+	}
+}
+
+void
+CCBTarget::queueMsg(ClassAd &msg)
+{
+	if( !m_queued_msgs ) {
+		m_queued_msgs = new std::deque<ClassAd>;
+	}
+	m_queued_msgs->push_back( msg );
+}
+
+bool
+CCBTarget::nextQueuedMsg(ClassAd &msg)
+{
+	if( !m_queued_msgs ) {
+		return false;
+	}
+	msg = m_queued_msgs->front();
+	m_queued_msgs->pop_front();
+	if( m_queued_msgs->empty() ) {
+		delete m_queued_msgs;
+		m_queued_msgs = NULL;
+	}
+	return true;
 }
 
 void
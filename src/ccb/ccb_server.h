@@ -29,6 +29,8 @@
  */
 
 #include "MyString.h"
+#include <deque>
+#include <vector>
 
 class CCBTarget;
 class CCBServerRequest;
@@ -62,6 +64,13 @@ class CCBServer: Service {
 	CCBID m_next_request_id;
 	int m_read_buffer_size;
 	int m_write_buffer_size;
+	bool m_nonblocking_writes;
+
+		// While draining ready target sockets, heartbeats are not
+		// answered one at a time, but collected here and answered
+		// together afterwards.
+	bool m_defer_heartbeats;
+	std::vector<CCBID> m_heartbeats;
 
 		// we hold onto client requests so we can propagate failures
 		// to them if things go wrong
@@ -82,6 +91,10 @@ class CCBServer: Service {
 	CCBServerRequest *GetRequest( CCBID request_id );
 
 	void SendHeartbeatResponse( CCBTarget *target );
+	void SendHeartbeatResponses();
+
+	bool WriteMsgToTarget( CCBTarget *target, ClassAd &msg );
+	void FlushTarget( CCBTarget *target );
 
 	void ForwardRequestToTarget( CCBServerRequest *request, CCBTarget *target );
 	void RequestReply( Sock *sock, bool success, char const *error_msg, CCBID request_cid, CCBID target_cid );
@@ -94,6 +107,7 @@ class CCBServer: Service {
 	int EpollSockets(int);
 	void EpollAdd(CCBTarget *);
 	void EpollRemove(CCBTarget *);
+	bool EpollWatchWrites(CCBTarget *, bool watch);
 	void SetSmallBuffers(Sock *sock) const;
 
 	int HandleRegistration(int cmd,Stream *stream);
@@ -135,11 +149,21 @@ class CCBTarget {
 	// just received a response from this target
 	void decPendingRequestResults();
 
+		// A message to this target only partly fit in the socket
+		// buffer; the rest is sent when the socket becomes writable.
+	bool writePending() const { return m_write_pending; }
+	void setWritePending(bool pending) { m_write_pending = pending; }
+		// messages waiting for the pending one to be sent
+	void queueMsg(ClassAd &msg);
+	bool nextQueuedMsg(ClassAd &msg);
+
  private:
 	Sock *m_sock;         // used to send CCB messages to this target daemon
 	CCBID m_ccbid;        // CCBServer-assigned identifier
 	int m_pending_request_results;
 	bool m_socket_is_registered;
+	bool m_write_pending;
+	std::deque<ClassAd> *m_queued_msgs;
 
 		// requests directed to this target daemon
 	HashTable<CCBID,CCBServerRequest *> *m_requests;// request_id --> req
@@ -75,27 +75,35 @@ void ClassAdLibraryVersion(string &version_string)
     return;
 }
 
+// These are built by the initializer of a function-local static, which
+// runs exactly once even when several threads evaluating ads (as the
+// startd's policy threads do) get here first.
+
+static ReferencesBySize makeSpecialAttrNames()
+{
+	ReferencesBySize names;
+	names.insert( ATTR_TOPLEVEL );
+	names.insert( ATTR_ROOT );
+	names.insert( ATTR_SELF );
+	names.insert( ATTR_PARENT );
+	return names;
+}
+
 static inline ReferencesBySize &getSpecialAttrNames()
 {
-	static ReferencesBySize specialAttrNames;
-	static bool specialAttrNames_inited = false;
-	if ( !specialAttrNames_inited ) {
-		specialAttrNames.insert( ATTR_TOPLEVEL );
-		specialAttrNames.insert( ATTR_ROOT );
-		specialAttrNames.insert( ATTR_SELF );
-		specialAttrNames.insert( ATTR_PARENT );
-		specialAttrNames_inited = true;
-	}
+	static ReferencesBySize specialAttrNames = makeSpecialAttrNames();
 	return specialAttrNames;
 }
 
+static FunctionCall *makeCurrentTimeExpr()
+{
+	vector<ExprTree*> args;
+	return FunctionCall::MakeFunctionCall( "time", args );
+}
+
 static FunctionCall *getCurrentTimeExpr()
 {
-	static classad_shared_ptr<FunctionCall> curr_time_expr;
-	if ( !curr_time_expr ) {
-		vector<ExprTree*> args;
-		curr_time_expr.reset( FunctionCall::MakeFunctionCall( "time", args ) );
-	}
+	static classad_shared_ptr<FunctionCall> curr_time_expr( makeCurrentTimeExpr() );
 	return curr_time_expr.get();
 }
 
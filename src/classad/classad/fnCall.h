@@ -97,6 +97,14 @@ class FunctionCall : public ExprTree
 
 	static bool RegisterSharedLibraryFunctions(const char *shared_library_path);
 
+	/** Functions registered with RegisterFunction() or from a shared
+	 *  library may not be safe to call from more than one thread at a
+	 *  time.  If a guard is set, it is called before each call to such
+	 *  a function, and the call evaluates to error if it returns false.
+	 */
+	typedef bool (*ExternalFunctionGuard)(const char *functionName);
+	static void SetExternalFunctionGuard(ExternalFunctionGuard guard);
+
 	/** Returns true if the function expression points to a valid
 	 *  function in the ClassAd library.
 	 */
@@ -121,13 +129,16 @@ class FunctionCall : public ExprTree
 	// return the object--it's static, and we want to make sure that
 	// it's constructor has been called whenever we need to use it.
     static FuncTable &getFunctionTable(void);
+	static FuncTable &getExternalFunctionTable(void);
 	static bool		 initialized;
+	static ExternalFunctionGuard externalGuard;
 	
 	const ClassAd *parentScope;
 
 	// function call specific information
 	std::string		functionName;
 	ClassAdFunc		function;
+	bool			external;	// registered from outside the library
 	ArgumentList	arguments;
 
 	
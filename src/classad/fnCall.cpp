@@ -61,6 +61,7 @@ using namespace std;
 namespace classad {
 
 bool FunctionCall::initialized = false;
+FunctionCall::ExternalFunctionGuard FunctionCall::externalGuard = NULL;
 
 static bool doSplitTime(
     const Value &time, ClassAd * &splitClassAd);
@@ -80,6 +81,7 @@ FunctionCall( )
 	parentScope = NULL;
 
 	function = NULL;
+	external = false;
 
 	if( !initialized ) {
 		FuncTable &functionTable = getFunctionTable();
@@ -255,6 +257,7 @@ CopyFrom(const FunctionCall &functioncall)
     ExprTree::CopyFrom(functioncall);
     functionName = functioncall.functionName;
 	function     = functioncall.function;
+	external     = functioncall.external;
 
 	for (ArgumentList::const_iterator i = functioncall.arguments.begin(); 
          i != functioncall.arguments.end();
@@ -322,6 +325,13 @@ getFunctionTable(void)
     return functionTable;
 }
 
+FunctionCall::FuncTable& FunctionCall::
+getExternalFunctionTable(void)
+{
+    static FuncTable externalFunctionTable;
+    return externalFunctionTable;
+}
+
 void FunctionCall::RegisterFunction(
 	string &functionName, 
 	ClassAdFunc function)
@@ -330,10 +340,17 @@ void FunctionCall::RegisterFunction(
 
 	if (functionTable.find(functionName) == functionTable.end()) {
 		functionTable[functionName] = (void *) function;
+		getExternalFunctionTable()[functionName] = (void *) function;
 	}
 	return;
 }
 
+void FunctionCall::
+SetExternalFunctionGuard(ExternalFunctionGuard guard)
+{
+	externalGuard = guard;
+}
+
 void FunctionCall::RegisterFunctions(
 	ClassAdFunctionMapping *functions)
 {
@@ -453,6 +470,9 @@ MakeFunctionCall( const string &str, vector<ExprTree*> &args )
 
 	if( itr != functionTable.end( ) ) {
 		fc->function = (ClassAdFunc)itr->second;
+		FuncTable &externalTable = getExternalFunctionTable();
+		FuncTable::iterator	ext = externalTable.find( str );
+		fc->external = ext != externalTable.end() && ext->second == itr->second;
 	} else {
 		fc->function = NULL;
 	}
@@ -481,6 +501,10 @@ bool FunctionCall::
 _Evaluate (EvalState &state, Value &value) const
 {
 	if( function ) {
+		if( external && externalGuard && !externalGuard( functionName.c_str() ) ) {
+			value.SetErrorValue();
+			return( true );
+		}
 		return( (*function)( functionName.c_str( ), arguments, state, value ) );
 	} else {
 		value.SetErrorValue();
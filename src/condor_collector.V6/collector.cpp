@@ -394,6 +394,8 @@ void CollectorDaemon::Init()
 		receive_update,"receive_update",ADVERTISE_STARTD_PERM);
 	daemonCore->Register_CommandWithPayload(MERGE_STARTD_AD,"MERGE_STARTD_AD",
 		receive_update,"receive_update",NEGOTIATOR);
+	daemonCore->Register_CommandWithPayload(UPDATE_STARTD_AD_DELTA,"UPDATE_STARTD_AD_DELTA",
+		receive_update,"receive_update",ADVERTISE_STARTD_PERM);
 	daemonCore->Register_CommandWithPayload(UPDATE_SCHEDD_AD,"UPDATE_SCHEDD_AD",
 		receive_update,"receive_update",ADVERTISE_SCHEDD_PERM);
 	daemonCore->Register_CommandWithPayload(UPDATE_SUBMITTOR_AD,"UPDATE_SUBMITTOR_AD",
@@ -526,6 +528,12 @@ int CollectorDaemon::receive_query_cedar(int command,
 		goto END;
     }
 
+	// if the session negotiated compression, use a better (slower) level
+	// for the query results than for ordinary messages.
+	if (sock->get_compression()) {
+		((ReliSock*)sock)->set_compression_level(param_integer("QUERY_COMPRESSION_LEVEL", 6, 0, 9));
+	}
+
 	// Initial query handler
 	whichAds = receive_query_public( command );
 
@@ -1273,6 +1281,14 @@ int CollectorDaemon::receive_update(int command, Stream* sock)
 			// which already does all the necessary logging.
 		}
 
+		if (insert == -5 && sock->type() == Stream::reli_sock)
+		{
+			// A delta update we couldn't apply.  We have asked the
+			// daemon for the full ad, which it will send over this
+			// same connection, so keep it open.
+			return stashSocket( (ReliSock *)sock );
+		}
+
 		return FALSE;
 
 	}
@@ -1280,6 +1296,12 @@ int CollectorDaemon::receive_update(int command, Stream* sock)
 	CollectorEngine_ru_collect_runtime += rt.tick(rt_last);
 #endif
 
+		// A delta has been merged into the full ad, which is what
+		// everything from here on sees.
+	if (command == UPDATE_STARTD_AD_DELTA) {
+		command = UPDATE_STARTD_AD;
+	}
+
 	/* let the off-line plug-in have at it */
 	offline_plugin_.update ( command, *cad );
 
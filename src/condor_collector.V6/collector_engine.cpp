@@ -379,6 +379,36 @@ collect (int command, Sock *sock, const condor_sockaddr& from, int &insert)
 	CollectorEngine_ruc_getAd_runtime.Add(delta_time);
 #endif
 
+	// a delta update only makes sense to us if we still have the ad it
+	// was made against; if not, ask the daemon for the whole ad
+	if( clientAd->LookupExpr(ATTR_UPDATE_DELTA_BASE) ) {
+		ClassAd *fullAd = expandDeltaAd(command, clientAd);
+		if( !fullAd ) {
+			ClassAd resyncAd;
+			CopyAttribute(ATTR_MY_TYPE, resyncAd, *clientAd);
+			CopyAttribute(ATTR_NAME, resyncAd, *clientAd);
+			CopyAttribute(ATTR_MACHINE, resyncAd, *clientAd);
+			delete clientAd;
+			insert = -5;
+			sock->end_of_message();
+
+				// There is no way to answer over UDP, but daemons only
+				// send deltas over TCP.  The daemon reads this before
+				// it sends its next update on the socket.
+			if( sock->type() == Stream::reli_sock ) {
+				sock->encode();
+				if( !putClassAd(sock, resyncAd) || !sock->end_of_message() ) {
+					dprintf(D_FULLDEBUG, "Failed to request full update from %s\n",
+							sock->peer_description());
+				}
+				sock->decode();
+			}
+			return 0;
+		}
+		delete clientAd;
+		clientAd = fullAd;
+	}
+
 	// insert the authenticated user into the ad itself
 	const char* authn_user = sock->getFullyQualifiedUser();
 	if (authn_user) {
@@ -414,6 +444,66 @@ collect (int command, Sock *sock, const condor_sockaddr& from, int &insert)
 	return rval;
 }
 
+ClassAd *CollectorEngine::
+expandDeltaAd(int command, ClassAd *deltaAd)
+{
+	CollectorHashTable *table = NULL;
+	AdNameHashKey hk;
+	bool have_key = false;
+	switch( command ) {
+	  case UPDATE_STARTD_AD:
+		table = &StartdAds;
+		have_key = makeStartdAdHashKey(hk, deltaAd);
+		break;
+	  case UPDATE_SCHEDD_AD:
+		table = &ScheddAds;
+		have_key = makeScheddAdHashKey(hk, deltaAd);
+		break;
+	  case UPDATE_SUBMITTOR_AD:
+		table = &SubmittorAds;
+		have_key = makeScheddAdHashKey(hk, deltaAd);
+		break;
+	  case UPDATE_MASTER_AD:
+		table = &MasterAds;
+		have_key = makeMasterAdHashKey(hk, deltaAd);
+		break;
+	  case UPDATE_NEGOTIATOR_AD:
+		table = &NegotiatorAds;
+		have_key = makeNegotiatorAdHashKey(hk, deltaAd);
+		break;
+	  default:
+		dprintf(D_ALWAYS, "Command %d does not support delta updates\n", command);
+		return NULL;
+	}
+
+	ClassAd *stored = NULL;
+	if( !have_key || table->lookup(hk, stored) == -1 ) {
+		dprintf(D_FULLDEBUG, "Delta update for unknown ad; requesting full update\n");
+		return NULL;
+	}
+
+	ClassAd *fullAd = new ClassAd;
+	if( !ExpandDeltaClassAd(*stored, *deltaAd, *fullAd) ) {
+		long long base_gen = -1, stored_gen = -1;
+		deltaAd->LookupInteger(ATTR_UPDATE_DELTA_BASE, base_gen);
+		stored->LookupInteger(ATTR_UPDATE_GENERATION, stored_gen);
+		HashString hashString;
+		hashString.Build(hk);
+		dprintf(D_FULLDEBUG, "Delta update for \"%s\" is against generation %lld, "
+				"but we have %lld; requesting full update\n",
+				hashString.Value(), base_gen, stored_gen);
+		delete fullAd;
+		return NULL;
+	}
+
+		// Attributes we add ourselves are put back as for any other
+		// update.
+	fullAd->Delete(ATTR_LAST_HEARD_FROM);
+	fullAd->Delete(ATTR_AUTHENTICATED_IDENTITY);
+	fullAd->Delete(ATTR_AUTHENTICATION_METHOD);
+	return fullAd;
+}
+
 bool CollectorEngine::ValidateClassAd(int command,ClassAd *clientAd,Sock *sock)
 {
 
@@ -431,6 +521,7 @@ bool CollectorEngine::ValidateClassAd(int command,ClassAd *clientAd,Sock *sock)
 	  case MERGE_STARTD_AD:
 	  case UPDATE_STARTD_AD:
 	  case UPDATE_STARTD_AD_WITH_ACK:
+	  case UPDATE_STARTD_AD_DELTA:
 		  ipattr = ATTR_STARTD_IP_ADDR;
 		  break;
 	  case UPDATE_OWN_SUBMITTOR_AD:
@@ -512,12 +603,24 @@ bool CollectorEngine::ValidateClassAd(int command,ClassAd *clientAd,Sock *sock)
 		// Now verify COLLECTOR_REQUIREMENTS
 	if( !m_collector_requirements ) {
 		return true;
+	}
+		// A delta only makes sense on top of the ad it will be merged
+		// into, so judge the two together.
+	ClassAd *merge_into = NULL;
+	if( command == UPDATE_STARTD_AD_DELTA ) {
+		AdNameHashKey hk;
+		if( makeStartdAdHashKey(hk, clientAd) && StartdAds.lookup(hk, merge_into) == 0 ) {
+			clientAd->ChainToAd(merge_into);
+		}
 	}
 	bool collector_req_result = false;
 	if( !EvalBool(COLLECTOR_REQUIREMENTS,m_collector_requirements,clientAd,collector_req_result) ) {
 		dprintf(D_ALWAYS,"WARNING: %s did not evaluate to a boolean result.\n",COLLECTOR_REQUIREMENTS);
 		collector_req_result = false;
 	}
+	if( merge_into ) {
+		clientAd->Unchain();
+	}
 	if( !collector_req_result ) {
 		if( IsDebugLevel(D_MACHINE) ) { // Is this still an optimization?
 			dprintf( D_MACHINE,
@@ -686,6 +789,38 @@ collect (int command,ClassAd *clientAd,const condor_sockaddr& from,int &insert,S
 							  clientAd, hk, hashString, insert, from );
 		break;
 
+	  case UPDATE_STARTD_AD_DELTA:
+		if (!makeStartdAdHashKey (hk, clientAd))
+		{
+			dprintf (D_ALWAYS, "Could not make hashkey --- ignoring ad\n");
+			insert = -3;
+			retVal = 0;
+			break;
+		}
+		hashString.Build( hk );
+		{
+			ClassAd *old_ad = NULL;
+			if (StartdAds.lookup(hk, old_ad) == 0) {
+				collectorStats->update( "Start", old_ad, clientAd );
+			}
+		}
+			// If we don't have the ad (say, we just restarted), this
+			// fails, and the ad shows up with the startd's next full
+			// update.
+		retVal=mergeClassAd (StartdAds, "StartdAd     ", "Start",
+							  clientAd, hk, hashString, insert, from );
+		if (retVal) {
+				// unlike a merge from the negotiator, this counts as
+				// hearing from the startd, for both of its ads
+			ClassAd *pvtAd = NULL;
+			time_t now = time(NULL);
+			retVal->Assign(ATTR_LAST_HEARD_FROM, (int)now);
+			if (StartdPrivateAds.lookup(hk, pvtAd) == 0) {
+				pvtAd->Assign(ATTR_LAST_HEARD_FROM, (int)now);
+			}
+		}
+		break;
+
 	  case UPDATE_SCHEDD_AD:
 		if (!makeScheddAdHashKey (hk, clientAd))
 		{
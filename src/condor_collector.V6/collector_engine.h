@@ -173,6 +173,11 @@ class CollectorEngine : public Service
 
 	bool ValidateClassAd(int command,ClassAd *clientAd,Sock *sock);
 
+	// Rebuild the full ad from a delta update and the ad we have stored
+	// for its sender.  Returns NULL if we don't have the version of the
+	// ad the delta was made against.
+	ClassAd *expandDeltaAd(int command, ClassAd *deltaAd);
+
 	void* __self_ad__; // contains address of last Ad for this collector added to the hashtable, do NOT free from here
 					   // this pointer is only used to recognise this collector's ad during a condor_status query
 					   // so it's harmless if this pointer is out of date.
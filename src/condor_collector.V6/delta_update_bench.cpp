@@ -0,0 +1,233 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Synthetic update generator for comparing full and delta ad updates.
+//
+// usage: delta_update_bench [ads] [updates] [attributes] [changes]
+//
+// Makes the given number of startd-like ads (default 1000), each with
+// the given number of attributes (default 150), then sends each ad the
+// given number of updates (default 20), changing the given number of
+// attributes (default 10) per update and now and then removing one.
+// Each update is "sent" by printing it the way it goes over the wire,
+// and "ingested" by parsing it and, for deltas, applying it to a copy of
+// the stored ad as the collector does.  Checks that the delta updates
+// leave the collector with the same ads as the full ones, then prints
+// the bytes sent and the update rate for each.
+
+#include "condor_common.h"
+
+#include "condor_config.h"
+#include "condor_attributes.h"
+#include "condor_adtypes.h"
+#include "classad_merge.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+static void
+make_ad( ClassAd &ad, int id, int attributes )
+{
+	std::string value;
+	formatstr( value, "slot1@exec%05d.example.com", id );
+	ad.Assign( ATTR_NAME, value );
+	formatstr( value, "exec%05d.example.com", id );
+	ad.Assign( ATTR_MACHINE, value );
+	ad.Assign( ATTR_MY_TYPE, STARTD_ADTYPE );
+	ad.Assign( ATTR_TARGET_TYPE, JOB_ADTYPE );
+	formatstr( value, "<10.0.%d.%d:9618?addrs=10.0.%d.%d-9618&noUDP&sock=startd_%d>",
+			   id / 256, id % 256, id / 256, id % 256, id );
+	ad.Assign( ATTR_MY_ADDRESS, value );
+
+		// a mix of the kinds of attributes a startd publishes
+	for( int i = 0; i < attributes; i++ ) {
+		std::string attr;
+		formatstr( attr, "BenchAttr%03d", i );
+		switch( i % 4 ) {
+		case 0:
+			ad.Assign( attr, (long long)i * 1000 + id );
+			break;
+		case 1:
+			formatstr( value, "some-string-value-%d-for-machine-%d", i, id );
+			ad.Assign( attr, value );
+			break;
+		case 2:
+			ad.Assign( attr, i / 7.0 );
+			break;
+		default:
+			formatstr( value, "(TARGET.RequestMemory <= BenchAttr%03d) && "
+					   "(TARGET.RequestDisk <= %d)", i - 3, i * 1024 );
+			ad.AssignExpr( attr, value.c_str() );
+			break;
+		}
+	}
+}
+
+	// change the first few attributes, as load, activity and idle times
+	// change in a real startd ad, and every so often drop one for an
+	// update
+static void
+change_ad( ClassAd &ad, int update, int attributes, int changes )
+{
+	for( int i = 0; i < changes && i < attributes; i++ ) {
+		std::string attr;
+		formatstr( attr, "BenchAttr%03d", i );
+		ad.Assign( attr, (long long)update * 1000 + i );
+	}
+	std::string attr;
+	formatstr( attr, "BenchAttr%03d", attributes - 1 );
+	if( update % 5 == 0 ) {
+		ad.Delete( attr );
+	} else {
+		ad.Assign( attr, update );
+	}
+}
+
+static bool
+same_ads( ClassAd &a, ClassAd &b )
+{
+	if( a.size() != b.size() ) {
+		return false;
+	}
+	for( auto itr = a.begin(); itr != a.end(); itr++ ) {
+		ExprTree *expr = b.Lookup( itr->first );
+		if( !expr || !expr->SameAs( itr->second ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int argc, char *argv[] )
+{
+	int ads = argc > 1 ? atoi( argv[1] ) : 1000;
+	int updates = argc > 2 ? atoi( argv[2] ) : 20;
+	int attributes = argc > 3 ? atoi( argv[3] ) : 150;
+	int changes = argc > 4 ? atoi( argv[4] ) : 10;
+	if( ads <= 0 || updates <= 0 || attributes <= 0 || changes < 0 ) {
+		fprintf( stderr, "usage: %s [ads] [updates] [attributes] [changes]\n", argv[0] );
+		return 1;
+	}
+
+	config();
+
+	std::vector<ClassAd> daemon_ads( ads );
+	std::vector<ClassAd> full_ads( ads );
+	std::vector<ClassAd> delta_ads( ads );
+	std::vector<ClassAd> bases( ads );
+	for( int i = 0; i < ads; i++ ) {
+		make_ad( daemon_ads[i], i, attributes );
+		daemon_ads[i].Assign( ATTR_UPDATE_GENERATION, 0 );
+		full_ads[i] = daemon_ads[i];
+		delta_ads[i] = daemon_ads[i];
+		bases[i] = daemon_ads[i];
+	}
+
+	static const AttrNameSet markers = { ATTR_UPDATE_DELTA_BASE, ATTR_UPDATE_DELTA_REMOVED };
+	long long full_bytes = 0, delta_bytes = 0;
+	std::chrono::duration<double> full_send( 0 ), full_ingest( 0 );
+	std::chrono::duration<double> delta_send( 0 ), delta_ingest( 0 );
+	std::string wire;
+
+	for( int u = 1; u <= updates; u++ ) {
+		for( int i = 0; i < ads; i++ ) {
+			ClassAd &ad = daemon_ads[i];
+			change_ad( ad, u, attributes, changes );
+			ad.Assign( ATTR_UPDATE_GENERATION, u );
+
+				// full update: print the whole ad, parse it and store it
+			auto start = std::chrono::steady_clock::now();
+			wire.clear();
+			sPrintAd( wire, ad );
+			auto mid = std::chrono::steady_clock::now();
+			full_bytes += wire.size();
+			ClassAd received;
+			initAdFromString( wire.c_str(), received );
+			full_ads[i] = std::move( received );
+			auto end = std::chrono::steady_clock::now();
+			full_send += mid - start;
+			full_ingest += end - mid;
+
+				// delta update: diff against what was sent before, then
+				// parse it and apply it to a copy of the stored ad
+			start = std::chrono::steady_clock::now();
+			ClassAd delta;
+			std::string removed;
+			MakeDeltaClassAd( bases[i], ad, delta, removed );
+			CopyAttribute( ATTR_NAME, delta, ad );
+			CopyAttribute( ATTR_MY_TYPE, delta, ad );
+			CopyAttribute( ATTR_MACHINE, delta, ad );
+			CopyAttribute( ATTR_MY_ADDRESS, delta, ad );
+			delta.Assign( ATTR_UPDATE_DELTA_BASE, u - 1 );
+			if( !removed.empty() ) {
+				delta.Assign( ATTR_UPDATE_DELTA_REMOVED, removed );
+			}
+			bases[i] = ad;
+			wire.clear();
+			sPrintAd( wire, delta );
+			mid = std::chrono::steady_clock::now();
+			delta_bytes += wire.size();
+			ClassAd received_delta;
+			initAdFromString( wire.c_str(), received_delta );
+			long long base_gen = -1, stored_gen = -2;
+			received_delta.LookupInteger( ATTR_UPDATE_DELTA_BASE, base_gen );
+			delta_ads[i].LookupInteger( ATTR_UPDATE_GENERATION, stored_gen );
+			if( base_gen != stored_gen ) {
+				fprintf( stderr, "generation mismatch for ad %d: %lld != %lld\n",
+						 i, base_gen, stored_gen );
+				return 1;
+			}
+			removed.clear();
+			received_delta.LookupString( ATTR_UPDATE_DELTA_REMOVED, removed );
+			ClassAd expanded( delta_ads[i] );
+			ApplyDeltaClassAd( expanded, received_delta, removed.c_str(), markers );
+			delta_ads[i] = std::move( expanded );
+			end = std::chrono::steady_clock::now();
+			delta_send += mid - start;
+			delta_ingest += end - mid;
+		}
+	}
+
+	for( int i = 0; i < ads; i++ ) {
+		if( !same_ads( full_ads[i], delta_ads[i] ) ) {
+			std::string full_text, delta_text;
+			sPrintAd( full_text, full_ads[i] );
+			sPrintAd( delta_text, delta_ads[i] );
+			fprintf( stderr, "ad %d differs after delta updates:\n%s\nvs\n%s\n",
+					 i, full_text.c_str(), delta_text.c_str() );
+			return 1;
+		}
+	}
+
+	long long total = (long long)ads * updates;
+	printf( "%d ads, %d updates each, %d attributes, %d changed per update\n",
+			ads, updates, attributes, changes );
+	printf( "full   %8.1f bytes/update  send %6.2f us  ingest %6.2f us  %9.0f updates/s ingested\n",
+			(double)full_bytes / total,
+			1e6 * full_send.count() / total,
+			1e6 * full_ingest.count() / total,
+			total / full_ingest.count() );
+	printf( "delta  %8.1f bytes/update  send %6.2f us  ingest %6.2f us  %9.0f updates/s ingested\n",
+			(double)delta_bytes / total,
+			1e6 * delta_send.count() / total,
+			1e6 * delta_ingest.count() / total,
+			total / delta_ingest.count() );
+	return 0;
+}
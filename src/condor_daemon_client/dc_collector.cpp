@@ -26,6 +26,7 @@
 #include "daemon.h"
 #include "condor_daemon_core.h"
 #include "dc_collector.h"
+#include "classad_merge.h"
 
 #include <sstream>
 #include <algorithm>
@@ -51,6 +52,10 @@ DCCollector::init( bool needs_reconfig )
 	update_rsock = NULL;
 	use_tcp = true;
 	use_nonblocking_update = true;
+	use_deltas = false;
+	full_update_interval = 900;
+	delta_generation = 0;
+	delta_last_prune = 0;
 	update_destination = NULL;
 	timerclear( &m_blacklist_monitor_query_started );
 
@@ -108,6 +113,11 @@ DCCollector::deepCopy( const DCCollector& copy )
 	use_tcp = copy.use_tcp;
 	use_nonblocking_update = copy.use_nonblocking_update;
 
+		// we don't copy the delta bases either, so the copy will start
+		// with full updates.
+	use_deltas = copy.use_deltas;
+	full_update_interval = copy.full_update_interval;
+
 	up_type = copy.up_type;
 
 	if( update_destination ) {
@@ -227,6 +237,12 @@ DCCollector::reconfig( void )
 {
 	use_nonblocking_update = param_boolean("NONBLOCKING_COLLECTOR_UPDATE",true);
 
+	use_deltas = param_boolean("UPDATE_COLLECTOR_WITH_DELTAS", false);
+	full_update_interval = param_integer("UPDATE_COLLECTOR_FULL_INTERVAL", 900, 0);
+	if( ! use_deltas ) {
+		delta_bases.clear();
+	}
+
 	if( ! _addr ) {
 		locate();
 		if( ! _is_configured ) {
@@ -385,7 +401,7 @@ DCCollector::sendUpdate( int cmd, ClassAd* ad1, DCCollectorAdSequences& adSeq, C
 
 
 bool
-DCCollector::finishUpdate( DCCollector *self, Sock* sock, ClassAd* ad1, ClassAd* ad2, StartCommandCallbackType callback_fn, void *miscdata )
+DCCollector::finishUpdate( DCCollector *self, Sock* sock, int cmd, ClassAd* ad1, ClassAd* ad2, StartCommandCallbackType callback_fn, void *miscdata )
 {
 		// Only send secrets in the case where there's a private ad (ad2)
 		// or the collector has been build since 8.9.3 and understands not
@@ -410,11 +426,21 @@ DCCollector::finishUpdate( DCCollector *self, Sock* sock, ClassAd* ad1, ClassAd*
 	// nonblocking startCommand() callback without worrying about
 	// longevity of the DCCollector instance.
 
+		// The public ad may go as a delta against what the collector
+		// already has.  The private ad is always sent whole.
+	ClassAd *delta = NULL;
+	if( self && ad1 ) {
+		delta = self->makeDeltaUpdate( cmd, sock, ad1 );
+	}
+
 	sock->encode();
-	if( ad1 && ! putClassAd(sock, *ad1, options) ) {
+	bool sent = !ad1 || putClassAd(sock, delta ? *delta : *ad1, options);
+	delete delta;
+	if( ! sent ) {
 		if(self) {
 			self->newError( CA_COMMUNICATION_ERROR,
 			                "Failed to send ClassAd #1 to collector" );
+			self->forgetDeltaBase( ad1 );
 		}
 		if (callback_fn) {
 			(*callback_fn)(false, sock, nullptr, sock->getTrustDomain(), sock->shouldTryTokenRequest(), miscdata);
@@ -426,6 +452,7 @@ DCCollector::finishUpdate( DCCollector *self, Sock* sock, ClassAd* ad1, ClassAd*
 		if(self) {
 			self->newError( CA_COMMUNICATION_ERROR,
 			          "Failed to send ClassAd #2 to collector" );
+			self->forgetDeltaBase( ad1 );
 		}
 		if (callback_fn) {
 			(*callback_fn)(false, sock, nullptr, sock->getTrustDomain(), sock->shouldTryTokenRequest(), miscdata);
@@ -436,6 +463,7 @@ DCCollector::finishUpdate( DCCollector *self, Sock* sock, ClassAd* ad1, ClassAd*
 		if(self) {
 			self->newError( CA_COMMUNICATION_ERROR,
 			          "Failed to send EOM to collector" );
+			self->forgetDeltaBase( ad1 );
 		}
 		if (callback_fn) {
 			(*callback_fn)(false, sock, nullptr, sock->getTrustDomain(), sock->shouldTryTokenRequest(), miscdata);
@@ -530,7 +558,7 @@ public:
 				ud = 0;	
 			}
 		}
-		else if(sock && !DCCollector::finishUpdate(ud->dc_collector,sock,ud->ad1,ud->ad2, ud->m_callback_fn, ud->m_miscdata)) {
+		else if(sock && !DCCollector::finishUpdate(ud->dc_collector,sock,ud->cmd,ud->ad1,ud->ad2, ud->m_callback_fn, ud->m_miscdata)) {
 			char const *who = "unknown";
 			if(sock) who = sock->get_sinful_peer();
 			dprintf(D_ALWAYS,"Failed to send non-blocking update to %s.\n",who);
@@ -577,7 +605,7 @@ public:
 					// I don't think mixing TCP/UDP to the same collector is supported, so
 					// I believe this shortcut acceptable.
 				if (!dc_collector->update_rsock->put( ud->cmd ) ||
-					!DCCollector::finishUpdate(ud->dc_collector,dc_collector->update_rsock,ud->ad1,ud->ad2,ud->m_callback_fn,ud->m_miscdata))
+					!DCCollector::finishUpdate(ud->dc_collector,dc_collector->update_rsock,ud->cmd,ud->ad1,ud->ad2,ud->m_callback_fn,ud->m_miscdata))
 				{
 					char const *who = "unknown";
 					if(dc_collector->update_rsock) {
@@ -649,7 +677,7 @@ DCCollector::sendUDPUpdate( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblockin
 		return false;
 	}
 
-	bool success = finishUpdate( this, ssock, ad1, ad2, callback_fn, miscdata );
+	bool success = finishUpdate( this, ssock, cmd, ad1, ad2, callback_fn, miscdata );
 	delete ssock;
 
 	return success;
@@ -685,8 +713,18 @@ DCCollector::sendTCPUpdate( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblockin
 		// since finishUpdate() assumes we've already sent the command
 		// int, and since we do *NOT* want to use startCommand() again
 		// on a cached TCP socket, just code the int ourselves...
+		// first, pick up any requests the collector sent back for full
+		// updates of ads we sent as deltas.
+	if( !readResyncRequests() ) {
+		dprintf( D_FULLDEBUG,
+				 "TCP socket to collector was closed, "
+				 "starting new connection\n" );
+		delete update_rsock;
+		update_rsock = NULL;
+		return initiateTCPUpdate( cmd, ad1, ad2, nonblocking, callback_fn, miscdata );
+	}
 	update_rsock->encode();
-	if (update_rsock->put(cmd) && finishUpdate(this, update_rsock, ad1, ad2, callback_fn, miscdata)) {
+	if (update_rsock->put(cmd) && finishUpdate(this, update_rsock, cmd, ad1, ad2, callback_fn, miscdata)) {
 		if (callback_fn) {
 			(*callback_fn)(true, update_rsock, nullptr, update_rsock->getTrustDomain(), update_rsock->shouldTryTokenRequest(), miscdata);
 		}
@@ -709,6 +747,9 @@ DCCollector::initiateTCPUpdate( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblo
 		delete update_rsock;
 		update_rsock = NULL;
 	}
+		// we may be reconnecting to a collector that restarted, so
+		// don't count on it having anything we sent before.
+	delta_bases.clear();
 	if(nonblocking) {
 		UpdateData *ud = new UpdateData(cmd, Sock::reli_sock, ad1, ad2, this, callback_fn, miscdata);
 			// Note that UpdateData automatically adds itself to the pending_update_list.
@@ -731,7 +772,167 @@ DCCollector::initiateTCPUpdate( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblo
 		return false;
 	}
 	update_rsock = (ReliSock *)sock;
-	return finishUpdate( this, update_rsock, ad1, ad2, callback_fn, miscdata );
+	return finishUpdate( this, update_rsock, cmd, ad1, ad2, callback_fn, miscdata );
+}
+
+
+	// the ad types the collector can rebuild from a delta update
+static bool
+isDeltaUpdateCommand( int cmd )
+{
+	switch( cmd ) {
+	case UPDATE_STARTD_AD:
+	case UPDATE_SCHEDD_AD:
+	case UPDATE_SUBMITTOR_AD:
+	case UPDATE_MASTER_AD:
+	case UPDATE_NEGOTIATOR_AD:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static std::string
+deltaBaseKey( const ClassAd & ad )
+{
+	std::string key, attr;
+	ad.LookupString( ATTR_NAME, key );
+	ad.LookupString( ATTR_MY_TYPE, attr );
+	key += "\n"; key += attr;
+	ad.LookupString( ATTR_MACHINE, attr );
+	key += "\n"; key += attr;
+	return key;
+}
+
+
+ClassAd *
+DCCollector::makeDeltaUpdate( int cmd, Sock* sock, ClassAd* ad )
+{
+		// Deltas only go over TCP, because that is the only way the
+		// collector can ask us for a full update if it doesn't have
+		// the version of the ad the delta was made against.
+	auto *verinfo = sock->get_peer_version();
+	if( ! use_deltas || ! isDeltaUpdateCommand( cmd ) ||
+		sock->type() != Stream::reli_sock ||
+		! verinfo || ! verinfo->built_since_version(8, 9, 10) )
+	{
+			// make sure a generation left over from an earlier
+			// update can't match a delta we send later.
+		ad->Delete( ATTR_UPDATE_GENERATION );
+		return NULL;
+	}
+
+	time_t now = time( NULL );
+	if( now - delta_last_prune > full_update_interval ) {
+			// forget ads we've stopped sending, e.g. for dynamic
+			// slots that went away.
+		for( auto it = delta_bases.begin(); it != delta_bases.end(); ) {
+			if( now - it->second.last_update_time > 2 * full_update_interval ) {
+				it = delta_bases.erase( it );
+			} else {
+				++it;
+			}
+		}
+		delta_last_prune = now;
+	}
+
+	long long generation = ++delta_generation;
+	ad->Assign( ATTR_UPDATE_GENERATION, generation );
+	long long sequence = -1;
+	ad->LookupInteger( ATTR_UPDATE_SEQUENCE_NUMBER, sequence );
+
+	std::string key = deltaBaseKey( *ad );
+	auto it = delta_bases.find( key );
+	if( it == delta_bases.end() ||
+		now - it->second.full_update_time >= full_update_interval )
+	{
+			// The ad may be chained to a parent, and the collector
+			// gets the attributes of both.
+		DeltaBase &base = delta_bases[key];
+		base.ad.CopyFromChain( *ad );
+		base.generation = generation;
+		base.sequence = sequence;
+		base.full_update_time = now;
+		base.last_update_time = now;
+		return NULL;
+	}
+
+	DeltaBase &base = it->second;
+	ClassAd *delta = new ClassAd;
+	std::string removed;
+	int changed = -1;
+
+		// The dirty attributes are what changed since the previous
+		// update of the ad, so they are enough if we sent that one.
+	bool tracked = ad->SetDirtyTracking( true );
+	ad->SetDirtyTracking( tracked );
+	if( tracked && ! ad->GetChainedParentAd() && sequence >= 0 &&
+		base.sequence == sequence - 1 )
+	{
+		changed = MakeDeltaClassAdFromDirty( base.ad, *ad, *delta );
+	}
+	if( changed < 0 ) {
+		ClassAd flat;
+		flat.CopyFromChain( *ad );
+		changed = MakeDeltaClassAd( base.ad, flat, *delta, removed );
+		base.ad = std::move( flat );
+	}
+
+		// the collector needs these to find the ad it is applying
+		// the delta to
+	static const char * const identity_attrs[] = {
+		ATTR_MY_TYPE, ATTR_TARGET_TYPE, ATTR_NAME, ATTR_MACHINE,
+		ATTR_SLOT_ID, ATTR_MY_ADDRESS, ATTR_STARTD_IP_ADDR,
+		ATTR_SCHEDD_IP_ADDR, ATTR_SCHEDD_NAME,
+	};
+	for( const char *attr : identity_attrs ) {
+		CopyAttribute( attr, *delta, base.ad );
+	}
+	delta->Assign( ATTR_UPDATE_DELTA_BASE, base.generation );
+	if( ! removed.empty() ) {
+		delta->Assign( ATTR_UPDATE_DELTA_REMOVED, removed );
+	}
+
+	dprintf( D_FULLDEBUG, "Sending %d changed attributes of %s as a delta "
+			 "against generation %lld\n", changed, key.c_str(),
+			 base.generation );
+
+	base.generation = generation;
+	base.sequence = sequence;
+	base.last_update_time = now;
+	return delta;
+}
+
+
+void
+DCCollector::forgetDeltaBase( const ClassAd* ad )
+{
+	if( ad && ! delta_bases.empty() ) {
+		delta_bases.erase( deltaBaseKey( *ad ) );
+	}
+}
+
+
+	// The collector answers a delta update it can't apply with the
+	// identity of the ad it needs in full.  Returns false if the
+	// collector has closed the socket.
+bool
+DCCollector::readResyncRequests( void )
+{
+	while( update_rsock->readReady() ) {
+		ClassAd resync_ad;
+		update_rsock->decode();
+		if( ! getClassAd( update_rsock, resync_ad ) ||
+			! update_rsock->end_of_message() )
+		{
+			return false;
+		}
+		std::string key = deltaBaseKey( resync_ad );
+		dprintf( D_FULLDEBUG, "Collector %s requested a full update of %s\n",
+				 update_destination, key.c_str() );
+		delta_bases.erase( key );
+	}
+	return true;
 }
 
 
@@ -127,13 +127,35 @@ private:
 	bool use_nonblocking_update;
 	UpdateType up_type;
 
+		// For UPDATE_COLLECTOR_WITH_DELTAS, what the collector has of
+		// each ad we update, so that we need only send what changed.
+		// A sender which keeps its ad between updates may turn on
+		// dirty tracking for it and mark what changed since the
+		// previous update; then only those attributes are compared.
+	struct DeltaBase {
+		ClassAd ad;
+		long long generation;
+		long long sequence;		// UpdateSequenceNumber of the ad
+		time_t full_update_time;
+		time_t last_update_time;
+	};
+	bool use_deltas;
+	int full_update_interval;
+	long long delta_generation;
+	time_t delta_last_prune;
+	std::map<std::string, DeltaBase> delta_bases;
+
+	ClassAd *makeDeltaUpdate( int cmd, Sock* sock, ClassAd* ad );
+	void forgetDeltaBase( const ClassAd* ad );
+	bool readResyncRequests( void );
+
 	std::deque<class UpdateData*> pending_update_list;
 	friend class UpdateData;
 
 	bool sendTCPUpdate( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblocking, StartCommandCallbackType callback_fn, void* miscdata );
 	bool sendUDPUpdate( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblocking, StartCommandCallbackType callback_fn, void *miscdata );
 
-	static bool finishUpdate( DCCollector *self, Sock* sock, ClassAd* ad1, ClassAd* ad2, StartCommandCallbackType callback_fn, void *miscdata );
+	static bool finishUpdate( DCCollector *self, Sock* sock, int cmd, ClassAd* ad1, ClassAd* ad2, StartCommandCallbackType callback_fn, void *miscdata );
 
 	void parseTCPInfo( void );
 	void initDestinationStrings( void );
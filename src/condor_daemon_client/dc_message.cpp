@@ -270,6 +270,16 @@ DCMessenger::DCMessenger( classy_counted_ptr<Sock> sock ):
 	m_receive_messages_duration_ms = param_integer("RECEIVE_MSGS_DURATION",0,0);
 }
 
+DCMessenger::DCMessenger( classy_counted_ptr<Daemon> daemon, classy_counted_ptr<Sock> sock ):
+	m_daemon(daemon),
+	m_sock(sock)
+{
+	m_callback_msg = NULL;
+	m_callback_sock = NULL;
+	m_pending_operation = NOTHING_PENDING;
+	m_receive_messages_duration_ms = param_integer("RECEIVE_MSGS_DURATION",0,0);
+}
+
 DCMessenger::~DCMessenger()
 {
 		// should never get deleted in the middle of a pending operation
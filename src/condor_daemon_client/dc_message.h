@@ -284,6 +284,12 @@ public:
 		// existing sock, rather than a Daemon object.
 	DCMessenger( classy_counted_ptr<Sock> sock );
 
+		// This constructor is intended for sending a series of commands
+		// to a daemon over one connection.  If sock is not yet
+		// connected, it should come from daemon->makeConnectedSocket().
+		// The messenger keeps sock open after each message is sent.
+	DCMessenger( classy_counted_ptr<Daemon> daemon, classy_counted_ptr<Sock> sock );
+
 	~DCMessenger();
 
 		// Start a command, doing a non-blocking connection if necessary.
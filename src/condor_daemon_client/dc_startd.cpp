@@ -1264,6 +1264,58 @@ bool DCClaimIdMsg::readMsg( DCMessenger *, Sock *sock )
 	return true;
 }
 
+DCAliveBatchMsg::DCAliveBatchMsg( std::vector<std::string> const &claim_ids ):
+	DCMsg( ALIVE_BATCH ),
+	m_claim_ids( claim_ids )
+{
+}
+
+bool DCAliveBatchMsg::writeMsg( DCMessenger *, Sock *sock )
+{
+	int num_claims = (int)m_claim_ids.size();
+	if( !sock->put( num_claims ) ) {
+		sockFailed( sock );
+		return false;
+	}
+	for( auto itr = m_claim_ids.begin(); itr != m_claim_ids.end(); itr++ ) {
+		if( !sock->put_secret( itr->c_str() ) ) {
+			sockFailed( sock );
+			return false;
+		}
+	}
+	return true;
+}
+
+DCMsg::MessageClosureEnum
+DCAliveBatchMsg::messageSent(DCMessenger *messenger, Sock *sock )
+{
+	messenger->startReceiveMsg( this, sock );
+	return MESSAGE_CONTINUING;
+}
+
+bool DCAliveBatchMsg::readMsg( DCMessenger *, Sock *sock )
+{
+	int num_claims = 0;
+	sock->decode();
+	if( !sock->get( num_claims ) || num_claims != (int)m_claim_ids.size() ) {
+		sockFailed( sock );
+		return false;
+	}
+	std::vector<int> statuses( num_claims );
+	for( int i = 0; i < num_claims; i++ ) {
+		if( !sock->get( statuses[i] ) ) {
+			sockFailed( sock );
+			return false;
+		}
+	}
+	if( !sock->end_of_message() ) {
+		sockFailed( sock );
+		return false;
+	}
+	m_statuses.swap( statuses );
+	return true;
+}
+
 bool
 DCStartd::drainJobs(int how_fast,bool resume_on_completion,char const *check_expr,char const *start_expr,std::string &request_id)
 {
@@ -27,6 +27,8 @@
 #include "condor_io.h"
 #include "enum_utils.h"
 
+#include <vector>
+
 
 /** The subclass of the Daemon object for talking to a startd
 */
@@ -319,5 +321,38 @@ private:
 	std::string m_claim_id;
 };
 
+	// Per-claim results of an ALIVE_BATCH command
+enum AliveBatchStatus {
+	ALIVE_BATCH_OK = 0,          // keep alive accepted
+	ALIVE_BATCH_NO_CLAIM = 1,    // the startd does not know the claim
+	ALIVE_BATCH_NOT_ACTIVE = 2,  // the claim is not the slot's current claim
+	ALIVE_BATCH_REFUSED = 3,     // the slot would not take the keep alive
+};
+
+	// The most claims an ALIVE_BATCH may carry
+const int ALIVE_BATCH_MAX_CLAIMS = 100000;
+
+/*
+  DCAliveBatchMsg sends one ALIVE_BATCH command carrying the claim ids of
+  every claim the schedd holds on a startd, and reads back one
+  AliveBatchStatus per claim, in the same order.
+ */
+class DCAliveBatchMsg: public DCMsg {
+public:
+	DCAliveBatchMsg( std::vector<std::string> const &claim_ids );
+
+	bool writeMsg( DCMessenger *messenger, Sock *sock );
+	bool readMsg( DCMessenger *messenger, Sock *sock );
+	MessageClosureEnum messageSent(DCMessenger *messenger, Sock *sock );
+
+	std::vector<std::string> const &claimIds() const { return m_claim_ids; }
+		// empty until the reply has been read
+	std::vector<int> const &statuses() const { return m_statuses; }
+
+private:
+	std::vector<std::string> m_claim_ids;
+	std::vector<int> m_statuses;
+};
+
 
 #endif /* _CONDOR_DC_STARTD_H */
@@ -1605,6 +1605,10 @@ class DaemonCore : public Service
 	   stats_entry_recent<int> AsyncPipe;      //  number of times async_pipe was signalled
       #endif
 	   stats_entry_abs<int> UdpQueueDepth;  // Unread bytes for the UDP command port 
+	   stats_entry_abs<int> SecuritySessions;       // sessions in the session cache
+	   stats_entry_abs<int> SecuritySessionIndex;   // peer addresses and processes indexed by the session cache
+	   stats_entry_abs<int> SecuritySessionExpiryQueue; // items in the session cache expiry queue
+	   stats_entry_abs<int64_t> SecuritySessionMemory;  // approximate bytes held by the session cache
 
 		
        stats_entry_recent<Probe> PumpCycle;   // count of pump cycles plus sum of cycle time with min/max/avg/std 
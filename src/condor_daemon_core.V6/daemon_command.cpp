@@ -589,8 +589,15 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::ReadCommand(
 		if(!ip) {
 			ip = "unknown address";
 		}
-		dprintf(D_ALWAYS,
-			"DaemonCore: Can't receive command request from %s (perhaps a timeout?)\n", ip);
+		if (m_sock->type() == Stream::reli_sock && static_cast<ReliSock*>(m_sock)->is_closed()) {
+				// A socket kept open for more commands (e.g. TCP updates
+				// to the collector) was closed by the peer.
+			dprintf(D_FULLDEBUG,
+				"DaemonCore: Connection from %s closed.\n", ip);
+		} else {
+			dprintf(D_ALWAYS,
+				"DaemonCore: Can't receive command request from %s (perhaps a timeout?)\n", ip);
+		}
 		m_result = FALSE;
 		return CommandProtocolFinished;
 	}
@@ -888,14 +895,14 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::ReadCommand(
 							return CommandProtocolFinished;
 						}
 
-						unsigned char* rkey = Condor_Crypt_Base::randomKey(24);
-						unsigned char  rbuf[24];
+						unsigned char* rkey = Condor_Crypt_Base::randomKey(32);
+						unsigned char  rbuf[32];
 						if (rkey) {
-							memcpy (rbuf, rkey, 24);
+							memcpy (rbuf, rkey, 32);
 							// this was malloced in randomKey
 							free (rkey);
 						} else {
-							memset (rbuf, 0, 24);
+							memset (rbuf, 0, 32);
 							dprintf ( D_ALWAYS, "DC_AUTHENTICATE: unable to generate key for request from %s - no crypto available!\n", m_sock->peer_description() );							
 							free( crypto_method );
 							crypto_method = NULL;
@@ -904,6 +911,10 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::ReadCommand(
 						}
 
 						switch (toupper(crypto_method[0])) {
+							case 'A': // aes
+								dprintf (D_SECURITY, "DC_AUTHENTICATE: generating AES key for session %s...\n", m_sid);
+								m_key = new KeyInfo(rbuf, 32, CONDOR_AESGCM);
+								break;
 							case 'B': // blowfish
 								dprintf (D_SECURITY, "DC_AUTHENTICATE: generating BLOWFISH key for session %s...\n", m_sid);
 								m_key = new KeyInfo(rbuf, 24, CONDOR_BLOWFISH);
@@ -1216,6 +1227,19 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::EnableCrypto
 		m_sock->set_crypto_key(false, m_key);
 	}
 
+		// sessions are shared with UDP, which never compresses
+	bool turn_compression_on = m_is_tcp && m_policy &&
+		SecMan::commandAllowsCompression( m_real_cmd ) &&
+		m_sec_man->sec_lookup_feat_act(*m_policy, ATTR_SEC_COMPRESSION) == SecMan::SEC_FEAT_ACT_YES;
+	m_sock->decode();
+	if (!m_sock->set_compression(turn_compression_on)) {
+		dprintf (D_ALWAYS, "DC_AUTHENTICATE: unable to turn on compression, failing request from %s.\n", m_sock->peer_description());
+		m_result = FALSE;
+		return CommandProtocolFinished;
+	} else if (turn_compression_on) {
+		dprintf (D_SECURITY, "DC_AUTHENTICATE: compression enabled for session %s\n", m_sid);
+	}
+
 	m_state = CommandProtocolVerifyCommand;
 	return CommandProtocolContinue;
 }
@@ -7013,6 +7013,12 @@ int DaemonCore::Create_Process(
 			}
 			// now serialize object into inheritbuf
 			 ptmp = sock_inherit_list[i]->serialize();
+			 if ( ! ptmp ) {
+				dprintf( D_ALWAYS, "Create_Process: unable to pass socket "
+						 "to %s to the child\n",
+						 ((Sock *)sock_inherit_list[i])->peer_description() );
+				goto wrapup;
+			 }
 			 inheritbuf += ptmp;
 			 delete []ptmp;
 		}
@@ -116,7 +116,12 @@ void SelfMonitorData::CollectData(void)
 
 	registered_socket_count = daemonCore->RegisteredSocketCount();
 
-	cached_security_sessions = daemonCore->getSecMan()->session_cache->count();
+	KeyCache *session_cache = daemonCore->getSecMan()->session_cache;
+	cached_security_sessions = session_cache->count();
+	daemonCore->dc_stats.SecuritySessions = cached_security_sessions;
+	daemonCore->dc_stats.SecuritySessionIndex = session_cache->indexSize();
+	daemonCore->dc_stats.SecuritySessionExpiryQueue = session_cache->expiryQueueSize();
+	daemonCore->dc_stats.SecuritySessionMemory = (int64_t)session_cache->memoryFootprint();
 
 	// collect data on the udp port depth
 	if (daemonCore->wants_dc_udp_self()) {
@@ -238,6 +243,12 @@ void DaemonCore::Stats::Init(bool enable)
    DC_STATS_ADD_RECENT(Pool, PumpCycle,     IF_VERBOSEPUB);
    STATS_POOL_ADD_VAL(Pool, "DC", UdpQueueDepth,  IF_BASICPUB);
    STATS_POOL_PUB_PEAK(Pool, "DC", UdpQueueDepth,  IF_BASICPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", SecuritySessions,  IF_BASICPUB);
+   STATS_POOL_PUB_PEAK(Pool, "DC", SecuritySessions,  IF_BASICPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", SecuritySessionIndex,  IF_VERBOSEPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", SecuritySessionExpiryQueue,  IF_VERBOSEPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", SecuritySessionMemory,  IF_BASICPUB);
+   STATS_POOL_PUB_PEAK(Pool, "DC", SecuritySessionMemory,  IF_BASICPUB);
    DC_STATS_ADD_DEF(Pool, Commands, IF_BASICPUB);
 
    // insert entries that are stored in helper modules
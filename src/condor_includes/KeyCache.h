@@ -30,8 +30,14 @@
 #include "simplelist.h"
 #include "condor_sockaddr.h"
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 class SecMan;
+class KeyCache;
 class KeyCacheEntry {
+	friend class KeyCache;
  public:
     KeyCacheEntry(
 			char const * id,
@@ -57,6 +63,9 @@ class KeyCacheEntry {
 	bool                  getLingerFlag() const { return _lingering; }
 
 	void                  renewLease();
+
+		// Approximate number of bytes of memory held by this entry.
+	size_t                footprint() const;
  private:
 
 	void delete_storage();
@@ -71,6 +80,11 @@ class KeyCacheEntry {
 	time_t               _lease_expiration; // time of lease expiration
 	bool                 _lingering; // true if session only exists
 	                                 // to catch lingering communication
+
+		// Bookkeeping owned by the KeyCache holding this entry.
+	time_t               _queued_expiration; // time under which the entry
+	                                         // sits in the expiry queue
+	size_t               _footprint;         // footprint() at insertion
 };
 
 
@@ -90,24 +104,51 @@ public:
 	void expire(KeyCacheEntry*);
 	int  count();
 
+		// Must be called after KeyCacheEntry::setExpiration() moves the
+		// expiration of an entry in this cache earlier.  Lease renewals
+		// only ever move it later and need no notification.
+	void updateExpiration(KeyCacheEntry*);
+
 	StringList * getExpiredKeys();
 	StringList * getKeysForPeerAddress(char const *addr);
 	StringList * getKeysForProcess(char const *parent_unique_id,int pid);
 
+		// Sizes for the DaemonCore statistics.
+	int    indexSize() const { return (int)m_index.size(); }
+	int    expiryQueueSize() const { return (int)m_expiry_queue.size(); }
+	size_t memoryFootprint() const;
+
 private:
 	void copy_storage(const KeyCache &kc);
 	void delete_storage();
 
-	typedef HashTable<MyString, SimpleList<KeyCacheEntry *>* > KeyCacheIndex;
+	typedef std::unordered_map<std::string, std::unordered_set<KeyCacheEntry *> > KeyCacheIndex;
+
+		// Min-heap of (expiration, session id).  Entries are not removed
+		// from the heap when they leave the cache or their expiration
+		// changes; stale items are discarded when they reach the top.
+	typedef std::pair<time_t, std::string> ExpiryItem;
 
-	HashTable<MyString, KeyCacheEntry*> *key_table;
-	KeyCacheIndex *m_index;
+	std::unordered_map<std::string, KeyCacheEntry*> key_table;
+	KeyCacheIndex m_index;
+	std::vector<ExpiryItem> m_expiry_queue;
+		// Running totals for memoryFootprint(): the footprint() of each
+		// entry, the index nodes and their members, and the session ids
+		// held by the expiry queue.
+	size_t m_entry_bytes;
+	size_t m_index_bytes;
+	size_t m_queue_id_bytes;
 
 	void addToIndex(KeyCacheEntry *);
 	void removeFromIndex(KeyCacheEntry *);
 	void addToIndex(KeyCacheIndex *,MyString const &index,KeyCacheEntry *);
 	void removeFromIndex(KeyCacheIndex *,MyString const &index,KeyCacheEntry *);
 	void makeServerUniqueId(MyString const &parent_id,int server_pid,MyString *result);
+	static size_t indexNodeBytes(const std::string &index);
+	static size_t indexMemberBytes();
+
+	void queueExpiration(KeyCacheEntry *);
+	void compactExpiryQueue();
 };
 
 
@@ -32,6 +32,7 @@ void sanity_check();
 #endif /* not WIN32 */
 
 class Condor_MD_MAC;
+class Condor_Crypto_State;
 
 class Buf {
 	
@@ -82,6 +83,14 @@ public:
         bool computeMD(char * checkSUM, Condor_MD_MAC * checker);
         bool verifyMD(char * checkSUM, Condor_MD_MAC * checker);
 
+		// Encrypt the data after the header in place with AES-GCM and
+		// append the tag, putting the nonce base in front if this is
+		// the first packet.  The packet's end flag is authenticated too.
+	bool sealAEAD(char end, int header_size, Condor_Crypto_State * state);
+		// Reverse sealAEAD() for a packet read into this buffer,
+		// leaving just the data.
+	bool openAEAD(char end, Condor_Crypto_State * state);
+
 	void swap(Buf &);
 
 private:
@@ -204,6 +204,7 @@
 #define ATTR_FLOCK_TO "FlockTo"
 #define ATTR_FLAVOR  "Flavor"
 #define ATTR_FORCE  "Force"
+#define ATTR_FRAGMENTATION_SCORE  "FragmentationScore"
 #define ATTR_GAHP_PID "GahpPid"
 #define ATTR_GCE_ACCOUNT  "GceAccount"
 #define ATTR_GCE_AUTH_FILE  "GceAuthFile"
@@ -743,6 +744,9 @@
 #define ATTR_ULOG_USE_XML  "UserLogUseXML"
 #define ATTR_UPDATE_INTERVAL  "UpdateInterval"
 #define ATTR_CLASSAD_LIFETIME  "ClassAdLifetime"
+#define ATTR_UPDATE_DELTA_BASE  "UpdateDeltaBase"
+#define ATTR_UPDATE_DELTA_REMOVED  "UpdateDeltaRemoved"
+#define ATTR_UPDATE_GENERATION  "UpdateGeneration"
 #define ATTR_UPDATE_PRIO  "UpdatePrio"
 #define ATTR_UPDATE_SEQUENCE_NUMBER  "UpdateSequenceNumber"
 #define ATTR_USE_GRID_SHELL  "UseGridShell"
@@ -863,6 +867,7 @@
 #define ATTR_SEC_AUTH_REQUIRED  "AuthRequired"
 #define ATTR_SEC_ENCRYPTION  "Encryption"
 #define ATTR_SEC_INTEGRITY  "Integrity"
+#define ATTR_SEC_COMPRESSION  "Compression"
 #define ATTR_SEC_ENACT  "Enact"
 #define ATTR_SEC_RESPOND  "Respond"
 #define ATTR_SEC_COMMAND  "Command"
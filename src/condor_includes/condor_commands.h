@@ -188,6 +188,8 @@ NAMETABLE_DIRECTIVE:TABLE:DCTranslation
 // Get the SubmitterCeiling
 #define GET_CEILING (SCHED_VERS+124)
 #define SET_CEILING (SCHED_VERS+125)
+// Keep alives for all of the claims a schedd holds on one startd
+#define ALIVE_BATCH (SCHED_VERS+126)
 
 
 // values used for "HowFast" in the draining request
@@ -348,6 +350,10 @@ const int UPDATE_OWN_SUBMITTOR_AD = 80;
 // Request a collector to retrieve an identity token from a schedd.
 const int IMPERSONATION_TOKEN_REQUEST = 81;
 
+// A startd ad holding only the attributes the startd refreshed since
+// its last full UPDATE_STARTD_AD; merged into the stored ad.
+const int UPDATE_STARTD_AD_DELTA = 82;
+
 /* these comments are used to control command_table_generator.pl
 NAMETABLE_DIRECTIVE:END_SECTION:collector
 */
@@ -26,11 +26,14 @@
 
 #include "CryptKey.h"
 
+struct evp_cipher_ctx_st;
+
 
 class Condor_Crypto_State {
 
 public:
-    Condor_Crypto_State(Protocol proto, KeyInfo& key);
+    // is_client is the role of the socket, which only AES-GCM uses
+    Condor_Crypto_State(Protocol proto, KeyInfo& key, bool is_client = false);
     ~Condor_Crypto_State();
 
     void reset();
@@ -55,6 +58,20 @@ public:
     // CURRENTLY UNUSED: int m_additional_len;
     // CURRENTLY UNUSED: unsigned char *m_additional;
 
+    // AES-GCM only (see condor_crypt_aesgcm.h).  Each direction has
+    // its own key and cipher context, the nonce base chosen by the sender,
+    // and a count of packets sealed so far.  None of this is touched
+    // by reset(), because nonces must never repeat within a key.
+    bool m_is_client;
+    struct evp_cipher_ctx_st *m_enc_ctx;
+    struct evp_cipher_ctx_st *m_dec_ctx;
+    unsigned char m_enc_iv[12];
+    unsigned char m_dec_iv[12];
+    uint64_t m_enc_seq;
+    uint64_t m_dec_seq;
+    bool m_enc_iv_sent;
+    bool m_dec_iv_known;
+
 private:
     Condor_Crypto_State() {} ;
     Condor_Crypto_State(Condor_Crypto_State&) {};
@@ -0,0 +1,104 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef CONDOR_CRYPTO_AESGCM_H
+#define CONDOR_CRYPTO_AESGCM_H
+
+#ifdef HAVE_EXT_OPENSSL
+
+#include "condor_common.h"
+#include "condor_crypt.h"          // base class
+
+// AES-256-GCM through the OpenSSL EVP interface, which uses AES-NI
+// where the CPU has it.  Unlike the stream ciphers, this is an
+// authenticated cipher: each message (for ReliSock, each packet) is
+// sealed as a whole, so it provides integrity as well as privacy.
+//
+// Each direction has its own 256-bit cipher key, derived from the
+// session key with HKDF-SHA256 and a label naming the direction, so a
+// message can't be reflected back to the side that sent it.  Which
+// direction is which comes from the role of the socket (the side that
+// connected is the client), given to Condor_Crypto_State.  Each
+// side picks a random nonce base for what it sends and tells the peer
+// in front of its first message; the nonce for a message is the base
+// XORed with the number of messages sent before it, so the receiver
+// also notices any message that is dropped, replayed or reordered.
+
+class Condor_Crypt_AESGCM : public Condor_Crypt_Base {
+
+ public:
+    Condor_Crypt_AESGCM() {}
+    ~Condor_Crypt_AESGCM() {}
+
+    enum {
+        IV_SIZE = 12,
+        TAG_SIZE = 16,
+        // role, then nonce base, sequence number and flag for each
+        // direction
+        STREAM_STATE_SIZE = 1 + 2 * (IV_SIZE + 8 + 1)
+    };
+
+    // Seal or open one whole message.  The output of encrypt() is the
+    // ciphertext followed by the tag, preceded by the nonce base if this
+    // is the first message.  decrypt() fails if the message was altered.
+    bool encrypt(Condor_Crypto_State *s,
+                 const unsigned char *  input,
+                 int              input_len, 
+                 unsigned char *& output, 
+                 int&             output_len);
+
+    bool decrypt(Condor_Crypto_State *s,
+                 const unsigned char *  input,
+                 int              input_len, 
+                 unsigned char *& output, 
+                 int&             output_len);
+
+    // Set up the cipher contexts and nonce base of a new state.
+    static bool initState(Condor_Crypto_State *s);
+
+    // Encrypt data_len bytes in place, authenticating the aad bytes as
+    // well, and store TAG_SIZE bytes of tag.  The caller is responsible
+    // for sending s->m_enc_iv (and then setting s->m_enc_iv_sent) ahead
+    // of the first sealed message.
+    static bool seal(Condor_Crypto_State *s,
+                     const unsigned char *aad, int aad_len,
+                     unsigned char *data, int data_len,
+                     unsigned char *tag);
+
+    // Reverse of seal().  s->m_dec_iv must already be known.
+    static bool open(Condor_Crypto_State *s,
+                     const unsigned char *aad, int aad_len,
+                     unsigned char *data, int data_len,
+                     const unsigned char *tag);
+
+    // Save or restore the role, nonces and sequence numbers, so that an
+    // inherited socket can carry on where its parent left off.
+    static void exportStreamState(const Condor_Crypto_State *s, unsigned char *buf);
+    static bool importStreamState(Condor_Crypto_State *s, const unsigned char *buf);
+
+ private:
+    // Derive the key for each direction from the session key and
+    // s->m_is_client, and load them into the cipher contexts.
+    static bool initKeys(Condor_Crypto_State *s);
+};
+
+#endif /* HAVE_EXT_OPENSSL */
+
+#endif /* CONDOR_CRYPTO_AESGCM_H */
@@ -216,6 +216,10 @@ public:
 	static  std::string		getAuthenticationMethods( DCpermission perm );
 
 	static	MyString 		getDefaultCryptoMethods();
+		// Compression is never turned on for commands whose socket is
+		// handed to a child process, since the zlib state can't follow
+		// it there.  Both ends check this, so they always agree.
+	static	bool			commandAllowsCompression( int cmd );
 	static	SecMan::sec_req 		sec_alpha_to_sec_req(char *b);
 	static	SecMan::sec_feat_act 	sec_alpha_to_sec_feat_act(char *b);
 	static	SecMan::sec_req 		sec_lookup_req( const ClassAd &ad, const char* pname );
@@ -346,6 +346,9 @@
 /* Define to 1 if you have the <resolv.h> header file. (USED)*/
 #cmakedefine HAVE_RESOLV_H 1
 
+/* Define to 1 if zlib and <zlib.h> are available (USED)*/
+#cmakedefine HAVE_LIBZ 1
+
 /* does os support the sched_setaffinity (USED)*/
 #cmakedefine HAVE_SCHED_SETAFFINITY 1
 
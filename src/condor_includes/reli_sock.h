@@ -279,6 +279,22 @@ public:
 
     const char * isIncomingDataHashed();
 
+	/// Hold back partly filled TCP segments (TCP_CORK) until more is
+	/// written or this is turned off again, so that a run of small
+	/// messages sent without waiting for replies goes out in full
+	/// segments.  Turn it off before waiting for the peer to answer.
+	/// Returns false where this is not supported.
+	bool set_tcp_cork(bool enable);
+
+	/// Turn zlib stream compression on or off.  Compressed bytes are
+	/// encrypted (if encryption is on) and then packetized as usual.
+	/// Both peers must switch at the same message boundary.
+	virtual bool set_compression(bool enable);
+	/// Compression level (0-9) used for what this side sends from now
+	/// on; the receiver does not need to know it.  Commands that send
+	/// bulk results raise it; the default favors speed.
+	void set_compression_level(int level);
+
 	int clear_backlog_flag() {bool state = m_has_backlog; m_has_backlog = false; return state;}
 	int clear_read_block_flag() {bool state = m_read_would_block; m_read_would_block = false; return state;}
 
@@ -286,7 +302,9 @@ public:
 
 	// serialize and deserialize
 	const char * serialize(const char *);	// restore state from buffer
-	char * serialize() const;	// save state into buffer
+		// save state into buffer; returns NULL if the socket is
+		// compressed, since that state can't be passed to another process
+	char * serialize() const;
 
 //	PROTECTED INTERFACE TO RELIABLE SOCKS
 //
@@ -309,6 +327,15 @@ protected:
 	*/
 
 	int prepare_for_nobuffering( stream_coding = stream_unknown);
+#if defined(LINUX)
+		// Kernel-side copies used by put_file() and get_file() when the
+		// file data is not encrypted.  See cedar_no_ckpt.cpp.
+	int put_file_sendfile( int fd, filesize_t offset, filesize_t bytes_to_send,
+						   filesize_t &total, class DCTransferQueue *xfer_q );
+	int get_file_splice( int fd, filesize_t bytes_to_receive, filesize_t max_bytes,
+						 filesize_t &total, char *buf, int buf_size, int &pending,
+						 class DCTransferQueue *xfer_q );
+#endif
 	int perform_authenticate( bool with_key, KeyInfo *& key, 
 							  const char* methods, CondorError* errstack,
 							  int auth_timeout, bool non_blocking, char **method_used );
@@ -392,6 +419,28 @@ protected:
 	bool m_read_would_block;
 	bool m_non_blocking;
 
+		// zlib state; only allocated while compression is on
+	struct CompressState;
+	CompressState *m_compress;
+	int m_compress_level;
+
+	int put_bytes_compressed(const void *, int);
+	bool put_compressed_output(const unsigned char *, int);
+	bool flush_compression();
+	int get_bytes_compressed(void *, int);
+	bool fill_decompressed();
+	int drain_decompressed();
+	void clear_compression();
+	void copy_compression(const ReliSock &orig);
+
+		// serialize() without the compression check, for the copy
+		// constructor, which copies the compression state itself
+	char * serialize_state() const;
+
+		// put/get_bytes_nobuffer() when AES-GCM is on
+	int put_bytes_sealed(const char *buffer, int length, int send_size);
+	int get_bytes_sealed(char *buffer, int max_length, int receive_size);
+
 	virtual void setTargetSharedPortID( char const *id );
 	virtual bool sendTargetSharedPortID();
 	char const *getTargetSharedPortID() { return m_target_shared_port_id; }
@@ -261,6 +261,26 @@ public:
         // RETURNS: TRUE -- success, FALSE -- failure
         //------------------------------------------
 
+        bool crypto_is_aead() const;
+        //------------------------------------------
+        // PURPOSE: tell whether the installed key is for an
+        //          authenticated cipher (AES-GCM), in which case ReliSock
+        //          seals whole packets instead of calling wrap()
+        // RETURNS: true -- AEAD key installed, false -- otherwise
+        //------------------------------------------
+
+        //------------------------------------------
+        // Compression support below
+        //------------------------------------------
+        virtual bool set_compression(bool enable);
+        //------------------------------------------
+        // PURPOSE: turn stream compression on or off
+        // REQUIRE: both peers must make the same change at the same
+        //          message boundary; SecMan does this when the
+        //          negotiated policy says Compression = "YES"
+        // RETURNS: true -- success; false -- failure
+        //------------------------------------------
+
         //----------------------------------------------------------------------
         // MAC/MD related stuff
         //----------------------------------------------------------------------
@@ -539,6 +539,13 @@ public:
 	/** Returns true if this stream can turn on encryption. */
 	virtual bool canEncrypt() const = 0;
 
+	bool get_compression() const {return compress_mode_;}
+        //------------------------------------------
+        // PURPOSE: Return compression mode
+        // REQUIRE: None
+        // RETURNS: true -- on, false -- off
+        //------------------------------------------
+
 	static int set_timeout_multiplier(int secs);
 	static int get_timeout_multiplier();
 
@@ -578,6 +585,7 @@ protected:
 
 	bool                encrypt_;        // Encryption mode
 	bool                crypto_mode_;    // true == enabled, false == disabled.
+	bool                compress_mode_;  // true == enabled, false == disabled.
 	bool m_crypto_state_before_secret;
 	stream_coding	    _coding;
 
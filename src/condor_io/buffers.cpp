@@ -24,6 +24,7 @@
 #include "condor_io.h"
 #include "condor_debug.h"
 #include "condor_md.h"
+#include "condor_crypt_aesgcm.h"
 #include "condor_rw.h"
 
 unsigned long num_created = 0;
@@ -320,6 +321,67 @@ bool Buf::verifyMD(char * checkSUM, Condor_MD_MAC * checker)
     return checker->verifyMD((unsigned char *) checkSUM);
 }
 
+bool Buf::sealAEAD(char end, int header_size, Condor_Crypto_State * state)
+{
+#ifdef HAVE_EXT_OPENSSL
+	alloc_buf();
+
+	int data_len = _dta_sz - header_size;
+	int iv_len = state->m_enc_iv_sent ? 0 : Condor_Crypt_AESGCM::IV_SIZE;
+	grow_buf(_dta_sz + iv_len + Condor_Crypt_AESGCM::TAG_SIZE);
+	if (iv_len) {
+		memmove(&_dta[header_size + iv_len], &_dta[header_size], data_len);
+		memcpy(&_dta[header_size], state->m_enc_iv, iv_len);
+		_dta_sz += iv_len;
+	}
+
+	unsigned char *data = (unsigned char *) &_dta[header_size + iv_len];
+	if (!Condor_Crypt_AESGCM::seal(state, (unsigned char *) &end, 1,
+			data, data_len, data + data_len)) {
+		return false;
+	}
+	_dta_sz += Condor_Crypt_AESGCM::TAG_SIZE;
+	state->m_enc_iv_sent = true;
+	return true;
+#else
+	(void) end; (void) header_size; (void) state;
+	return false;
+#endif
+}
+
+bool Buf::openAEAD(char end, Condor_Crypto_State * state)
+{
+#ifdef HAVE_EXT_OPENSSL
+	alloc_buf();
+
+	int pos = 0;
+	if (!state->m_dec_iv_known) {
+		if (_dta_sz < Condor_Crypt_AESGCM::IV_SIZE) {
+			return false;
+		}
+		memcpy(state->m_dec_iv, _dta, Condor_Crypt_AESGCM::IV_SIZE);
+		state->m_dec_iv_known = true;
+		pos = Condor_Crypt_AESGCM::IV_SIZE;
+	}
+
+	int data_len = _dta_sz - pos - Condor_Crypt_AESGCM::TAG_SIZE;
+	if (data_len < 0) {
+		return false;
+	}
+	unsigned char *data = (unsigned char *) &_dta[pos];
+	if (!Condor_Crypt_AESGCM::open(state, (unsigned char *) &end, 1,
+			data, data_len, data + data_len)) {
+		return false;
+	}
+	_dta_sz -= Condor_Crypt_AESGCM::TAG_SIZE;
+	_dta_pt = pos;
+	return true;
+#else
+	(void) end; (void) state;
+	return false;
+#endif
+}
+
 void Buf::swap(Buf &other)
 {
 	char * tmp_dta = _dta;
@@ -0,0 +1,129 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Loopback benchmark for ReliSock::put_file() and get_file().
+//
+// usage: cedar_file_bench <source file> <destination file> [iterations]
+//
+// Sends the source file over a loopback connection the given number of
+// times, first with ENABLE_ZERO_COPY_FILE_TRANSFER off and then with it
+// on, and prints the throughput of each.
+
+#include "condor_common.h"
+
+#include "condor_config.h"
+#include "condor_io.h"
+#include "condor_debug.h"
+
+#include <sys/wait.h>
+#include <chrono>
+
+static bool
+transfer_files( ReliSock &sock, bool sender, char const *source, char const *dest,
+				int iterations, filesize_t &bytes )
+{
+	bytes = 0;
+	for( int i = 0; i < iterations; i++ ) {
+		filesize_t size = 0;
+		int ack = 0;
+		if( sender ) {
+			sock.encode();
+			if( sock.put_file( &size, source ) < 0 || !sock.end_of_message() ) {
+				fprintf( stderr, "put_file(%s) failed\n", source );
+				return false;
+			}
+				// wait until the data is on disk at the other end
+			sock.decode();
+			if( !sock.code( ack ) || !sock.end_of_message() ) {
+				fprintf( stderr, "failed to read acknowledgement\n" );
+				return false;
+			}
+		}
+		else {
+			sock.decode();
+			if( sock.get_file( &size, dest ) < 0 || !sock.end_of_message() ) {
+				fprintf( stderr, "get_file(%s) failed\n", dest );
+				return false;
+			}
+			sock.encode();
+			if( !sock.code( ack ) || !sock.end_of_message() ) {
+				fprintf( stderr, "failed to send acknowledgement\n" );
+				return false;
+			}
+		}
+		bytes += size;
+	}
+	return true;
+}
+
+int main( int argc, char *argv[] )
+{
+	if( argc < 3 ) {
+		fprintf( stderr, "usage: %s <source file> <destination file> [iterations]\n", argv[0] );
+		return 1;
+	}
+	char const *source = argv[1];
+	char const *dest = argv[2];
+	int iterations = argc > 3 ? atoi( argv[3] ) : 10;
+	if( iterations <= 0 ) {
+		iterations = 1;
+	}
+
+	config();
+
+	ReliSock sender, receiver;
+	if( !sender.connect_socketpair( receiver ) ) {
+		fprintf( stderr, "failed to create loopback connection\n" );
+		return 1;
+	}
+
+	pid_t pid = fork();
+	if( pid < 0 ) {
+		fprintf( stderr, "fork() failed: %s\n", strerror( errno ) );
+		return 1;
+	}
+	bool is_sender = pid != 0;
+	ReliSock &sock = is_sender ? sender : receiver;
+	(is_sender ? receiver : sender).close();
+
+	char const *modes[] = { "false", "true" };
+	for( char const *mode : modes ) {
+		param_insert( "ENABLE_ZERO_COPY_FILE_TRANSFER", mode );
+
+		filesize_t bytes = 0;
+		auto start = std::chrono::steady_clock::now();
+		if( !transfer_files( sock, is_sender, source, dest, iterations, bytes ) ) {
+			return 1;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if( is_sender ) {
+			printf( "ENABLE_ZERO_COPY_FILE_TRANSFER=%-5s  %lld bytes in %.3fs: %.1f MB/s\n",
+					mode, (long long)bytes, elapsed.count(),
+					elapsed.count() > 0 ? bytes / elapsed.count() / 1e6 : 0.0 );
+		}
+	}
+
+	if( is_sender ) {
+		int status = 0;
+		waitpid( pid, &status, 0 );
+		return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+	}
+	return 0;
+}
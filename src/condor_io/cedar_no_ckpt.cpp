@@ -50,6 +50,10 @@
 #ifdef WIN32
 #include <mswsock.h>	// For TransmitFile()
 #endif
+#if defined(LINUX)
+#include <sys/sendfile.h>
+#include "selector.h"
+#endif
 
 const unsigned int PUT_FILE_EOM_NUM = 666;
 
@@ -176,6 +180,23 @@ ReliSock::get_file( filesize_t *size, int fd,
 		  RSC in the syscall library.  this code isn't like that.
 		*/
 
+	int nbytes = 0;	// bytes in buf that still need to be written
+
+#if defined(LINUX)
+		// Unencrypted data arrives exactly as it should land on disk, so
+		// have the kernel move it from the socket to the file.  Appending
+		// is left to the loop below, because splice() refuses O_APPEND.
+	if( fd != GET_FILE_NULL_FD && !append && !get_encryption() &&
+		bytes_to_receive > 0 && param_boolean("ENABLE_ZERO_COPY_FILE_TRANSFER", true) )
+	{
+		int rc = get_file_splice( fd, bytes_to_receive, max_bytes, total,
+								  buf, sizeof(buf), nbytes, xfer_q );
+		if( rc != 0 ) {
+			return rc;
+		}
+	}
+#endif
+
 	// Now, read it all in & save it
 	while( total < bytes_to_receive ) {
 		struct timeval t1,t2;
@@ -183,9 +204,11 @@ ReliSock::get_file( filesize_t *size, int fd,
 			condor_gettimestamp(t1);
 		}
 
-		int	iosize =
-			(int) MIN( (filesize_t) sizeof(buf), bytes_to_receive - total );
-		int	nbytes = get_bytes_nobuffer( buf, iosize, 0 );
+		if( nbytes == 0 ) {
+			int	iosize =
+				(int) MIN( (filesize_t) sizeof(buf), bytes_to_receive - total );
+			nbytes = get_bytes_nobuffer( buf, iosize, 0 );
+		}
 
 		if( xfer_q ) {
 			condor_gettimestamp(t2);
@@ -201,6 +224,7 @@ ReliSock::get_file( filesize_t *size, int fd,
 				// fast-forwarding and throwing it away, due to errors
 				// already encountered.
 			total += nbytes;
+			nbytes = 0;
 			continue;
 		}
 
@@ -251,6 +275,7 @@ ReliSock::get_file( filesize_t *size, int fd,
 		}
 
 		total += written;
+		nbytes = 0;
 		if( max_bytes >= 0 && total > max_bytes ) {
 
 				// Since breaking off here leaves the protocol in an
@@ -490,12 +515,51 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 		}
 #endif
 
+#if defined(LINUX)
+		// Likewise on Linux, unencrypted data goes to the socket exactly
+		// as it is on disk, so let sendfile() copy it from the page cache.
+		if ( !get_encryption() && param_boolean("ENABLE_ZERO_COPY_FILE_TRANSFER", true) ) {
+
+			if ( !prepare_for_nobuffering(stream_encode) ) {
+				dprintf(D_ALWAYS,
+						"ReliSock: put_file: failed to drain buffers!\n");
+				return -1;
+			}
+
+			int rc = put_file_sendfile(fd, offset, bytes_to_send, total, xfer_q);
+			if ( rc < 0 ) {
+				return -1;
+			}
+			if ( rc == 0 && total < bytes_to_send ) {
+					// The file got shorter while we were sending it.
+					// As with a short read() below, that's a failure;
+					// reading on from the (unmoved) file offset would
+					// send the start of the file again.
+				dprintf(D_ALWAYS,
+						"ReliSock: put_file: only sent " FILESIZE_T_FORMAT
+						" bytes out of " FILESIZE_T_FORMAT "\n",
+						total, filesize);
+				return -1;
+			}
+			if ( total > 0 ) {
+					// sendfile() does not move the file offset; the
+					// loop below picks up where it left off.
+				lseek( fd, offset + total, SEEK_SET );
+			}
+		}
+
+			// Everything else reads the file sequentially; say so.
+		if ( total < bytes_to_send ) {
+			posix_fadvise(fd, offset + total, bytes_to_send - total, POSIX_FADV_SEQUENTIAL);
+		}
+#endif
+
 		char buf[65536];
 		int nbytes, nrd;
 
-		// On Unix, always send the file using put_bytes_nobuffer().
-		// Note that on Win32, we use this method as well if encryption 
-		// is required.
+		// On Unix, send the file using put_bytes_nobuffer() unless
+		// the zero-copy path above already did.  Note that on Win32, we
+		// use this method as well if encryption is required.
 		while (total < bytes_to_send) {
 			struct timeval t1;
 			struct timeval t2;
@@ -572,6 +636,224 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 }
 MSC_RESTORE_WARNING(6262) // function uses 64k of stack
 
+#if defined(LINUX)
+
+// Wait up to the socket timeout for the socket to become ready.
+// Returns false (after logging) on timeout or error.
+static bool
+wait_for_sock( Selector &selector, int timeout, char const *what, char const *peer )
+{
+	if ( timeout > 0 ) {
+		selector.set_timeout( timeout );
+	} else {
+		selector.unset_timeout();
+	}
+	selector.execute();
+	if ( selector.timed_out() ) {
+		dprintf( D_ALWAYS, "ReliSock: %s: timed out waiting for %s\n", what, peer );
+		return false;
+	}
+	if ( selector.failed() ) {
+		dprintf( D_ALWAYS, "ReliSock: %s: select() failed: %s (errno=%d)\n",
+				 what, strerror(selector.select_errno()), selector.select_errno() );
+		return false;
+	}
+	return true;
+}
+
+// Send bytes [offset+total, offset+bytes_to_send) of fd with sendfile().
+// Returns 0 when done, -1 on a network error, and 1 if sendfile() cannot
+// be used on this file.  In every case total says how far we got; it is
+// short after a return of 0 if the file shrank underneath us.
+int
+ReliSock::put_file_sendfile( int fd, filesize_t offset, filesize_t bytes_to_send,
+							 filesize_t &total, DCTransferQueue *xfer_q )
+{
+	const filesize_t chunk_size = 4 * 1024 * 1024;
+
+		// As in condor_write(), the socket is non-blocking while we work
+		// so that a stalled peer is caught by the socket timeout.
+	int fcntl_flags = fcntl( _sock, F_GETFL );
+	if ( fcntl_flags < 0 ) {
+		return 1;
+	}
+	if ( (fcntl_flags & O_NONBLOCK) == 0 && fcntl( _sock, F_SETFL, fcntl_flags | O_NONBLOCK ) < 0 ) {
+		return 1;
+	}
+
+	Selector selector;
+	selector.add_fd( _sock, Selector::IO_WRITE );
+
+	int result = 0;
+	off_t file_offset = offset + total;
+	struct timeval t1, t2;
+	condor_gettimestamp( t1 );
+
+	while ( total < bytes_to_send ) {
+		size_t want = (size_t) MIN( bytes_to_send - total, chunk_size );
+		ssize_t nw = sendfile( _sock, fd, &file_offset, want );
+
+		if ( nw < 0 && errno == EINTR ) {
+			continue;
+		}
+		if ( nw < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ) {
+			if ( !wait_for_sock( selector, _timeout, "put_file", peer_description() ) ) {
+				result = -1;
+				break;
+			}
+			continue;
+		}
+		if ( nw < 0 ) {
+			if ( (errno == EINVAL || errno == ENOSYS) ) {
+				dprintf( D_FULLDEBUG, "ReliSock: put_file: sendfile() is not supported "
+						 "for this file (errno=%d); using read()\n", errno );
+				result = 1;
+			} else {
+				dprintf( D_ALWAYS, "ReliSock: put_file: sendfile() to %s failed: %s (errno=%d)\n",
+						 peer_description(), strerror(errno), errno );
+				result = -1;
+			}
+			break;
+		}
+		if ( nw == 0 ) {
+				// the file got shorter; our caller reports the shortfall
+			break;
+		}
+
+		total += nw;
+		_bytes_sent += nw;
+		if ( xfer_q ) {
+				// sendfile() hides how much of the time was disk i/o,
+				// so, as with TransmitFile(), count it all as network.
+			condor_gettimestamp( t2 );
+			xfer_q->AddUsecNetWrite( timersub_usec(t2, t1) );
+			xfer_q->AddBytesSent( nw );
+			xfer_q->ConsiderSendingReport( t2.tv_sec );
+			t1 = t2;
+		}
+	}
+
+	if ( (fcntl_flags & O_NONBLOCK) == 0 ) {
+		fcntl( _sock, F_SETFL, fcntl_flags );
+	}
+	return result;
+}
+
+// Receive file data into fd by splicing it from the socket through a pipe.
+// Returns 0 when all the data has arrived, or when the rest should be
+// handled by the read()/write() loop in get_file(); in that case any data
+// already taken off the socket is left in buf, and pending says how much.
+// Otherwise returns -1 on error or GET_FILE_MAX_BYTES_EXCEEDED.
+int
+ReliSock::get_file_splice( int fd, filesize_t bytes_to_receive, filesize_t max_bytes,
+						   filesize_t &total, char *buf, int buf_size, int &pending,
+						   DCTransferQueue *xfer_q )
+{
+	pending = 0;
+
+	if ( !prepare_for_nobuffering(stream_decode) ) {
+		dprintf( D_ALWAYS, "ReliSock: get_file: failed to drain buffers!\n" );
+		return -1;
+	}
+
+	int pipefds[2];
+	if ( pipe( pipefds ) < 0 ) {
+		return 0;
+	}
+
+	Selector selector;
+	selector.add_fd( _sock, Selector::IO_READ );
+
+	int result = 0;
+	while ( total < bytes_to_receive ) {
+		struct timeval t1, t2;
+		if ( xfer_q ) {
+			condor_gettimestamp( t1 );
+		}
+
+		if ( !wait_for_sock( selector, _timeout, "get_file", peer_description() ) ) {
+			result = -1;
+			break;
+		}
+		size_t want = (size_t) MIN( bytes_to_receive - total, (filesize_t) buf_size );
+		ssize_t nr = splice( _sock, NULL, pipefds[1], NULL, want, SPLICE_F_MOVE );
+		if ( nr < 0 && (errno == EINTR || errno == EAGAIN) ) {
+			continue;
+		}
+		if ( nr < 0 && total == 0 && (errno == EINVAL || errno == ENOSYS) ) {
+			break;	// let the read() loop do it all
+		}
+		if ( nr <= 0 ) {
+			dprintf( D_ALWAYS, "ReliSock: get_file: failed to receive data from %s: %s\n",
+					 peer_description(), nr == 0 ? "connection closed" : strerror(errno) );
+			result = -1;
+			break;
+		}
+		_bytes_recvd += nr;
+
+		if ( xfer_q ) {
+			condor_gettimestamp( t2 );
+			xfer_q->AddUsecNetRead( timersub_usec(t2, t1) );
+		}
+
+		ssize_t written = 0;
+		while ( written < nr ) {
+			ssize_t nw = splice( pipefds[0], NULL, fd, NULL, nr - written, SPLICE_F_MOVE );
+			if ( nw < 0 && errno == EINTR ) {
+				continue;
+			}
+			if ( nw <= 0 ) {
+				break;
+			}
+			written += nw;
+		}
+
+		if ( xfer_q ) {
+			condor_gettimestamp( t1 );
+			xfer_q->AddUsecFileWrite( timersub_usec(t1, t2) );
+			xfer_q->AddBytesReceived( written );
+			xfer_q->ConsiderSendingReport( t1.tv_sec );
+		}
+		total += written;
+
+		if ( written < nr ) {
+				// The file does not take splice() (or the write failed).
+				// Hand what is still in the pipe back to get_file(), which
+				// writes it the ordinary way and reports any error.
+			int splice_errno = errno;
+			pending = (int) (nr - written);
+			ssize_t got = 0;
+			while ( got < pending ) {
+				ssize_t n = read( pipefds[0], buf + got, pending - got );
+				if ( n < 0 && errno == EINTR ) {
+					continue;
+				}
+				if ( n <= 0 ) {
+					result = -1;
+					break;
+				}
+				got += n;
+			}
+			dprintf( D_FULLDEBUG, "ReliSock: get_file: splice() to file failed (errno=%d); using write()\n", splice_errno );
+			break;
+		}
+
+		if ( max_bytes >= 0 && total > max_bytes ) {
+			dprintf( D_ALWAYS, "get_file: aborting after downloading %ld of %ld bytes, because max transfer size is exceeded.\n",
+					 (long int)total,
+					 (long int)bytes_to_receive);
+			result = GET_FILE_MAX_BYTES_EXCEEDED;
+			break;
+		}
+	}
+
+	::close( pipefds[0] );
+	::close( pipefds[1] );
+	return result;
+}
+
+#endif /* LINUX */
+
 int
 ReliSock::get_file_with_permissions( filesize_t *size, 
 									 const char *destination,
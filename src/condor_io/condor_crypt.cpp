@@ -29,9 +29,12 @@
 // function in each method object.
 #include <openssl/des.h>
 #include <openssl/blowfish.h>
+#include <openssl/evp.h>
+#include "condor_crypt_aesgcm.h"
 
-Condor_Crypto_State::Condor_Crypto_State(Protocol proto, KeyInfo &key) :
-    m_keyInfo(key)
+Condor_Crypto_State::Condor_Crypto_State(Protocol proto, KeyInfo &key, bool is_client) :
+    m_keyInfo(key),
+    m_is_client(is_client)
 {
 
     // m_keyInfo (initialized above) stores the key object,
@@ -44,6 +47,14 @@ Condor_Crypto_State::Condor_Crypto_State(Protocol proto, KeyInfo &key) :
     m_ivec = NULL;
     m_method_key_data_len = 0;
     m_method_key_data = NULL;
+    m_enc_ctx = NULL;
+    m_dec_ctx = NULL;
+    memset(m_enc_iv, 0, sizeof(m_enc_iv));
+    memset(m_dec_iv, 0, sizeof(m_dec_iv));
+    m_enc_seq = 0;
+    m_dec_seq = 0;
+    m_enc_iv_sent = false;
+    m_dec_iv_known = false;
 
     // there should probably be a static function in each crypto object to do
     // these conversions so that the state object doesn't need any specifc
@@ -79,6 +90,12 @@ Condor_Crypto_State::Condor_Crypto_State(Protocol proto, KeyInfo &key) :
             m_ivec = (unsigned char*)malloc(m_ivec_len);
             break;
         }
+        case CONDOR_AESGCM: {
+            if (!Condor_Crypt_AESGCM::initState(this)) {
+                dprintf(D_ALWAYS, "CRYPTO: WARNING: Failed to initialize AES-GCM state.\n");
+            }
+            break;
+        }
         default:
             dprintf(D_ALWAYS, "CRYPTO: WARNING: Initialized crypto state for unknown proto %i.\n", proto);
             break;
@@ -92,6 +109,8 @@ Condor_Crypto_State::Condor_Crypto_State(Protocol proto, KeyInfo &key) :
 Condor_Crypto_State::~Condor_Crypto_State() {
     if(m_ivec) free(m_ivec);
     if(m_method_key_data) free(m_method_key_data);
+    if(m_enc_ctx) EVP_CIPHER_CTX_free(m_enc_ctx);
+    if(m_dec_ctx) EVP_CIPHER_CTX_free(m_dec_ctx);
     // CURRENTLY UNUSED: if(m_additional) free(m_additional);
 }
 
@@ -0,0 +1,283 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "condor_common.h"
+#include "condor_crypt_aesgcm.h"
+#include "condor_debug.h"
+
+#include <string>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+// The nonce for message number seq is the base with seq XORed into
+// its last eight bytes.
+static void
+make_nonce(const unsigned char *base, uint64_t seq, unsigned char *nonce)
+{
+    memcpy(nonce, base, Condor_Crypt_AESGCM::IV_SIZE);
+    for (int i = Condor_Crypt_AESGCM::IV_SIZE - 1; i >= Condor_Crypt_AESGCM::IV_SIZE - 8; i--) {
+        nonce[i] ^= (unsigned char)(seq & 0xff);
+        seq >>= 8;
+    }
+}
+
+static void
+put_uint64(unsigned char *buf, uint64_t val)
+{
+    for (int i = 7; i >= 0; i--) {
+        buf[i] = (unsigned char)(val & 0xff);
+        val >>= 8;
+    }
+}
+
+static uint64_t
+get_uint64(const unsigned char *buf)
+{
+    uint64_t val = 0;
+    for (int i = 0; i < 8; i++) {
+        val = (val << 8) | buf[i];
+    }
+    return val;
+}
+
+// HKDF-SHA256 (RFC 5869) with an empty salt, for one 32-byte key.
+static bool
+derive_key(const KeyInfo &session_key, const char *label, unsigned char *key)
+{
+    unsigned char salt[32];
+    unsigned char prk[32];
+    unsigned int len = 0;
+    memset(salt, 0, sizeof(salt));
+    if (!HMAC(EVP_sha256(), salt, sizeof(salt),
+              session_key.getKeyData(), session_key.getKeyLength(), prk, &len) ||
+        len != sizeof(prk))
+    {
+        return false;
+    }
+
+    std::string info(label);
+    info += '\x01';
+    bool ok = HMAC(EVP_sha256(), prk, sizeof(prk),
+                   (const unsigned char *)info.data(), info.size(), key, &len) &&
+              len == 32;
+    memset(prk, 0, sizeof(prk));
+    return ok;
+}
+
+bool Condor_Crypt_AESGCM :: initKeys(Condor_Crypto_State *cs)
+{
+    static const char *client_label = "HTCondor AES-GCM client to server";
+    static const char *server_label = "HTCondor AES-GCM server to client";
+
+    unsigned char enc_key[32];
+    unsigned char dec_key[32];
+    bool ok = derive_key(cs->m_keyInfo, cs->m_is_client ? client_label : server_label, enc_key) &&
+        derive_key(cs->m_keyInfo, cs->m_is_client ? server_label : client_label, dec_key) &&
+        EVP_EncryptInit_ex(cs->m_enc_ctx, EVP_aes_256_gcm(), NULL, enc_key, NULL) == 1 &&
+        EVP_DecryptInit_ex(cs->m_dec_ctx, EVP_aes_256_gcm(), NULL, dec_key, NULL) == 1;
+    memset(enc_key, 0, sizeof(enc_key));
+    memset(dec_key, 0, sizeof(dec_key));
+    return ok;
+}
+
+bool Condor_Crypt_AESGCM :: initState(Condor_Crypto_State *cs)
+{
+    cs->m_enc_ctx = EVP_CIPHER_CTX_new();
+    cs->m_dec_ctx = EVP_CIPHER_CTX_new();
+    bool ok = cs->m_enc_ctx && cs->m_dec_ctx && initKeys(cs) &&
+        RAND_bytes(cs->m_enc_iv, IV_SIZE) == 1;
+
+    cs->m_enc_seq = 0;
+    cs->m_dec_seq = 0;
+    cs->m_enc_iv_sent = false;
+    cs->m_dec_iv_known = false;
+    return ok;
+}
+
+bool Condor_Crypt_AESGCM :: seal(Condor_Crypto_State *cs,
+                                 const unsigned char *aad, int aad_len,
+                                 unsigned char *data, int data_len,
+                                 unsigned char *tag)
+{
+    if (!cs->m_enc_ctx) {
+        return false;
+    }
+
+    unsigned char nonce[IV_SIZE];
+    make_nonce(cs->m_enc_iv, cs->m_enc_seq, nonce);
+
+    int len = 0;
+    EVP_CIPHER_CTX *ctx = cs->m_enc_ctx;
+    if (EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, nonce) != 1) {
+        return false;
+    }
+    if (aad_len > 0 && EVP_EncryptUpdate(ctx, NULL, &len, aad, aad_len) != 1) {
+        return false;
+    }
+    if (data_len > 0 && EVP_EncryptUpdate(ctx, data, &len, data, data_len) != 1) {
+        return false;
+    }
+    if (EVP_EncryptFinal_ex(ctx, data + len, &len) != 1 ||
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_SIZE, tag) != 1)
+    {
+        return false;
+    }
+
+    cs->m_enc_seq++;
+    return true;
+}
+
+bool Condor_Crypt_AESGCM :: open(Condor_Crypto_State *cs,
+                                 const unsigned char *aad, int aad_len,
+                                 unsigned char *data, int data_len,
+                                 const unsigned char *tag)
+{
+    if (!cs->m_dec_ctx || !cs->m_dec_iv_known) {
+        return false;
+    }
+
+    unsigned char nonce[IV_SIZE];
+    make_nonce(cs->m_dec_iv, cs->m_dec_seq, nonce);
+
+    int len = 0;
+    EVP_CIPHER_CTX *ctx = cs->m_dec_ctx;
+    if (EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, nonce) != 1) {
+        return false;
+    }
+    if (aad_len > 0 && EVP_DecryptUpdate(ctx, NULL, &len, aad, aad_len) != 1) {
+        return false;
+    }
+    if (data_len > 0 && EVP_DecryptUpdate(ctx, data, &len, data, data_len) != 1) {
+        return false;
+    }
+    if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, TAG_SIZE, const_cast<unsigned char *>(tag)) != 1 ||
+        EVP_DecryptFinal_ex(ctx, data + len, &len) != 1)
+    {
+        dprintf(D_SECURITY, "CRYPTO: AES-GCM message %llu failed authentication.\n",
+                (unsigned long long)cs->m_dec_seq);
+        return false;
+    }
+
+    cs->m_dec_seq++;
+    return true;
+}
+
+bool Condor_Crypt_AESGCM :: encrypt(Condor_Crypto_State *cs,
+                                    const unsigned char *  input,
+                                    int              input_len, 
+                                    unsigned char *& output, 
+                                    int&             output_len)
+{
+    int iv_len = cs->m_enc_iv_sent ? 0 : IV_SIZE;
+    output_len = iv_len + input_len + TAG_SIZE;
+
+    output = (unsigned char *) malloc(output_len);
+    if (!output) {
+        return false;
+    }
+
+    memcpy(output, cs->m_enc_iv, iv_len);
+    memcpy(output + iv_len, input, input_len);
+    if (!seal(cs, NULL, 0, output + iv_len, input_len, output + iv_len + input_len)) {
+        free(output);
+        output = NULL;
+        output_len = 0;
+        return false;
+    }
+    cs->m_enc_iv_sent = true;
+    return true;
+}
+
+bool Condor_Crypt_AESGCM :: decrypt(Condor_Crypto_State *cs,
+                                    const unsigned char *  input,
+                                    int              input_len, 
+                                    unsigned char *& output, 
+                                    int&             output_len)
+{
+    output = NULL;
+    output_len = 0;
+
+    if (!cs->m_dec_iv_known) {
+        if (input_len < IV_SIZE) {
+            return false;
+        }
+        memcpy(cs->m_dec_iv, input, IV_SIZE);
+        cs->m_dec_iv_known = true;
+        input += IV_SIZE;
+        input_len -= IV_SIZE;
+    }
+    if (input_len < TAG_SIZE) {
+        return false;
+    }
+
+    int len = input_len - TAG_SIZE;
+    output = (unsigned char *) malloc(len > 0 ? len : 1);
+    if (!output) {
+        return false;
+    }
+
+    memcpy(output, input, len);
+    if (!open(cs, NULL, 0, output, len, input + len)) {
+        free(output);
+        output = NULL;
+        return false;
+    }
+    output_len = len;
+    return true;
+}
+
+void Condor_Crypt_AESGCM :: exportStreamState(const Condor_Crypto_State *cs, unsigned char *buf)
+{
+    buf[0] = cs->m_is_client ? 1 : 0;
+    buf++;
+
+    memcpy(buf, cs->m_enc_iv, IV_SIZE);
+    put_uint64(buf + IV_SIZE, cs->m_enc_seq);
+    buf[IV_SIZE + 8] = cs->m_enc_iv_sent ? 1 : 0;
+    buf += IV_SIZE + 8 + 1;
+
+    memcpy(buf, cs->m_dec_iv, IV_SIZE);
+    put_uint64(buf + IV_SIZE, cs->m_dec_seq);
+    buf[IV_SIZE + 8] = cs->m_dec_iv_known ? 1 : 0;
+}
+
+bool Condor_Crypt_AESGCM :: importStreamState(Condor_Crypto_State *cs, const unsigned char *buf)
+{
+    bool is_client = buf[0] != 0;
+    buf++;
+    if (is_client != cs->m_is_client) {
+        cs->m_is_client = is_client;
+        if (!initKeys(cs)) {
+            return false;
+        }
+    }
+
+    memcpy(cs->m_enc_iv, buf, IV_SIZE);
+    cs->m_enc_seq = get_uint64(buf + IV_SIZE);
+    cs->m_enc_iv_sent = buf[IV_SIZE + 8] != 0;
+    buf += IV_SIZE + 8 + 1;
+
+    memcpy(cs->m_dec_iv, buf, IV_SIZE);
+    cs->m_dec_seq = get_uint64(buf + IV_SIZE);
+    cs->m_dec_iv_known = buf[IV_SIZE + 8] != 0;
+    return true;
+}
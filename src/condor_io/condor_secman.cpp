@@ -190,6 +190,22 @@ SecMan::sec_alpha_to_sec_req(char *b) {
 }
 
 
+bool
+SecMan::commandAllowsCompression( int cmd ) {
+		// A compressed socket can't be handed to another process, so
+		// leave it off for every command whose handler does that.
+	switch( cmd ) {
+	case ACTIVATE_CLAIM:		// the startd passes it to the starter
+	case QUERY_SCHEDD_HISTORY:	// the schedd passes it to condor_history
+	case GET_HISTORY:			// and so does the startd
+	case REPLICATION_TRANSFER_FILE_NEW:	// the replication daemon passes it
+										// to condor_transferer
+		return false;
+	default:
+		return true;
+	}
+}
+
 SecMan::sec_feat_act
 SecMan::sec_lookup_feat_act( const ClassAd &ad, const char* pname ) {
 
@@ -506,6 +522,13 @@ SecMan::FillInSecurityPolicyAd( DCpermission auth_level, ClassAd* ad,
 	sec_req sec_integrity = sec_req_param(
 		 "SEC_%s_INTEGRITY", auth_level, SEC_REQ_OPTIONAL);
 
+	// compression needs no key, so it does not depend on authentication
+	sec_req sec_compression = sec_req_param(
+		 "SEC_%s_COMPRESSION", auth_level, SEC_REQ_OPTIONAL);
+#if !defined(HAVE_LIBZ)
+	sec_compression = SEC_REQ_NEVER;
+#endif
+
 
 	// regarding SEC_NEGOTIATE values:
 	// REQUIRED- outgoing will always negotiate, and incoming must
@@ -526,6 +549,7 @@ SecMan::FillInSecurityPolicyAd( DCpermission auth_level, ClassAd* ad,
 		sec_authentication = SEC_REQ_NEVER;
 		sec_encryption = SEC_REQ_NEVER;
 		sec_integrity = SEC_REQ_NEVER;
+		sec_compression = SEC_REQ_NEVER;
 	}
 
 
@@ -609,6 +633,8 @@ SecMan::FillInSecurityPolicyAd( DCpermission auth_level, ClassAd* ad,
 
 	ad->Assign ( ATTR_SEC_INTEGRITY, SecMan::sec_req_rev[sec_integrity] );
 
+	ad->Assign ( ATTR_SEC_COMPRESSION, SecMan::sec_req_rev[sec_compression] );
+
 	ad->Assign ( ATTR_SEC_ENACT, "NO" );
 
 
@@ -858,9 +884,19 @@ SecMan::ReconcileSecurityPolicyAds(const ClassAd &cli_ad, const ClassAd &srv_ad)
 								ATTR_SEC_INTEGRITY,
 								cli_ad, srv_ad );
 
+	// a peer that predates compression does not send the attribute;
+	// that is the same as NEVER, but it is not a reason to fail.
+	sec_feat_act compression_action = SEC_FEAT_ACT_NO;
+	if ( cli_ad.Lookup(ATTR_SEC_COMPRESSION) && srv_ad.Lookup(ATTR_SEC_COMPRESSION) ) {
+		compression_action = ReconcileSecurityAttribute(
+								ATTR_SEC_COMPRESSION,
+								cli_ad, srv_ad );
+	}
+
 	if ( (authentication_action == SEC_FEAT_ACT_FAIL) ||
 	     (encryption_action == SEC_FEAT_ACT_FAIL) ||
-	     (integrity_action == SEC_FEAT_ACT_FAIL) ) {
+	     (integrity_action == SEC_FEAT_ACT_FAIL) ||
+	     (compression_action == SEC_FEAT_ACT_FAIL) ) {
 
 		// one or more decisions could not be agreed upon, so
 		// we fail.
@@ -886,6 +922,8 @@ SecMan::ReconcileSecurityPolicyAds(const ClassAd &cli_ad, const ClassAd &srv_ad)
 
 	action_ad->Assign(ATTR_SEC_INTEGRITY, SecMan::sec_feat_act_rev[integrity_action]);
 
+	action_ad->Assign(ATTR_SEC_COMPRESSION, SecMan::sec_feat_act_rev[compression_action]);
+
 
 	char* cli_methods = NULL;
 	char* srv_methods = NULL;
@@ -1940,6 +1978,10 @@ SecManStartCommand::receiveAuthInfo_inner()
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_AUTH_REQUIRED );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_ENCRYPTION );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_INTEGRITY );
+				// an older server does not answer this one; do not
+				// mistake our own request for its decision
+			m_auth_info.Delete(ATTR_SEC_COMPRESSION);
+			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_COMPRESSION );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_SESSION_DURATION );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_SESSION_LEASE );
 
@@ -2182,7 +2224,18 @@ SecManStartCommand::authenticate_inner_finish()
 			m_sock->encode();
 			m_sock->set_crypto_key(false, m_private_key);
 		}
-		
+
+		bool turn_compression_on = SecMan::commandAllowsCompression( m_cmd ) &&
+			m_sec_man.sec_lookup_feat_act( m_auth_info, ATTR_SEC_COMPRESSION ) == SecMan::SEC_FEAT_ACT_YES;
+		m_sock->encode();
+		if (!m_sock->set_compression(turn_compression_on)) {
+			m_errstack->push ("SECMAN", SECMAN_ERR_INTERNAL,
+						"Failed to enable compression." );
+			return StartCommandFailed;
+		}
+		if (turn_compression_on) {
+			dprintf ( D_SECURITY, "SECMAN: successfully enabled compression!\n");
+		}
 	}
 
 	m_state = ReceivePostAuthInfo;
@@ -3256,6 +3309,8 @@ SecMan::getSecTimeout(DCpermission perm)
 
 Protocol CryptProtocolNameToEnum(char const *name) {
 	switch (toupper(*name)) {
+	case 'A': // aes
+		return CONDOR_AESGCM;
 	case 'B': // blowfish
 		return CONDOR_BLOWFISH;
 	case '3': // 3des
@@ -3313,11 +3368,27 @@ SecMan::CreateNonNegotiatedSecuritySession(DCpermission auth_level, char const *
 	std::string crypto_methods;
 	policy.LookupString(ATTR_SEC_CRYPTO_METHODS,crypto_methods);
 	if( crypto_methods.length() ) {
+			// Unless told otherwise, skip AES here: the other side of
+			// a session like this never tells us which methods it
+			// knows, and versions before AES would not understand
+			// the key.  An imported session still uses whatever
+			// method its creator chose.
+		if( !param_boolean("SEC_ENABLE_AES_FOR_NON_NEGOTIATED_SESSIONS", false) ) {
+			StringList methods(crypto_methods.c_str());
+			methods.rewind();
+			char const *method;
+			while( (method = methods.next()) ) {
+				if( CryptProtocolNameToEnum(method) != CONDOR_AESGCM ) {
+					break;
+				}
+			}
+			crypto_methods = method ? method : "";
+		}
 		size_t pos = crypto_methods.find(',');
 		if( pos != std::string::npos ) {
 			crypto_methods.erase(pos);
-			policy.Assign(ATTR_SEC_CRYPTO_METHODS,crypto_methods);
 		}
+		policy.Assign(ATTR_SEC_CRYPTO_METHODS,crypto_methods);
 	}
 
 	delete auth_info;
@@ -3630,6 +3701,7 @@ SecMan::SetSessionExpiration(char const *session_id,time_t expiration_time) {
 		return false;
 	}
 	session_key->setExpiration(expiration_time);
+	session_cache->updateExpiration(session_key);
 
 	dprintf(D_SECURITY,"Set expiration time for security session %s to %ds\n",session_id,(int)(expiration_time-time(NULL)));
 
@@ -30,11 +30,46 @@
 #include "ccb_client.h"
 #include "condor_sockfunc.h"
 
+#if defined(HAVE_LIBZ)
+#include <zlib.h>
+#endif
+
 #define NORMAL_HEADER_SIZE 5
 #define MAX_HEADER_SIZE MAC_SIZE + NORMAL_HEADER_SIZE
 
 /**************************************************************/
 
+/*
+   Stream compression.  Bytes handed to put_bytes() are run through a
+   zlib deflate stream, then encrypted (if encryption is on), then
+   packetized as usual; get_bytes() reverses this.  Each message ends
+   with a Z_SYNC_FLUSH, so the receiver can decode everything in a
+   message without looking at the next one, while the compression
+   history carries over from message to message.  That is what makes
+   a long series of similar ClassAds compress well.
+*/
+
+#define COMPRESS_CHUNK_SIZE 16384
+
+struct ReliSock::CompressState {
+#if defined(HAVE_LIBZ)
+	z_stream deflater;
+	z_stream inflater;
+	bool deflater_ready;
+	bool inflater_ready;
+	bool deflate_pending;	// data given to deflate since the last flush
+	unsigned char out[COMPRESS_CHUNK_SIZE];		// compressed, to send
+	unsigned char in[COMPRESS_CHUNK_SIZE];		// compressed, received
+	unsigned char plain[COMPRESS_CHUNK_SIZE];	// decompressed, not yet read
+	int plain_pos;
+	int plain_len;
+#else
+	int unused;
+#endif
+};
+
+/**************************************************************/
+
 /* 
    NOTE: All ReliSock constructors initialize with this, so you can
    put any shared initialization code here.  -Derek Wright 3/12/99
@@ -60,6 +95,9 @@ ReliSock::init()
 	rcv_msg.init_parent(this);
 	snd_msg.init_parent(this);
 	m_target_shared_port_id = NULL;
+	m_compress = NULL;
+	m_compress_level = 1;
+	compress_mode_ = false;
 }
 
 
@@ -74,10 +112,13 @@ ReliSock::ReliSock(const ReliSock & orig) : Sock(orig)
 	init();
 	// now copy all cedar state info via the serialize() method
 	char *buf = NULL;
-	buf = orig.serialize();	// get state from orig sock
+	buf = orig.serialize_state();	// get state from orig sock
 	ASSERT(buf);
 	serialize(buf);			// put the state into the new sock
 	delete [] buf;
+		// the copy stays in this process, so it can take over the
+		// compression streams, which serialize() can't carry
+	copy_compression(orig);
 }
 
 Stream *
@@ -113,6 +154,8 @@ ReliSock::close()
 	// Purge send and receive buffers at the relisock level
 	snd_msg.reset();
 	rcv_msg.reset();
+	clear_compression();
+	compress_mode_ = false;
 
 	// then invoke close() in parent class to close fd etc
 	return Sock::close();
@@ -329,7 +372,11 @@ ReliSock::put_bytes_nobuffer( const char *buffer, int length, int send_size )
 	int pagesize = 65536;  // Optimize large writes to be page sized.
 	const char * cur;
 	unsigned char * buf = NULL;
-        
+
+	if (get_encryption() && crypto_is_aead()) {
+		return put_bytes_sealed(buffer, length, send_size);
+	}
+
 	// First, encrypt the data if necessary
 	if (get_encryption()) {
 		if (!wrap((const unsigned char *) buffer, length,  buf , l_out)) {
@@ -402,6 +449,10 @@ ReliSock::get_bytes_nobuffer(char *buffer, int max_length, int receive_size)
 	ASSERT(buffer != NULL);
 	ASSERT(max_length > 0);
 
+	if (get_encryption() && crypto_is_aead()) {
+		return get_bytes_sealed(buffer, max_length, receive_size);
+	}
+
 	// Find out how big the file is going to be, if requested.
 	// No receive_size means read max_length bytes.
 	this->decode();
@@ -447,6 +498,93 @@ ReliSock::get_bytes_nobuffer(char *buffer, int max_length, int receive_size)
         return -1;
 }
 
+// AES-GCM can only protect data inside CEDAR packets, so with it the
+// "unbuffered" data is sent as a message of its own: one large packet
+// per call, sealed in place, bypassing compression.  As with the raw
+// version, the stream is left ready for the caller's end_of_message().
+int
+ReliSock::put_bytes_sealed( const char *buffer, int length, int send_size )
+{
+	this->encode();
+	if ( send_size ) {
+		ASSERT( this->code(length) != FALSE );
+		ASSERT( this->end_of_message() != FALSE );
+	}
+
+	if ( !prepare_for_nobuffering(stream_encode) ) {
+		dprintf(D_ALWAYS, "ReliSock::put_bytes_nobuffer: Send failed.\n");
+		return -1;
+	}
+	if ( length <= 0 ) {
+		return 0;
+	}
+
+	if ( snd_msg.buf.max_size() < length + NORMAL_HEADER_SIZE ) {
+		snd_msg.buf.grow_buf( MIN(length, 65536) + NORMAL_HEADER_SIZE );
+	}
+
+	bool is_non_blocking = m_non_blocking;
+	m_non_blocking = false;
+	int result = put_bytes_after_encryption(buffer, length);
+	if ( result == length ) {
+		if ( !snd_msg.snd_packet(peer_description(), _sock, TRUE, _timeout) ) {
+			result = -1;
+		}
+	}
+	m_non_blocking = is_non_blocking;
+
+	if ( result != length ) {
+		dprintf(D_ALWAYS, "ReliSock::put_bytes_nobuffer: Send failed.\n");
+		return -1;
+	}
+	ignore_next_encode_eom = TRUE;
+	return length;
+}
+
+int
+ReliSock::get_bytes_sealed( char *buffer, int max_length, int receive_size )
+{
+	int length;
+
+	this->decode();
+	if ( receive_size ) {
+		ASSERT( this->code(length) != FALSE );
+		ASSERT( this->end_of_message() != FALSE );
+	} else {
+		length = max_length;
+	}
+
+	if ( !prepare_for_nobuffering(stream_decode) ) {
+		return -1;
+	}
+	if( length > max_length ) {
+		dprintf(D_ALWAYS, 
+			"ReliSock::get_bytes_nobuffer: data too large for buffer.\n");
+		return -1;
+	}
+
+		// The sender's messages need not line up with our reads, so
+		// take what we need and leave the rest for the next call.
+	int got = 0;
+	while ( got < length ) {
+		while ( !rcv_msg.ready ) {
+			if ( handle_incoming_packet() != TRUE ) {
+				dprintf(D_ALWAYS, 
+					"ReliSock::get_bytes_nobuffer: Failed to receive file.\n");
+				return -1;
+			}
+		}
+		got += rcv_msg.buf.get(buffer + got, length - got);
+		if ( rcv_msg.buf.consumed() ) {
+			rcv_msg.ready = FALSE;
+			rcv_msg.buf.reset();
+		}
+	}
+
+	_bytes_recvd += got;
+	ignore_next_decode_eom = TRUE;
+	return got;
+}
 
 int 
 ReliSock::handle_incoming_packet()
@@ -514,6 +652,28 @@ ReliSock::end_of_message_internal()
 {
 	int ret_val = FALSE;
 
+		// Compressed bytes still held by zlib belong to this message,
+		// and must be encrypted/decrypted before the crypto state is reset.
+	if ( get_compression() ) {
+		if ( _coding == stream_encode && ignore_next_encode_eom != TRUE ) {
+			if ( !flush_compression() ) {
+				return FALSE;
+			}
+		}
+		else if ( _coding == stream_decode && ignore_next_decode_eom != TRUE && rcv_msg.ready ) {
+			int untouched = drain_decompressed();
+			if ( untouched != 0 ) {
+				char const *ip = get_sinful_peer();
+				dprintf(D_FULLDEBUG,"Failed to read end of compressed message from %s; %d untouched bytes.\n",ip ? ip : "(null)", untouched);
+				rcv_msg.ready = FALSE;
+				rcv_msg.buf.reset();
+				allow_empty_message_flag = FALSE;
+				resetCrypto();
+				return FALSE;
+			}
+		}
+	}
+
     resetCrypto();
 	switch(_coding){
 		case stream_encode:
@@ -568,6 +728,10 @@ bool
 ReliSock::peek_end_of_message()
 {
 	if ( rcv_msg.ready ) {
+		if ( get_compression() ) {
+				// the tail of the message may be nothing but a flush marker
+			return fill_decompressed() && m_compress->plain_pos == m_compress->plain_len;
+		}
 		if ( rcv_msg.buf.consumed() ) {
 			return true;
 		}
@@ -583,10 +747,15 @@ const char * ReliSock :: isIncomingDataHashed()
 int 
 ReliSock::put_bytes(const void *data, int sz)
 {
+		if (get_compression()) {
+			return put_bytes_compressed(data, sz);
+		}
+
         // Check to see if we need to encrypt
         // Okay, this is a bug! H.W. 9/25/2001
+        // AES-GCM encrypts whole packets in SndMsg::snd_packet() instead.
 
-        if (get_encryption()) {
+        if (get_encryption() && !crypto_is_aead()) {
         	unsigned char * dta = NULL;
 			int l_out;
             if (!wrap((const unsigned char *)(data), sz, dta , l_out)) {
@@ -614,7 +783,7 @@ ReliSock::put_bytes_after_encryption(const void *dta, int sz) {
 
 	int		nw;
 	int 	tw = 0;
-	int		header_size = isOutgoing_Hash_on() ? MAX_HEADER_SIZE:NORMAL_HEADER_SIZE;
+	int		header_size = (isOutgoing_Hash_on() && !crypto_is_aead()) ? MAX_HEADER_SIZE:NORMAL_HEADER_SIZE;
 	for(nw=0;;) {
 		
 		if (snd_msg.buf.full()) {
@@ -671,10 +840,14 @@ ReliSock::get_bytes(void *dta, int max_sz)
 		}
 	}
 
+	if (get_compression()) {
+		return get_bytes_compressed(dta, max_sz);
+	}
+
 	bytes = rcv_msg.buf.get(dta, max_sz);
 
 	if (bytes > 0) {
-            if (get_encryption()) {
+            if (get_encryption() && !crypto_is_aead()) {
                 unwrap((unsigned char *) dta, bytes, data, length);
                 memcpy(dta, data, bytes);
                 free(data);
@@ -688,6 +861,13 @@ ReliSock::get_bytes(void *dta, int max_sz)
 
 int ReliSock::get_ptr( void *&ptr, char delim)
 {
+	if (get_compression()) {
+			// Stream never asks for this while compressing; strings
+			// are length-prefixed, just as they are when encrypting.
+		dprintf(D_ALWAYS, "ReliSock::get_ptr() is not supported on a compressed stream\n");
+		return FALSE;
+	}
+
 	while (!rcv_msg.ready){
 		if (!handle_incoming_packet()) {
 			return FALSE;
@@ -706,9 +886,355 @@ int ReliSock::peek( char &c)
 		}
 	}
 
+	if (get_compression()) {
+		if (!fill_decompressed() || m_compress->plain_pos == m_compress->plain_len) {
+			return FALSE;
+		}
+		c = (char)m_compress->plain[m_compress->plain_pos];
+		return TRUE;
+	}
+
 	return rcv_msg.buf.peek(c);
 }
 
+bool
+ReliSock::set_tcp_cork(bool enable)
+{
+#ifdef TCP_CORK
+	int on = enable ? 1 : 0;
+	if( _state == sock_virgin || setsockopt(IPPROTO_TCP, TCP_CORK, (char*)&on, sizeof(on)) < 0 ) {
+		return false;
+	}
+	return true;
+#else
+	(void)enable;
+	return false;
+#endif
+}
+
+bool
+ReliSock::set_compression(bool enable)
+{
+	if (enable == get_compression()) {
+			// The security handshake runs again for every command sent
+			// on a reused socket; leave the running streams alone.
+		return true;
+	}
+
+	if (!enable) {
+		if (_coding == stream_encode && !flush_compression()) {
+			return false;
+		}
+		clear_compression();
+		compress_mode_ = false;
+		return true;
+	}
+
+#if defined(HAVE_LIBZ)
+	m_compress = new CompressState();
+	compress_mode_ = true;
+	dprintf(D_NETWORK|D_VERBOSE, "Compression enabled for %s (level %d)\n",
+			peer_description(), m_compress_level);
+	return true;
+#else
+	dprintf(D_ALWAYS, "Cannot enable compression for %s: no zlib support\n",
+			peer_description());
+	return false;
+#endif
+}
+
+void
+ReliSock::set_compression_level(int level)
+{
+	if (level < 0) { level = 0; }
+	if (level > 9) { level = 9; }
+	if (level == m_compress_level) {
+		return;
+	}
+	m_compress_level = level;
+
+#if defined(HAVE_LIBZ)
+	if (m_compress && m_compress->deflater_ready) {
+		z_stream &zs = m_compress->deflater;
+		zs.next_in = NULL;
+		zs.avail_in = 0;
+		zs.next_out = m_compress->out;
+		zs.avail_out = sizeof(m_compress->out);
+		int rc = deflateParams(&zs, level, Z_DEFAULT_STRATEGY);
+		int have = (int)(sizeof(m_compress->out) - zs.avail_out);
+		if (have > 0) {
+				// whatever zlib wrote is part of the stream, so send it
+			put_compressed_output(m_compress->out, have);
+			m_compress->deflate_pending = true;
+		}
+		if (rc != Z_OK) {
+			dprintf(D_NETWORK, "ReliSock: unable to change compression level to %d for %s\n",
+					level, peer_description());
+		}
+	}
+#endif
+}
+
+void
+ReliSock::copy_compression(const ReliSock &orig)
+{
+	m_compress_level = orig.m_compress_level;
+	if (!orig.m_compress) {
+		return;
+	}
+#if defined(HAVE_LIBZ)
+	const CompressState &from = *orig.m_compress;
+	m_compress = new CompressState(from);
+	compress_mode_ = true;
+
+		// The z_streams point at the buffers of the original, and zlib
+		// has to copy its own state.
+	if (from.deflater_ready) {
+		if (deflateCopy(&m_compress->deflater, const_cast<z_stream *>(&from.deflater)) != Z_OK) {
+			EXCEPT("ReliSock: unable to copy compression state (out of memory)");
+		}
+		m_compress->deflater.next_in = NULL;
+		m_compress->deflater.avail_in = 0;
+	}
+	if (from.inflater_ready) {
+		if (inflateCopy(&m_compress->inflater, const_cast<z_stream *>(&from.inflater)) != Z_OK) {
+			EXCEPT("ReliSock: unable to copy decompression state (out of memory)");
+		}
+		if (from.inflater.avail_in) {
+			m_compress->inflater.next_in = m_compress->in + (from.inflater.next_in - from.in);
+		} else {
+			m_compress->inflater.next_in = NULL;
+		}
+	}
+#endif
+}
+
+void
+ReliSock::clear_compression()
+{
+	if (!m_compress) {
+		return;
+	}
+#if defined(HAVE_LIBZ)
+	if (m_compress->deflater_ready) {
+		deflateEnd(&m_compress->deflater);
+	}
+	if (m_compress->inflater_ready) {
+		inflateEnd(&m_compress->inflater);
+	}
+#endif
+	delete m_compress;
+	m_compress = NULL;
+}
+
+int
+ReliSock::put_bytes_compressed(const void *data, int sz)
+{
+#if defined(HAVE_LIBZ)
+	ignore_next_encode_eom = FALSE;
+
+	if (!m_compress->deflater_ready) {
+		if (deflateInit(&m_compress->deflater, m_compress_level) != Z_OK) {
+			dprintf(D_ALWAYS, "ReliSock: failed to initialize compression for %s\n",
+					peer_description());
+			return -1;
+		}
+		m_compress->deflater_ready = true;
+	}
+
+	z_stream &zs = m_compress->deflater;
+	zs.next_in = (Bytef *)data;
+	zs.avail_in = sz;
+	do {
+		zs.next_out = m_compress->out;
+		zs.avail_out = sizeof(m_compress->out);
+		if (deflate(&zs, Z_NO_FLUSH) == Z_STREAM_ERROR) {
+			dprintf(D_ALWAYS, "ReliSock: compression failed for %s\n", peer_description());
+			return -1;
+		}
+		int have = (int)(sizeof(m_compress->out) - zs.avail_out);
+		if (have > 0 && !put_compressed_output(m_compress->out, have)) {
+			return -1;
+		}
+	} while (zs.avail_out == 0);
+
+	m_compress->deflate_pending = true;
+	return sz;
+#else
+	(void)data; (void)sz;
+	return -1;
+#endif
+}
+
+bool
+ReliSock::put_compressed_output(const unsigned char *data, int sz)
+{
+	if (get_encryption() && !crypto_is_aead()) {
+		unsigned char * dta = NULL;
+		int l_out;
+		if (!wrap(data, sz, dta, l_out)) {
+			dprintf(D_SECURITY, "Encryption failed\n");
+			free(dta);
+			return false;
+		}
+		int r = put_bytes_after_encryption(dta, sz);
+		free(dta);
+		return r == sz;
+	}
+	return put_bytes_after_encryption(data, sz) == sz;
+}
+
+bool
+ReliSock::flush_compression()
+{
+#if defined(HAVE_LIBZ)
+	if (!m_compress || !m_compress->deflate_pending) {
+		return true;
+	}
+
+	z_stream &zs = m_compress->deflater;
+	zs.next_in = NULL;
+	zs.avail_in = 0;
+	do {
+		zs.next_out = m_compress->out;
+		zs.avail_out = sizeof(m_compress->out);
+		if (deflate(&zs, Z_SYNC_FLUSH) == Z_STREAM_ERROR) {
+			dprintf(D_ALWAYS, "ReliSock: compression flush failed for %s\n", peer_description());
+			return false;
+		}
+		int have = (int)(sizeof(m_compress->out) - zs.avail_out);
+		if (have > 0 && !put_compressed_output(m_compress->out, have)) {
+			return false;
+		}
+	} while (zs.avail_out == 0);
+
+	m_compress->deflate_pending = false;
+#endif
+	return true;
+}
+
+// Refill the buffer of decompressed bytes from the current message.
+// Returns false on a decompression error; an empty buffer on return
+// means the message holds no more data.
+bool
+ReliSock::fill_decompressed()
+{
+#if defined(HAVE_LIBZ)
+	CompressState &cs = *m_compress;
+	if (cs.plain_pos < cs.plain_len) {
+		return true;
+	}
+	cs.plain_pos = cs.plain_len = 0;
+
+	if (!cs.inflater_ready) {
+		if (inflateInit(&cs.inflater) != Z_OK) {
+			dprintf(D_ALWAYS, "ReliSock: failed to initialize decompression for %s\n",
+					peer_description());
+			return false;
+		}
+		cs.inflater_ready = true;
+	}
+
+	z_stream &zs = cs.inflater;
+	for (;;) {
+		bool more_input = true;
+		if (zs.avail_in == 0) {
+			int got = rcv_msg.buf.get(cs.in, sizeof(cs.in));
+			if (got <= 0) {
+					// inflate may still hold output for input it
+					// already consumed, so give it one more call
+				more_input = false;
+				got = 0;
+			}
+			else if (get_encryption() && !crypto_is_aead()) {
+				unsigned char *data = NULL;
+				int length = 0;
+				if (!unwrap(cs.in, got, data, length) || !data ||
+					length < 0 || length > (int)sizeof(cs.in))
+				{
+					dprintf(D_ALWAYS, "ReliSock: failed to decrypt compressed data from %s\n",
+							peer_description());
+					free(data);
+					return false;
+				}
+				memcpy(cs.in, data, length);
+				free(data);
+				got = length;
+			}
+			_bytes_recvd += got;
+			zs.next_in = cs.in;
+			zs.avail_in = got;
+		}
+
+		zs.next_out = cs.plain;
+		zs.avail_out = sizeof(cs.plain);
+		int rc = inflate(&zs, Z_SYNC_FLUSH);
+		if (rc != Z_OK && rc != Z_BUF_ERROR) {
+			dprintf(D_ALWAYS, "ReliSock: failed to decompress data from %s: %s\n",
+					peer_description(), zs.msg ? zs.msg : "unknown error");
+			return false;
+		}
+		cs.plain_len = (int)(sizeof(cs.plain) - zs.avail_out);
+		if (cs.plain_len > 0 || !more_input) {
+			return true;
+		}
+	}
+#else
+	return false;
+#endif
+}
+
+int
+ReliSock::get_bytes_compressed(void *dta, int max_sz)
+{
+#if defined(HAVE_LIBZ)
+	CompressState &cs = *m_compress;
+	int total = 0;
+	while (total < max_sz) {
+		if (!fill_decompressed()) {
+			return -1;
+		}
+		int avail = cs.plain_len - cs.plain_pos;
+		if (avail == 0) {
+			break;
+		}
+		int n = MIN(avail, max_sz - total);
+		memcpy((char *)dta + total, &cs.plain[cs.plain_pos], n);
+		cs.plain_pos += n;
+		total += n;
+	}
+	return total;
+#else
+	(void)dta; (void)max_sz;
+	return -1;
+#endif
+}
+
+// Decompress and throw away whatever is left of the current message,
+// so the inflate stream stays in step with the sender.  Returns the
+// number of decompressed bytes discarded, or -1 on error.
+int
+ReliSock::drain_decompressed()
+{
+#if defined(HAVE_LIBZ)
+	CompressState &cs = *m_compress;
+	int discarded = 0;
+	for (;;) {
+		discarded += cs.plain_len - cs.plain_pos;
+		cs.plain_pos = cs.plain_len;
+		if (!fill_decompressed()) {
+			return -1;
+		}
+		if (cs.plain_pos == cs.plain_len) {
+			break;
+		}
+	}
+	return discarded;
+#else
+	return -1;
+#endif
+}
+
 bool ReliSock::RcvMsg::init_MD(CONDOR_MD_MODE mode, KeyInfo * key)
 {
     if (!buf.consumed()) {
@@ -759,6 +1285,10 @@ int ReliSock::RcvMsg::rcv_packet( char const *peer_description, SOCKET _sock, in
 	int		tmp_len;
 	int		retval;
 	const int max_packet_size = 1024 * 1024;  // We will reject packets bigger than this
+		// A sealed (AES-GCM) packet is authenticated by its tag, so it
+		// carries no separate MAC.
+	bool sealed = p_sock->crypto_is_aead();
+	bool use_md = (mode_ != MD_OFF) && !sealed;
 
 	// We read the partial packet in a previous read; try to finish it and
 	// then skip down to packet verification.
@@ -769,7 +1299,7 @@ int ReliSock::RcvMsg::rcv_packet( char const *peer_description, SOCKET _sock, in
 		goto read_packet;
 	}
 
-	header_size = (mode_ != MD_OFF) ? MAX_HEADER_SIZE : NORMAL_HEADER_SIZE;
+	header_size = use_md ? MAX_HEADER_SIZE : NORMAL_HEADER_SIZE;
 	header_filled = 0;
 
 	retval = condor_read(peer_description,_sock,hdr,header_size,_timeout, 0, p_sock->is_non_blocking());
@@ -857,7 +1387,7 @@ read_packet:
 		if (p_sock->is_non_blocking() && (tmp_len >= 0)) {
 			m_partial_packet = true;
 			m_remaining_read_length = len - tmp_len;
-			if ( mode_ != MD_OFF && cksum_ptr != m_partial_cksum ) {
+			if ( use_md && cksum_ptr != m_partial_cksum ) {
 				memcpy( m_partial_cksum, cksum_ptr, sizeof(m_partial_cksum) );
 			}
 			return 2;
@@ -871,7 +1401,7 @@ read_packet:
 	}
 
         // Now, check MD
-        if (mode_ != MD_OFF) {
+        if (use_md) {
             if (!m_tmp->verifyMD(cksum_ptr, mdChecker_)) {
                 delete m_tmp;
 		m_tmp = NULL;
@@ -879,6 +1409,15 @@ read_packet:
                 return FALSE;  // or something other than this
             }
         }
+
+	if (sealed) {
+		if (!m_tmp->openAEAD((char) m_end, p_sock->crypto_state_)) {
+			delete m_tmp;
+			m_tmp = NULL;
+			dprintf(D_ALWAYS, "IO: Packet decryption/authentication failed!\n");
+			return FALSE;
+		}
+	}
         
 	if (!buf.put(m_tmp)) {
 		delete m_tmp;
@@ -970,14 +1509,23 @@ int ReliSock::SndMsg::snd_packet( char const *peer_description, int _sock, int e
 	int		len, header_size;
 	int		ns;
 
-	header_size = (mode_ != MD_OFF) ? MAX_HEADER_SIZE : NORMAL_HEADER_SIZE;
+	bool sealed = p_sock->crypto_is_aead();
+	header_size = (mode_ != MD_OFF && !sealed) ? MAX_HEADER_SIZE : NORMAL_HEADER_SIZE;
 	hdr[0] = (char) end;
+
+	if (sealed) {
+		if (!buf.sealAEAD(hdr[0], header_size, p_sock->crypto_state_)) {
+			dprintf(D_ALWAYS, "IO: Failed to encrypt packet\n");
+			return FALSE;
+		}
+	}
+
 	ns = buf.num_used() - header_size;
 	len = (int) htonl(ns);
 
 	memcpy(&hdr[1], &len, 4);
 
-	if (mode_ != MD_OFF) {
+	if (mode_ != MD_OFF && !sealed) {
 		if (!buf.computeMD(&hdr[5], mdChecker_)) {
 			dprintf(D_ALWAYS, "IO: Failed to compute Message Digest/MAC\n");
 			return FALSE;
@@ -1056,6 +1604,20 @@ ReliSock::type() const
 
 char *
 ReliSock::serialize() const
+{
+	if (get_compression()) {
+			// zlib state cannot be handed to another process, and a
+			// copy that doesn't compress would garble the stream.
+			// SecMan never negotiates compression for the commands
+			// whose sockets are handed to a child.
+		dprintf(D_ALWAYS, "ReliSock::serialize(): socket to %s is compressed and cannot be serialized\n", peer_description());
+		return NULL;
+	}
+	return serialize_state();
+}
+
+char *
+ReliSock::serialize_state() const
 {
 	MyString state;
 
@@ -1148,6 +1710,9 @@ ReliSock::prepare_for_nobuffering(stream_coding direction)
 				// just return true.
 				return TRUE;
 			}
+			if ( get_compression() && !flush_compression() ) {
+				return FALSE;
+			}
 			if (!snd_msg.buf.empty()) {
 				bool is_non_blocking = m_non_blocking;
 				m_non_blocking = false;
@@ -1166,7 +1731,11 @@ ReliSock::prepare_for_nobuffering(stream_coding direction)
 				return TRUE;
 			}
 			if ( rcv_msg.ready ) {
-				if ( !rcv_msg.buf.consumed() )
+				if ( get_compression() ) {
+					if ( drain_decompressed() != 0 )
+						ret_val = FALSE;
+				}
+				else if ( !rcv_msg.buf.consumed() )
 					ret_val = FALSE;
 				rcv_msg.ready = FALSE;
 				rcv_msg.buf.reset();
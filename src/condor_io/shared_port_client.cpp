@@ -32,6 +32,12 @@ unsigned int SharedPortClient::m_maxPendingPassSocketCalls = 0;
 unsigned int SharedPortClient::m_successPassSocketCalls = 0;
 unsigned int SharedPortClient::m_failPassSocketCalls = 0;
 unsigned int SharedPortClient::m_wouldBlockPassSocketCalls = 0;
+stats_entry_probe<double> SharedPortClient::m_passSocketTime;
+bool SharedPortClient::m_socket_dirs_cached = false;
+bool SharedPortClient::m_has_socket_dir = false;
+bool SharedPortClient::m_has_alt_socket_dir = false;
+std::string SharedPortClient::m_socket_dir;
+std::string SharedPortClient::m_alt_socket_dir;
 
 
 #ifdef HAVE_SCM_RIGHTS_PASSFD
@@ -51,7 +57,8 @@ public:
 		  m_sock_name("UNKNOWN"),
 		  m_state(UNBOUND),
 		  m_non_blocking(non_blocking),
-		  m_dealloc_sock(false)
+		  m_dealloc_sock(false),
+		  m_start_time(_condor_debug_get_time_double())
 	{
 		// Ctor
 
@@ -88,6 +95,7 @@ private:
 	SPState m_state;
 	bool m_non_blocking;
 	bool m_dealloc_sock;
+	double m_start_time;
 
 	HandlerResult HandleUnbound(Stream *&s);
 	HandlerResult HandleHeader(Stream *&s);
@@ -179,6 +187,29 @@ SharedPortClient::myName()
 	return name;
 }
 
+void
+SharedPortClient::CacheDaemonSocketDirs()
+{
+	m_socket_dirs_cached = false;
+	GetDaemonSocketDirs(m_socket_dir, m_has_socket_dir, m_alt_socket_dir, m_has_alt_socket_dir);
+	m_socket_dirs_cached = true;
+}
+
+void
+SharedPortClient::GetDaemonSocketDirs(std::string &dir, bool &has_dir,
+                                      std::string &alt_dir, bool &has_alt_dir)
+{
+	if( m_socket_dirs_cached ) {
+		dir = m_socket_dir;
+		has_dir = m_has_socket_dir;
+		alt_dir = m_alt_socket_dir;
+		has_alt_dir = m_has_alt_socket_dir;
+		return;
+	}
+	has_dir = SharedPortEndpoint::GetDaemonSocketDir(dir);
+	has_alt_dir = SharedPortEndpoint::GetAltDaemonSocketDir(alt_dir);
+}
+
 bool
 SharedPortClient::SharedPortIdIsValid(char const *shared_port_id)
 {
@@ -416,6 +447,7 @@ SharedPortState::Handle(Stream *s)
 	// Update result statistics
 	if (result == DONE) {
 		SharedPortClient::m_successPassSocketCalls++;
+		SharedPortClient::m_passSocketTime.Add(_condor_debug_get_time_double() - m_start_time);
 	}
 	if (result == FAILED) {
 		SharedPortClient::m_failPassSocketCalls++;
@@ -456,8 +488,9 @@ SharedPortState::HandleUnbound(Stream *&s)
 
 	std::string sock_name;
 	std::string alt_sock_name;
-	bool has_socket = SharedPortEndpoint::GetDaemonSocketDir(sock_name);;
-	bool has_alt_socket = SharedPortEndpoint::GetAltDaemonSocketDir(alt_sock_name);;
+	bool has_socket = false;
+	bool has_alt_socket = false;
+	SharedPortClient::GetDaemonSocketDirs(sock_name, has_socket, alt_sock_name, has_alt_socket);
 
 	std::stringstream ss;
 	ss << sock_name << DIR_DELIM_CHAR << m_shared_port_id;
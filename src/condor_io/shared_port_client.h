@@ -22,6 +22,7 @@
 
 #include "MyString.h"
 #include "reli_sock.h"
+#include "generic_stats.h"
 
 class SharedPortState;
 
@@ -47,10 +48,19 @@ friend class SharedPortState;
 		{return m_failPassSocketCalls;}
 	unsigned int get_wouldBlockPassSocketCalls() 
 		{return m_wouldBlockPassSocketCalls;}
+	stats_entry_probe<double> const &get_passSocketTime()
+		{return m_passSocketTime;}
+
+		// Look up the daemon socket directory and its alternate once
+		// and use them for every following PassSocket(), rather than
+		// on each call.  Call again on reconfig to refresh.
+	static void CacheDaemonSocketDirs();
 
  private:
 	MyString myName();
 	bool static SharedPortIdIsValid(char const *name);
+	static void GetDaemonSocketDirs(std::string &dir, bool &has_dir,
+	                                std::string &alt_dir, bool &has_alt_dir);
 
 	// Some operational metrics filled in by the SharedPortState
 	// class, which does the heavy lifting during a call to PassSocket().
@@ -64,6 +74,15 @@ friend class SharedPortState;
 	static unsigned int m_successPassSocketCalls;
 	static unsigned int m_failPassSocketCalls;
 	static unsigned int m_wouldBlockPassSocketCalls;
+		// seconds from the start of PassSocket() until the target
+		// daemon acknowledged receipt of the socket
+	static stats_entry_probe<double> m_passSocketTime;
+
+	static bool m_socket_dirs_cached;
+	static bool m_has_socket_dir;
+	static bool m_has_alt_socket_dir;
+	static std::string m_socket_dir;
+	static std::string m_alt_socket_dir;
 };
 
 #endif
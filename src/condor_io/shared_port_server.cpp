@@ -49,7 +49,10 @@ SharedPortServer::InitAndReconfig() {
 	if( !m_registered_handlers ) {
 		m_registered_handlers = true;
 
-		int rc = daemonCore->Register_Command(
+			// Wait (without blocking) for the rest of the request to
+			// arrive before calling the handler, so that a slow client
+			// does not hold up the connections queued behind it.
+		int rc = daemonCore->Register_CommandWithPayload(
 			SHARED_PORT_CONNECT,
 			"SHARED_PORT_CONNECT",
 			(CommandHandlercpp)&SharedPortServer::HandleConnectRequest,
@@ -71,6 +74,8 @@ SharedPortServer::InitAndReconfig() {
 		m_default_id = "collector";
 	}
 
+	SharedPortClient::CacheDaemonSocketDirs();
+
 	PublishAddress();
 
 	if( m_publish_addr_timer == -1 ) {
@@ -153,6 +158,7 @@ SharedPortServer::PublishAddress()
 	ad.Assign("RequestsBlocked",m_shared_port_client.get_wouldBlockPassSocketCalls());
 	ad.Assign("ForkedChildrenCurrent",forker.getNumWorkers());
 	ad.Assign("ForkedChildrenPeak",forker.getPeakWorkers());
+	m_shared_port_client.get_passSocketTime().Publish(ad,"RequestsHandoffTime",IF_BASICPUB);
 
 	// print the ad to our log file as D_ALWAYS for now, as a) it contains
 	// metrics that may be useful for debugging, and b) this method is 
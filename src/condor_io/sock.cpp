@@ -51,6 +51,7 @@
 #ifdef HAVE_EXT_OPENSSL
 #include "condor_crypt_blowfish.h"
 #include "condor_crypt_3des.h"
+#include "condor_crypt_aesgcm.h"
 #include "condor_md.h"                // Message authentication stuff
 #endif
 
@@ -2084,10 +2085,21 @@ char * Sock::serializeCryptoInfo() const
     // currently we are not serializing the ivec.  this works because the
     // crypto state (including ivec) is reset to zero after inheriting.
 
+    // An AES-GCM stream, on the other hand, must carry on with the
+    // same nonces and sequence numbers, so those follow the key.
+    int stream_state_len = 0;
+#ifdef HAVE_EXT_OPENSSL
+    unsigned char stream_state[Condor_Crypt_AESGCM::STREAM_STATE_SIZE];
+    if (len > 0 && crypto_is_aead()) {
+        Condor_Crypt_AESGCM::exportStreamState(crypto_state_, stream_state);
+        stream_state_len = sizeof(stream_state);
+    }
+#endif
+
     // here we want to save our state into a buffer
     char * outbuf = NULL;
     if (len > 0) {
-        int buflen = len*2+32;
+        int buflen = len*2+stream_state_len*2+32;
         outbuf = new char[buflen];
         sprintf(outbuf,"%d*%d*%d*", len*2, (int)get_crypto_key().getProtocol(),
                 (int)get_encryption());
@@ -2097,6 +2109,14 @@ char * Sock::serializeCryptoInfo() const
         for (int i=0; i < len; i++, kserial++, ptr+=2) {
             sprintf(ptr, "%02X", *kserial);
         }
+#ifdef HAVE_EXT_OPENSSL
+        if (stream_state_len > 0) {
+            *(ptr++) = '*';
+            for (int i=0; i < stream_state_len; i++, ptr+=2) {
+                sprintf(ptr, "%02X", stream_state[i]);
+            }
+        }
+#endif
     }
     else {
         outbuf = new char[2];
@@ -2192,6 +2212,22 @@ const char * Sock::serializeCryptoInfo(const char * buf)
         KeyInfo k((unsigned char *)kserial, len, (Protocol)protocol);
         set_crypto_key(encryption_mode==1, &k, 0);
         free(kserial);
+
+#ifdef HAVE_EXT_OPENSSL
+        if (crypto_is_aead()) {
+            ASSERT( *ptmp == '*' );
+            ptmp++;
+            unsigned char stream_state[Condor_Crypt_AESGCM::STREAM_STATE_SIZE];
+            for(size_t i = 0; i < sizeof(stream_state); i++) {
+                citems = sscanf(ptmp, "%2X", &hex);
+                ASSERT( citems == 1 );
+                stream_state[i] = (unsigned char)hex;
+                ptmp += 2;
+            }
+            bool imported = Condor_Crypt_AESGCM::importStreamState(crypto_state_, stream_state);
+            ASSERT( imported );
+        }
+#endif
 		ASSERT( *ptmp == '*' );
         // Now, skip over this one
         ptmp++;
@@ -2879,6 +2915,28 @@ Sock::unwrap(const unsigned char* d_in,int l_in,
     return coded;
 }
 
+bool
+Sock::set_compression(bool enable)
+{
+		// Only stream sockets know how to compress; turning it off
+		// is always possible.
+	if (enable) {
+		dprintf(D_NETWORK, "Compression is not supported on this socket.\n");
+		return false;
+	}
+	return true;
+}
+
+bool
+Sock::crypto_is_aead() const
+{
+#ifdef HAVE_EXT_OPENSSL
+	return crypto_state_ && crypto_state_->m_keyInfo.getProtocol() == CONDOR_AESGCM;
+#else
+	return false;
+#endif
+}
+
 void Sock::resetCrypto()
 {
 #ifdef HAVE_EXT_OPENSSL
@@ -2910,6 +2968,19 @@ Sock::initialize_crypto(KeyInfo * key)
 			setCryptoMethodUsed("3DES");
             crypto_ = new Condor_Crypt_3des();
             break;
+        case CONDOR_AESGCM:
+			if (type() == Stream::reli_sock) {
+				setCryptoMethodUsed("AES");
+				crypto_ = new Condor_Crypt_AESGCM();
+			} else {
+					// Sessions are shared with UDP, where a datagram
+					// may be lost, so AES-GCM's message sequence does
+					// not fit.  Both ends use the same key with
+					// Blowfish instead.
+				setCryptoMethodUsed("BLOWFISH");
+				crypto_ = new Condor_Crypt_Blowfish();
+			}
+            break;
 #endif
         default:
             break;
@@ -2918,7 +2989,15 @@ Sock::initialize_crypto(KeyInfo * key)
 
     // if we made an object, make a state object as well
     if(crypto_) {
-        crypto_state_ = new Condor_Crypto_State(key->getProtocol(), *key);
+		Protocol proto = key->getProtocol();
+		if (proto == CONDOR_AESGCM && type() != Stream::reli_sock) {
+			proto = CONDOR_BLOWFISH;
+		}
+		KeyInfo state_key(key->getKeyData(), key->getKeyLength(), proto, key->getDuration());
+			// AES-GCM keys each direction separately, so it needs to
+			// know which end of the connection this is
+		bool is_client = type() == Stream::reli_sock && static_cast<ReliSock*>(this)->isClient();
+        crypto_state_ = new Condor_Crypto_State(proto, state_key, is_client);
     }
 
     return (crypto_ != 0);
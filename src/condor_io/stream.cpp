@@ -51,6 +51,7 @@ Stream :: Stream() :
 		// back, very consistent, isn't it?	
 	encrypt_(false),
     crypto_mode_(false),
+	compress_mode_(false),
 	m_crypto_state_before_secret(false),
     _coding(stream_encode),
 	allow_empty_message_flag(FALSE),
@@ -792,7 +793,7 @@ Stream::put( char const *s)
 	}
 
 	len = (int)strlen(s)+1;
-	if (get_encryption()) {
+	if (get_encryption() || get_compression()) {
 		if (put(len) == FALSE) {
 			return FALSE;
 		}
@@ -814,7 +815,7 @@ Stream::put_nullstr( char const *s)
 	int		len;
 
 	if (!s){
-		if (get_encryption()) {
+		if (get_encryption() || get_compression()) {
 			len = 1;
 			if (put(len) == FALSE) {
 				return FALSE;
@@ -824,7 +825,7 @@ Stream::put_nullstr( char const *s)
 	}
 	else{
 		len = (int)strlen(s)+1;
-		if (get_encryption()) {
+		if (get_encryption() || get_compression()) {
 			if (put(len) == FALSE) {
 				return FALSE;
 			}
@@ -878,7 +879,7 @@ Stream::put( char const *s, int		l)
 		l = 1;
 	}
 
-	if (get_encryption()) {
+	if (get_encryption() || get_compression()) {
 		if (put(l) == FALSE) {
 			return FALSE;
 		}
@@ -1273,7 +1274,7 @@ Stream::get_string_ptr( char const *&s ) {
 
 	s = NULL;
 		// For 6.2 compatibility, we had to put this code back 
-	if (!get_encryption()) {
+	if (!get_encryption() && !get_compression()) {
 		if (!peek(c)) return FALSE;
 		if (c == '\255'){
 			if (get_bytes(&c, 1) != 1) return FALSE;
@@ -1284,7 +1285,7 @@ Stream::get_string_ptr( char const *&s ) {
 			s = (char *)tmp_ptr;
 		}
 	}
-	else { // 6.3 with encryption support
+	else { // 6.3 with encryption support, also used when compressing
 			// First, get length
 		if (get(len) == FALSE) {
 			return FALSE;
@@ -1333,7 +1334,7 @@ Stream::get_string_ptr( char const *&s, int &length ) {
 
 	s = NULL;
 		// For 6.2 compatibility, we had to put this code back
-	if (!get_encryption()) {
+	if (!get_encryption() && !get_compression()) {
 		if (!peek(c)) return FALSE;
 		if (c == '\255'){
 			if (get_bytes(&c, 1) != 1) return FALSE;
@@ -1346,7 +1347,7 @@ Stream::get_string_ptr( char const *&s, int &length ) {
 			s = (char *)tmp_ptr;
 		}
 	}
-	else { // 6.3 with encryption support
+	else { // 6.3 with encryption support, also used when compressing
 			// First, get length
 		if (get(len) == FALSE) {
 			return FALSE;
@@ -726,6 +726,11 @@ reinitialize ()
 
 	if (NegotiatorPreJobRank) delete NegotiatorPreJobRank;
 	NegotiatorPreJobRank = NULL;
+		// The default NEGOTIATOR_PRE_JOB_RANK substitutes
+		// NEGOTIATOR_PSLOT_BEST_FIT into a ClassAd expression, where a
+		// config boolean like "yes" would be an attribute reference.
+	config_insert("NEGOTIATOR_PSLOT_BEST_FIT",
+		param_boolean("NEGOTIATOR_PSLOT_BEST_FIT", false) ? "true" : "false");
 	tmp = param("NEGOTIATOR_PRE_JOB_RANK");
 	if( tmp ) {
 		if( ParseClassAdRvalExpr(tmp, NegotiatorPreJobRank) ) {
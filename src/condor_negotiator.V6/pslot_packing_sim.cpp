@@ -0,0 +1,394 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Replays a job trace against an inventory of partitionable slots, once
+// with NEGOTIATOR_PSLOT_BEST_FIT off and once with it on, and reports
+// the utilization and number of drains for each.
+//
+// usage: pslot_packing_sim [slots-file [jobs-file]]
+//
+// slots-file has one "<count> <cpus> <memory>" line per kind of machine,
+// each machine having a single partitionable slot (default 40 machines
+// with 64 cpus and 60 with 16).  jobs-file has one "<submit time>
+// <runtime> <cpus> <memory>" line per job, times in seconds (default a
+// synthetic mix of mostly single core jobs with some whole machine jobs).
+// Blank lines and lines starting with # are ignored.
+//
+// Every NEGOTIATOR_INTERVAL, idle jobs are matched in submit order to
+// the slot the NEGOTIATOR_PRE_JOB_RANK from the configuration ranks
+// highest, ties going to the first slot in the inventory.  A job that
+// matches no slot but would fit on an empty machine counts as blocked;
+// once the oldest blocked job has waited DEFRAG_INTERVAL, the machine
+// big enough for it with the least running work is drained, as
+// condor_defrag would, unless one is draining for it already.  Draining
+// machines take no new jobs until they are empty.
+
+#include "condor_common.h"
+
+#include "condor_config.h"
+#include "condor_attributes.h"
+#include "condor_classad.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct Machine {
+	int total_cpus;
+	int total_memory;
+	int cpus;
+	int memory;
+	bool draining;
+	ClassAd ad;
+};
+
+struct Job {
+	long submit;
+	long runtime;
+	int cpus;
+	int memory;
+	long start;
+	int machine;
+};
+
+static bool
+read_lines( const char *file, int fields, std::vector<std::vector<long> > &lines )
+{
+	FILE *fp = fopen( file, "r" );
+	if( !fp ) {
+		fprintf( stderr, "cannot open %s: %s\n", file, strerror( errno ) );
+		return false;
+	}
+	char buf[1024];
+	int lineno = 0;
+	while( fgets( buf, sizeof(buf), fp ) ) {
+		lineno++;
+		char *p = buf;
+		while( isspace( *p ) ) {
+			p++;
+		}
+		if( !*p || *p == '#' ) {
+			continue;
+		}
+		std::vector<long> values;
+		char *end;
+		for( long value = strtol( p, &end, 10 ); end != p; value = strtol( p, &end, 10 ) ) {
+			values.push_back( value );
+			p = end;
+		}
+		if( (int)values.size() != fields ) {
+			fprintf( stderr, "%s:%d: expected %d numbers\n", file, lineno, fields );
+			fclose( fp );
+			return false;
+		}
+		lines.push_back( values );
+	}
+	fclose( fp );
+	return true;
+}
+
+static void
+add_machines( std::vector<Machine> &machines, int count, int cpus, int memory )
+{
+	for( int i = 0; i < count; i++ ) {
+		Machine m;
+		m.total_cpus = m.cpus = cpus;
+		m.total_memory = m.memory = memory;
+		m.draining = false;
+
+			// just what NEGOTIATOR_PRE_JOB_RANK looks at, published the
+			// way the startd publishes a partitionable slot
+		std::string name;
+		formatstr( name, "slot1@machine%04d", (int)machines.size() );
+		m.ad.Assign( ATTR_NAME, name );
+		m.ad.Assign( ATTR_RANK, 0.0 );
+		m.ad.Assign( ATTR_SLOT_PARTITIONABLE, true );
+		m.ad.Assign( ATTR_TOTAL_SLOT_CPUS, cpus );
+		m.ad.Assign( ATTR_TOTAL_SLOT_MEMORY, memory );
+		m.ad.Assign( ATTR_CPUS, cpus );
+		m.ad.Assign( ATTR_MEMORY, memory );
+		m.ad.AssignExpr( ATTR_FRAGMENTATION_SCORE,
+			"1.0 - (Cpus / TotalSlotCpus + Memory / TotalSlotMemory) / 2" );
+		machines.push_back( m );
+	}
+}
+
+	// a day of jobs: mostly single core, some 8 core, and now and then
+	// one that needs a whole 64 core machine; one every 6 seconds keeps
+	// the default pool busy enough that whole machine jobs need drains
+static void
+make_jobs( std::vector<Job> &jobs )
+{
+	unsigned int seed = 12345;
+	auto next_random = [&seed]( int n ) {
+		seed = seed * 1103515245 + 12345;
+		return (int)((seed >> 8) % n);
+	};
+	for( long t = 0; t < 86400; t += 6 ) {
+		Job job;
+		job.submit = t;
+		job.start = -1;
+		job.machine = -1;
+		int kind = next_random( 100 );
+		if( kind < 2 ) {
+			job.cpus = 64;
+			job.memory = 200000;
+			job.runtime = 7200;
+		} else if( kind < 12 ) {
+			job.cpus = 8;
+			job.memory = 16000;
+			job.runtime = 1800 + next_random( 7200 );
+		} else {
+			job.cpus = 1;
+			job.memory = 2000;
+			job.runtime = 600 + next_random( 14400 );
+		}
+		jobs.push_back( job );
+	}
+}
+
+static void
+set_free( Machine &m, int cpus, int memory )
+{
+	m.cpus = cpus;
+	m.memory = memory;
+	m.ad.Assign( ATTR_CPUS, cpus );
+	m.ad.Assign( ATTR_MEMORY, memory );
+}
+
+static void
+simulate( const char *mode, std::vector<Machine> machines, std::vector<Job> jobs )
+{
+	config_insert( "NEGOTIATOR_PSLOT_BEST_FIT", mode );
+	std::string rank_str;
+	param( rank_str, "NEGOTIATOR_PRE_JOB_RANK" );
+	classad::ExprTree *rank = NULL;
+	if( ParseClassAdRvalExpr( rank_str.c_str(), rank ) ) {
+		fprintf( stderr, "cannot parse NEGOTIATOR_PRE_JOB_RANK: %s\n", rank_str.c_str() );
+		return;
+	}
+	int interval = param_integer( "NEGOTIATOR_INTERVAL", 60 );
+	int drain_delay = param_integer( "DEFRAG_INTERVAL", 600 );
+
+	long total_cpus = 0;
+	for( auto &m : machines ) {
+		total_cpus += m.total_cpus;
+	}
+
+	std::vector<int> running;
+	size_t next_submit = 0, finished = 0;
+	int drains = 0, matches = 0, never_fit = 0;
+	double busy_cpu_secs = 0, drain_idle_cpu_secs = 0, small_wait = 0, big_wait = 0;
+	int small_jobs = 0, big_jobs = 0;
+	long now = 0;
+	ClassAd job_ad;
+
+	for( auto &job : jobs ) {
+		bool fits = false;
+		for( auto &m : machines ) {
+			fits = fits || (job.cpus <= m.total_cpus && job.memory <= m.total_memory);
+		}
+		if( !fits ) {
+			never_fit++;
+			job.start = 0;
+			finished++;
+		}
+	}
+
+	while( finished < jobs.size() ) {
+		for( size_t i = 0; i < running.size(); ) {
+			Job &job = jobs[running[i]];
+			if( job.start + job.runtime > now ) {
+				i++;
+				continue;
+			}
+			Machine &m = machines[job.machine];
+			set_free( m, m.cpus + job.cpus, m.memory + job.memory );
+			running[i] = running.back();
+			running.pop_back();
+			finished++;
+		}
+		for( auto &m : machines ) {
+			if( m.draining && m.cpus == m.total_cpus ) {
+				m.draining = false;
+			}
+		}
+		while( next_submit < jobs.size() && jobs[next_submit].submit <= now ) {
+			next_submit++;
+		}
+
+		int oldest_blocked = -1;
+		for( size_t j = 0; j < next_submit; j++ ) {
+			Job &job = jobs[j];
+			if( job.start >= 0 ) {
+				continue;
+			}
+			job_ad.Assign( ATTR_REQUEST_CPUS, job.cpus );
+			job_ad.Assign( ATTR_REQUEST_MEMORY, job.memory );
+			int best = -1;
+			double best_rank = 0;
+			for( size_t i = 0; i < machines.size(); i++ ) {
+				Machine &m = machines[i];
+				if( m.draining || m.cpus < job.cpus || m.memory < job.memory ) {
+					continue;
+				}
+				classad::Value result;
+				double value;
+				if( !EvalExprTree( rank, &m.ad, &job_ad, result ) || !result.IsNumber( value ) ) {
+					value = -(FLT_MAX);
+				}
+				if( best < 0 || value > best_rank ) {
+					best = (int)i;
+					best_rank = value;
+				}
+			}
+			if( best < 0 ) {
+				if( oldest_blocked < 0 ) {
+					oldest_blocked = (int)j;
+				}
+				continue;
+			}
+			Machine &m = machines[best];
+			set_free( m, m.cpus - job.cpus, m.memory - job.memory );
+			job.start = now;
+			job.machine = best;
+			running.push_back( (int)j );
+			matches++;
+			if( job.cpus > 1 ) {
+				big_wait += now - job.submit;
+				big_jobs++;
+			} else {
+				small_wait += now - job.submit;
+				small_jobs++;
+			}
+		}
+
+		if( oldest_blocked >= 0 && now - jobs[oldest_blocked].submit >= drain_delay ) {
+			Job &job = jobs[oldest_blocked];
+			int victim = -1;
+			long victim_work = 0;
+			bool already_draining = false;
+			for( size_t i = 0; i < machines.size(); i++ ) {
+				Machine &m = machines[i];
+				if( job.cpus > m.total_cpus || job.memory > m.total_memory ) {
+					continue;
+				}
+				if( m.draining ) {
+					already_draining = true;
+					break;
+				}
+				long work = 0;
+				for( int r : running ) {
+					if( jobs[r].machine == (int)i ) {
+						work += jobs[r].cpus * (jobs[r].start + jobs[r].runtime - now);
+					}
+				}
+				if( victim < 0 || work < victim_work ) {
+					victim = (int)i;
+					victim_work = work;
+				}
+			}
+			if( !already_draining && victim >= 0 ) {
+				machines[victim].draining = true;
+				drains++;
+			}
+		}
+
+		for( auto &m : machines ) {
+			busy_cpu_secs += (double)(m.total_cpus - m.cpus) * interval;
+			if( m.draining ) {
+				drain_idle_cpu_secs += (double)m.cpus * interval;
+			}
+		}
+		now += interval;
+	}
+
+	delete rank;
+
+	printf( "NEGOTIATOR_PSLOT_BEST_FIT = %s\n", mode );
+	printf( "  %d jobs matched in %.1f hours", matches, now / 3600.0 );
+	if( never_fit ) {
+		printf( " (%d fit no machine)", never_fit );
+	}
+	printf( "\n" );
+	printf( "  utilization %5.1f%%, %5.1f%% of cpus idle while draining\n",
+			100.0 * busy_cpu_secs / ((double)total_cpus * now),
+			100.0 * drain_idle_cpu_secs / ((double)total_cpus * now) );
+	printf( "  %d drains\n", drains );
+	printf( "  mean wait %.0f s for single core jobs, %.0f s for multi core jobs\n",
+			small_jobs ? small_wait / small_jobs : 0.0,
+			big_jobs ? big_wait / big_jobs : 0.0 );
+}
+
+int main( int argc, char *argv[] )
+{
+	if( argc > 3 || (argc > 1 && argv[1][0] == '-') ) {
+		fprintf( stderr, "usage: %s [slots-file [jobs-file]]\n", argv[0] );
+		return 1;
+	}
+
+	config();
+
+	std::vector<Machine> machines;
+	if( argc > 1 ) {
+		std::vector<std::vector<long> > lines;
+		if( !read_lines( argv[1], 3, lines ) ) {
+			return 1;
+		}
+		for( auto &line : lines ) {
+			add_machines( machines, line[0], line[1], line[2] );
+		}
+	} else {
+		add_machines( machines, 40, 64, 256000 );
+		add_machines( machines, 60, 16, 64000 );
+	}
+
+	std::vector<Job> jobs;
+	if( argc > 2 ) {
+		std::vector<std::vector<long> > lines;
+		if( !read_lines( argv[2], 4, lines ) ) {
+			return 1;
+		}
+		for( auto &line : lines ) {
+			Job job;
+			job.submit = line[0];
+			job.runtime = line[1];
+			job.cpus = line[2];
+			job.memory = line[3];
+			job.start = -1;
+			job.machine = -1;
+			jobs.push_back( job );
+		}
+			// the negotiator goes through idle jobs in submit order
+		std::stable_sort( jobs.begin(), jobs.end(),
+			[]( const Job &a, const Job &b ) { return a.submit < b.submit; } );
+	} else {
+		make_jobs( jobs );
+	}
+
+	if( machines.empty() || jobs.empty() ) {
+		fprintf( stderr, "no machines or no jobs\n" );
+		return 1;
+	}
+
+	printf( "%d machines, %d jobs\n", (int)machines.size(), (int)jobs.size() );
+	simulate( "false", machines, jobs );
+	simulate( "true", machines, jobs );
+	return 0;
+}
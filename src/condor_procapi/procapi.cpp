@@ -70,6 +70,12 @@ int ProcAPI::pagesize		= 0;
 #ifdef LINUX
 long unsigned ProcAPI::boottime	= 0;
 long ProcAPI::boottime_expiration = 0;
+std::string ProcAPI::procDir = "/proc";
+int ProcAPI::procDirFd = -1;
+pid_t ProcAPI::procDirPid = 0;
+std::vector<char> ProcAPI::envBuffer;
+std::vector<char *> ProcAPI::envPointers;
+std::vector<procInfoRaw> ProcAPI::rawList;
 #endif // LINUX
 #else // WIN32
 
@@ -167,6 +173,12 @@ ProcAPI::getProcInfo( pid_t pid, piPTR& pi, int &status )
 		return PROCAPI_FAILURE;
 	}
 
+	return getProcInfoFromRaw( procRaw, pi, status );
+}
+
+int
+ProcAPI::getProcInfoFromRaw( const procInfoRaw &procRaw, piPTR pi, int &status )
+{
 		/* clean up and convert the raw data */
 
 		// if the page size has not yet been found, get it.
@@ -415,30 +427,152 @@ size_t ProcAPI::getBasicUsage(pid_t pid, double * puser_time, double * psys_time
    sample_time	: seconds since epoch
    proc_flags	: special process flags
 */
+int
+ProcAPI::getProcDirFd()
+{
+		// a forked child shares the descriptor's directory offset
+		// with its parent, so it gets its own
+	if( procDirFd != -1 && procDirPid != getpid() ) {
+		close( procDirFd );
+		procDirFd = -1;
+	}
+	if( procDirFd == -1 ) {
+		procDirFd = open( procDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+		if( procDirFd == -1 ) {
+			dprintf( D_ALWAYS, "ProcAPI: failed to open %s: errno %d (%s)\n",
+					 procDir.c_str(), errno, strerror(errno) );
+		}
+		procDirPid = getpid();
+	}
+	return procDirFd;
+}
+
+bool
+ProcAPI::setProcDir( const char *path )
+{
+	int fd = open( path, O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+	if( fd == -1 ) {
+		dprintf( D_ALWAYS, "ProcAPI: failed to open %s: errno %d (%s)\n",
+				 path, errno, strerror(errno) );
+		return false;
+	}
+	if( procDirFd != -1 ) {
+		close( procDirFd );
+	}
+	procDirFd = fd;
+	procDirPid = getpid();
+	procDir = path;
+	return true;
+}
+
+	// parse one space separated decimal field of /proc/<pid>/stat,
+	// advancing p past it
+static bool
+parse_stat_field( const char *&p, const char *end, long long &value )
+{
+	while( p < end && *p == ' ' ) {
+		p++;
+	}
+	bool negative = false;
+	if( p < end && *p == '-' ) {
+		negative = true;
+		p++;
+	}
+	if( p >= end || *p < '0' || *p > '9' ) {
+		return false;
+	}
+	unsigned long long v = 0;
+	while( p < end && *p >= '0' && *p <= '9' ) {
+		v = v * 10 + (*p - '0');
+		p++;
+	}
+	value = negative ? -(long long)v : (long long)v;
+	return true;
+}
+
+	// fill procRaw from the contents of /proc/<pid>/stat, which look like
+	// pid (ProcessName) State number number number number...
+	// The process name can contain spaces and parentheses, so the fields
+	// after it are counted from the last ')'.
+static bool
+parse_stat_line( const char *line, size_t len, procInfoRaw &procRaw )
+{
+	const char *end = line + len;
+	const char *p = line;
+	long long field;
+
+	if( !parse_stat_field( p, end, field ) ) {
+		return false;
+	}
+	procRaw.pid = (pid_t)field;
+
+	const char *rparen = (const char *)memrchr( line, ')', len );
+	if( rparen == NULL ) {
+		return false;
+	}
+	p = rparen + 1;
+
+		// skip the state
+	while( p < end && *p == ' ' ) {
+		p++;
+	}
+	if( p >= end ) {
+		return false;
+	}
+	p++;
+
+		// we need fields 4 (ppid) through 24 (rss)
+	long long fields[25];
+	for( int n = 4; n <= 24; n++ ) {
+		if( !parse_stat_field( p, end, fields[n] ) ) {
+			return false;
+		}
+	}
+
+	procRaw.ppid = (pid_t)fields[4];
+	procRaw.proc_flags = (unsigned long)fields[9];
+	procRaw.minfault = (long)fields[10];
+	procRaw.majfault = (long)fields[12];
+	procRaw.user_time_1 = (long)fields[14];
+	procRaw.sys_time_1 = (long)fields[15];
+	procRaw.creation_time = (birthday_t)fields[22];
+		// covert the image size from bytes to k
+	procRaw.imgsize = (unsigned long)((unsigned long long)fields[23] / 1024);
+	procRaw.rssize = (unsigned long)fields[24];
+	return true;
+}
+
 int
 ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status ) 
 {
 
 // This is the Linux version of getProcInfoRaw.  Everything is easier and
 // actually seems to work in Linux...nice, but annoyingly different.
+//
+// It is called for every process on the system at every scan, so it
+// opens the stat file relative to our held /proc descriptor, reads it
+// into a buffer on the stack and parses it by hand, without any heap
+// allocation.
 
 	char path[64];
-	FILE *fp;
-	
+	char line[1024];
+	int fd = -1;
 	int number_of_attempts;
-	long i;
-	unsigned long u;
-	unsigned long long imgsize_bytes;
-	char c;
-	char s[256];
 	int num_attempts = 5;
 
 		// assume success
 	status = PROCAPI_OK;
 
+	int dirfd = getProcDirFd();
+	if( dirfd == -1 ) {
+		initProcInfoRaw(procRaw);
+		status = PROCAPI_UNSPECIFIED;
+		return PROCAPI_FAILURE;
+	}
+
 	// read the entry a certain number of times since it appears that linux
 	// often simply does something stupid while reading.
-	sprintf( path, "/proc/%d/stat", pid );
+	snprintf( path, sizeof(path), "%d/stat", pid );
 	number_of_attempts = 0;
 	while (number_of_attempts < num_attempts) {
 
@@ -451,7 +585,11 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 		// set the sample time
 		procRaw.sample_time = secsSinceEpoch();
 
-		if( (fp = safe_fopen_wrapper_follow(path, "r")) == NULL ) {
+		if( fd != -1 ) {
+			close( fd );
+		}
+		fd = openat( dirfd, path, O_RDONLY | O_CLOEXEC );
+		if( fd == -1 ) {
 			if( errno == ENOENT ) {
 				// /proc/pid doesn't exist
 				status = PROCAPI_NOPID;
@@ -460,13 +598,13 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 			} else if ( errno == EACCES ) {
 				status = PROCAPI_PERM;
 				dprintf( D_FULLDEBUG, 
-					"ProcAPI::getProcInfo() No permission to open %s.\n", 
-					 path );
+					"ProcAPI::getProcInfo() No permission to open %s/%s.\n", 
+					 procDir.c_str(), path );
 			} else { 
 				status = PROCAPI_UNSPECIFIED;
 				dprintf( D_ALWAYS, 
-					"ProcAPI::getProcInfo() Error opening %s, errno: %d.\n", 
-					 path, errno );
+					"ProcAPI::getProcInfo() Error opening %s/%s, errno: %d.\n", 
+					 procDir.c_str(), path, errno );
 			}
 			
 			// if status is NOPID or PERM, just break out of the
@@ -478,70 +616,30 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 			}
 		}
 
-	        // format of /proc/self/stat is
-	        // pid (ProcessName) State number number number number...
-	        // The process name can have spaces in it, so read the
-	        // whole line in with fgets, whack the spaces, then 
-	        // parse again with sprintf
-	        char line[512];
-		if (fgets(line, 512, fp) == NULL) {
-			// couldn't read the right number of entries.
+			// the kernel generates the whole file on the first read
+		ssize_t len = read( fd, line, sizeof(line) - 1 );
+		if( len <= 0 ) {
 			status = PROCAPI_UNSPECIFIED;
 			dprintf( D_ALWAYS, 
-				"ProcAPI: Read error on %s: errno (%d): %s\n", 
-				 path, errno,  strerror(errno));
-
-			// don't leak for the next attempt;
-			fclose( fp );
-			fp = NULL;
+				"ProcAPI: Read error on %s/%s: errno (%d): %s\n", 
+				 procDir.c_str(), path, errno, strerror(errno) );
 
 			// try again
 			continue;
 		}
+		line[len] = '\0';
 
-		char *rparen = strrchr(line, ')');
-		char *lparen = strchr(line, '(');
-		if (lparen && rparen && lparen < rparen) {
-			while (lparen != rparen) {
-				if (*lparen == ' ') {
-					*lparen = '_';
-				}
-				lparen++;
-			}
-		}
-
-			// fill the raw structure from the proc file
-			// ensure I read the right number of arguments....
-		if ( sscanf( line, "%d %s %c %d "
-			"%ld %ld %ld %ld "
-			"%lu %lu %lu %lu %lu "
-			"%ld %ld %ld %ld %ld %ld "
-			"%lu %lu %llu %llu %lu %lu %lu %lu %lu %lu %lu "
-			"%ld %ld %ld %ld %lu",
-			&procRaw.pid, s, &c, &procRaw.ppid, 
-			&i, &i, &i, &i, 
-			&procRaw.proc_flags, &procRaw.minfault, &u, &procRaw.majfault, &u, 
-			&procRaw.user_time_1, &procRaw.sys_time_1, &i, &i, &i, &i, 
-			&u, &u, &procRaw.creation_time, &imgsize_bytes, &procRaw.rssize, &u, &u, &u, 
-			&u, &u, &u, &i, &i, &i, &i, &u ) != 35 )
-		{
+		if( !parse_stat_line( line, len, procRaw ) ) {
 			// couldn't read the right number of entries.
 			status = PROCAPI_UNSPECIFIED;
 			dprintf( D_ALWAYS, 
-				"ProcAPI: Unexpected short scan on %s, (%s) errno: %d.\n", 
-				 path, line, errno );
-
-			// don't leak for the next attempt;
-			fclose( fp );
-			fp = NULL;
+				"ProcAPI: Unexpected short scan on %s/%s, (%s)\n", 
+				 procDir.c_str(), path, line );
 
 			// try again
 			continue;
 		}
 
-		// covert imgsize_bytes to k
-		procRaw.imgsize = imgsize_bytes/1024;
-
 		// do a small verification of the read in data...
 		if ( pid == procRaw.pid ) {
 			// end the loop, data looks ok.
@@ -564,23 +662,22 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 		// I got this far and only found garbage data
 		if ( status == PROCAPI_GARBLED ) {
 			dprintf( D_ALWAYS, 
-				"ProcAPI: After %d attempts at reading %s, found only "
-				"garbage! Aborting read.\n", num_attempts, path);
+				"ProcAPI: After %d attempts at reading %s/%s, found only "
+				"garbage! Aborting read.\n", num_attempts, procDir.c_str(), path);
 		}
 
-		if (fp != NULL) {
-			fclose( fp );
-			fp = NULL;
+		if( fd != -1 ) {
+			close( fd );
 		}
 
 		return PROCAPI_FAILURE;
 	}
 
 	// grab the process owner uid
-	procRaw.owner = getFileOwner(fileno(fp));
+	procRaw.owner = getFileOwner(fd);
 
 		// close the file
-	fclose( fp );
+	close( fd );
 
 		// only one value for times
 	procRaw.user_time_2 = 0;
@@ -589,122 +686,101 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 	return PROCAPI_SUCCESS;
 }
 
+int
+ProcAPI::getProcInfoRawList( std::vector<procInfoRaw> &list )
+{
+	list.clear();
+
+	if( buildPidList() != PROCAPI_SUCCESS ) {
+		dprintf( D_ALWAYS, "ProcAPI: error retrieving list of processes\n" );
+		return PROCAPI_FAILURE;
+	}
+
+	procInfoRaw procRaw;
+	int status;
+	for( pid_t thispid : pidList ) {
+		if( getProcInfoRaw( thispid, procRaw, status ) == PROCAPI_SUCCESS ) {
+			list.push_back( procRaw );
+		}
+	}
+
+	return PROCAPI_SUCCESS;
+}
+
 int 
 ProcAPI::fillProcInfoEnv(piPTR pi)
 {
 	char path[64];
-	int read_size = (1024 * 1024);
-	int bytes_read;
-	int bytes_read_so_far = 0;
+	size_t read_size = 64 * 1024;
+	size_t bytes_read_so_far = 0;
 	int fd;
-	char *env_buffer = NULL;
-	int multiplier = 2;
 
 		// open the environment proc file
-	sprintf( path, "/proc/%d/environ", pi->pid );
-	fd = safe_open_wrapper_follow(path, O_RDONLY);
+	int dirfd = getProcDirFd();
+	if ( dirfd == -1 ) {
+		return PROCAPI_SUCCESS;
+	}
+	snprintf( path, sizeof(path), "%d/environ", pi->pid );
+	fd = openat( dirfd, path, O_RDONLY | O_CLOEXEC );
 
 	// Unlike other things set up into the pi structure, this is optional
 	// since it can only help us if it is here...
-	if ( fd != -1 ) {
-		
-		// read the file in read_size chunks resizing the memory buffer
-		// until I've read everything. I just can't read into a static
-		// buffer since the user supplies the environment and I don't want
-		// to produce a buffer overrun. However, you can't stat() this file
-		// to see how big it is so I just have to keep reading until I stop.
-		do {
-			if (env_buffer == NULL) {
-				env_buffer = (char*)malloc(sizeof(char) * read_size);
-				if ( env_buffer == NULL ) {
-					EXCEPT( "Procapi::getProcInfo: Out of memory!");
-				}
-			} else {
-				env_buffer = (char*)realloc(env_buffer, read_size * multiplier);
-				if ( env_buffer == NULL ) {
-					EXCEPT( "Procapi::getProcInfo: Out of memory!");
-				}
-				multiplier++;
-			}
-
-			bytes_read = full_read(fd, env_buffer+bytes_read_so_far, read_size);
-			// We have seen cases where read() returns a value in the 1GB
-			// range. Retrying after a lseek() and/or reopening the file
-			// gave the same result. So just give up in that case.
-			if ( bytes_read < 0 || bytes_read > read_size ) {
-				close( fd );
-				free( env_buffer );
-				return PROCAPI_SUCCESS;
-			}
-
-			bytes_read_so_far += bytes_read;
-
-			// if I read right up to the end of the buffer size, assume more...
-			// in the case of no more data, but this is true, then the buffer
-			// will grow again, but no more will be read.
-		} while (bytes_read == read_size);
-
-		close(fd);
-
-		// now convert the format, which are NUL delimited strings to the 
-		// usual format of an environ.
+	if ( fd == -1 ) {
+		return PROCAPI_SUCCESS;
+	}
 
-		// count the entries
-		int entries = 0;
-		int index = 0;
-		while(index < bytes_read_so_far) {
-			if (env_buffer[index] == '\0') {
-				entries++;
-			}
-			index++;
+	// read the file into our buffer, growing it until I've read
+	// everything. you can't stat() this file to see how big it is so
+	// I just have to keep reading until I stop. the buffer is kept
+	// between calls, so this normally doesn't allocate at all.
+	if ( envBuffer.size() < read_size ) {
+		envBuffer.resize( read_size );
+	}
+	while ( true ) {
+		if ( envBuffer.size() - bytes_read_so_far < read_size ) {
+			envBuffer.resize( envBuffer.size() * 2 );
 		}
-
-		// allocate a buffer to hold pointers to the strings in env_buffer so 
-		// it mimics and environ variable. The addition +1 is for the end NULL;
-		char **env_environ;
-		env_environ = (char**)malloc(sizeof(char *) * (entries + 1));
-		if (env_environ == NULL) {
-			EXCEPT( "Procapi::getProcInfo: Out of memory!");
+		size_t want = envBuffer.size() - bytes_read_so_far;
+		int bytes_read = full_read( fd, &envBuffer[bytes_read_so_far], want );
+		// We have seen cases where read() returns a value in the 1GB
+		// range. Retrying after a lseek() and/or reopening the file
+		// gave the same result. So just give up in that case.
+		if ( bytes_read < 0 || (size_t)bytes_read > want ) {
+			close( fd );
+			return PROCAPI_SUCCESS;
 		}
 
-		// set up the pointers from the env_environ into the env_buffer
-		index = 0;
-		long i;
-		for (i = 0; i < entries; i++) {
-			env_environ[i] = &env_buffer[index];
+		bytes_read_so_far += bytes_read;
 
-			// find the start of the next entry
-			while (index < bytes_read_so_far && env_buffer[index] != '\0') {
-				index++;
-			}
-
-			// move over the \0 to the start of the next piece. At the end
-			// of the buffer, this will point to garabge memory, but the for 
-			// loop index will fire and this index won't be used.
-			index++;
-		}
-	
-		// the last entry must be NULL to simulate the environ variable.
-		env_environ[i] = NULL;
-
-		// if this pid happens to have any ancestor environment id variables,
-		// then filter them out and put it into the PidEnvID table for this
-		// proc. 
-		if (pidenvid_filter_and_insert(&pi->penvid, env_environ) 
-			== PIDENVID_OVERSIZED)
-		{
-			EXCEPT("ProcAPI::getProcInfo: Discovered too many ancestor id "
-					"environment variables in pid %u. Programmer Error.",
-					pi->pid);
+		// if I read right up to the end of the buffer size, assume more...
+		if ( (size_t)bytes_read < want ) {
+			break;
 		}
+	}
 
-		// don't leak memory of the environ buffer
-		free(env_buffer);
-		env_buffer = NULL;
+	close(fd);
 
-		// get rid of the container to simulate the environ convention
-		free(env_environ);
-		env_environ = NULL;
+	// now convert the format, which are NUL delimited strings to the 
+	// usual format of an environ, with a NULL at the end
+	envPointers.clear();
+	size_t start = 0;
+	for ( size_t index = 0; index < bytes_read_so_far; index++ ) {
+		if ( envBuffer[index] == '\0' ) {
+			envPointers.push_back( &envBuffer[start] );
+			start = index + 1;
+		}
+	}
+	envPointers.push_back( NULL );
+
+	// if this pid happens to have any ancestor environment id variables,
+	// then filter them out and put it into the PidEnvID table for this
+	// proc. 
+	if (pidenvid_filter_and_insert(&pi->penvid, &envPointers[0]) 
+		== PIDENVID_OVERSIZED)
+	{
+		EXCEPT("ProcAPI::getProcInfo: Discovered too many ancestor id "
+				"environment variables in pid %u. Programmer Error.",
+				pi->pid);
 	}
 
 	return PROCAPI_SUCCESS;
@@ -1905,7 +1981,57 @@ ProcAPI::initProcInfoRaw(procInfoRaw& procRaw){
    to by pidList, a private data member of ProcAPI.  
  */
 
-#if !defined(Darwin) && !defined(CONDOR_FREEBSD)
+#if defined(LINUX)
+int
+ProcAPI::buildPidList() {
+
+	pidList.clear();
+
+	int dirfd = getProcDirFd();
+	if( dirfd == -1 ) {
+		return PROCAPI_FAILURE;
+	}
+
+		// read the directory entries of our held /proc descriptor
+		// straight into a buffer, rather than going through opendir(),
+		// which allocates a new DIR at every scan
+	if( lseek( dirfd, 0, SEEK_SET ) == -1 ) {
+		dprintf(D_ALWAYS, "ProcAPI: lseek() on %s failed: errno %d (%s)\n",
+		        procDir.c_str(), errno, strerror(errno));
+		return PROCAPI_FAILURE;
+	}
+
+	alignas(struct dirent64) char buf[32768];
+	int total_entries = 0;
+	long len;
+	while( (len = syscall( SYS_getdents64, dirfd, buf, sizeof(buf) )) > 0 ) {
+		for( long offset = 0; offset < len; ) {
+			struct dirent64 *direntp = (struct dirent64 *)(buf + offset);
+			offset += direntp->d_reclen;
+			total_entries++;
+
+			const char *name = direntp->d_name;
+			if( *name < '0' || *name > '9' ) {
+				continue;
+			}
+			pid_t pid = 0;
+			for( ; *name >= '0' && *name <= '9'; name++ ) {
+				pid = pid * 10 + (*name - '0');
+			}
+			pidList.push_back( pid );
+		}
+	}
+	if( len < 0 ) {
+		dprintf(D_ALWAYS, "ProcAPI: getdents64() failed: errno %d (%s)\n",
+		        errno, strerror(errno));
+	}
+
+	dprintf(D_FULLDEBUG,"ProcAPI: read %d pid entries out of %d total entries in %s\n", (int)pidList.size(), total_entries, procDir.c_str());
+	return PROCAPI_SUCCESS;
+}
+#endif
+
+#if !defined(Darwin) && !defined(CONDOR_FREEBSD) && !defined(LINUX)
 int
 ProcAPI::buildPidList() {
 
@@ -2006,17 +2132,40 @@ ProcAPI::buildProcInfoList() {
 
 	deallocAllProcInfos();
 
-	if (buildPidList() != PROCAPI_SUCCESS) {
-		dprintf(D_ALWAYS, "ProcAPI: error retrieving list of processes\n");
-		return PROCAPI_FAILURE;
-	}
-
 		// make a header node for ease of list construction:
 	allProcInfos = new procInfo;
 	current = allProcInfos;
 	current->next = NULL;
 
 	temp = NULL;
+#if defined(LINUX)
+		// read all the processes' raw data in one pass, into storage
+		// that is kept between scans, before converting it
+	if (getProcInfoRawList(rawList) != PROCAPI_SUCCESS) {
+		delete allProcInfos;
+		allProcInfos = NULL;
+		return PROCAPI_FAILURE;
+	}
+	for( const procInfoRaw &procRaw : rawList ) {
+		initpi(temp);
+		if( getProcInfoFromRaw(procRaw, temp, status) == PROCAPI_SUCCESS) {
+			current->next = temp;
+			current = temp;
+			temp = NULL;
+		}
+	}
+	if (temp != NULL) {
+		delete temp;
+		temp = NULL;
+	}
+#else
+	if (buildPidList() != PROCAPI_SUCCESS) {
+		dprintf(D_ALWAYS, "ProcAPI: error retrieving list of processes\n");
+		delete allProcInfos;
+		allProcInfos = NULL;
+		return PROCAPI_FAILURE;
+	}
+
 	for( pid_t thispid : pidList ) {
 		if( getProcInfo(thispid, temp, status) == PROCAPI_SUCCESS) {
 			current->next = temp;
@@ -2028,6 +2177,7 @@ ProcAPI::buildProcInfoList() {
 			temp = NULL;
 		}
 	}
+#endif
 
 		// we're done; remove header node.
 	temp = allProcInfos;
@@ -533,6 +533,27 @@ class ProcAPI {
     */
   static size_t getBasicUsage(pid_t pid, double * puser_time, double * psys_time=NULL);
 
+#ifdef LINUX
+  /**
+    * Get the raw data of every process on the system into the given
+    * vector, reusing whatever storage it already has.  Unlike
+    * getProcInfoList(), this does no per-process allocation, and
+    * does not sample CPU usage or read the processes' environments.
+    *
+    * @param list The vector to fill; it is cleared first.
+    * @return PROCAPI_SUCCESS or PROCAPI_FAILURE
+    */
+  static int getProcInfoRawList(std::vector<procInfoRaw> &list);
+
+  /**
+    * Read process information from the given directory instead of
+    * /proc.  This is meant for benchmarks over a synthetic /proc tree.
+    *
+    * @return false if the directory can't be opened
+    */
+  static bool setProcDir(const char *path);
+#endif
+
  private:
 
   /** Default constructor.  It's private so that no one really
@@ -593,6 +614,10 @@ class ProcAPI {
 	  // updates the statically stored boottime variable if neccessary
 	  // something similar probably belongs in sys_api
   static int checkBootTime(long now);
+	  // returns our held descriptor for /proc, opening it if need be
+  static int getProcDirFd();
+	  // the second half of getProcInfo(): fills in pi from raw data
+  static int getProcInfoFromRaw(const procInfoRaw &procRaw, piPTR pi, int &status);
 #endif //LINUX
 
   // works with the hashtable; finds cpuusage, maj/min page faults.
@@ -690,6 +715,15 @@ private:
 		// change if the time is adjusted on this machine (by ntpd or afs,
 		// for example), so we recompute it when our value expires
 
+  static std::string procDir; // where to read process information from,
+		// normally /proc
+  static int procDirFd; // an open descriptor for procDir, which we
+		// hold so that each file can be opened relative to it
+  static pid_t procDirPid; // the process that opened procDirFd
+  static std::vector<char> envBuffer; // buffers reused by fillProcInfoEnv()
+  static std::vector<char *> envPointers; // so it doesn't allocate
+  static std::vector<procInfoRaw> rawList; // reused by buildProcInfoList()
+
 #endif // LINUX
 
 #endif // not defined WIN32
@@ -0,0 +1,230 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Benchmark for scanning /proc with ProcAPI.
+//
+// usage: procapi_bench [processes] [iterations]
+//
+// Builds a synthetic /proc tree with the given number of processes
+// (default 5000), each with a copy of our own stat file, then scans it
+// the given number of times (default 100) two ways: the way ProcAPI used
+// to (opendir, then fopen and sscanf each stat file into a newly
+// allocated node) and with ProcAPI::getProcInfoRawList().  Checks that
+// both find the same processes and prints the time per scan of each.
+
+#include "condor_common.h"
+
+#include "condor_config.h"
+#include "condor_debug.h"
+#include "procapi.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+static const int FIRST_PID = 100000;
+
+static bool
+build_tree( std::string const &dir, int processes )
+{
+	char line[1024];
+	int fd = open( "/proc/self/stat", O_RDONLY );
+	ssize_t len = fd == -1 ? -1 : read( fd, line, sizeof(line) - 1 );
+	if( fd != -1 ) {
+		close( fd );
+	}
+	if( len <= 0 ) {
+		fprintf( stderr, "failed to read /proc/self/stat\n" );
+		return false;
+	}
+	line[len] = '\0';
+	char const *rest = strchr( line, ' ' );
+
+	for( int i = 0; i < processes; i++ ) {
+		std::string pid_dir;
+		formatstr( pid_dir, "%s/%d", dir.c_str(), FIRST_PID + i );
+		if( mkdir( pid_dir.c_str(), 0700 ) != 0 ) {
+			fprintf( stderr, "mkdir(%s) failed: %s\n", pid_dir.c_str(), strerror( errno ) );
+			return false;
+		}
+		std::string stat;
+		formatstr( stat, "%d%s", FIRST_PID + i, rest );
+		FILE *fp = fopen( (pid_dir + "/stat").c_str(), "w" );
+		if( !fp || fputs( stat.c_str(), fp ) < 0 || fclose( fp ) != 0 ) {
+			fprintf( stderr, "failed to write %s/stat\n", pid_dir.c_str() );
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+remove_tree( std::string const &dir, int processes )
+{
+	for( int i = 0; i < processes; i++ ) {
+		std::string pid_dir;
+		formatstr( pid_dir, "%s/%d", dir.c_str(), FIRST_PID + i );
+		unlink( (pid_dir + "/stat").c_str() );
+		rmdir( pid_dir.c_str() );
+	}
+	rmdir( dir.c_str() );
+}
+
+	// the way ProcAPI used to read a single stat file
+static bool
+read_stat_stdio( char const *path, procInfoRaw &procRaw )
+{
+	FILE *fp = fopen( path, "r" );
+	if( !fp ) {
+		return false;
+	}
+	char line[512];
+	if( !fgets( line, sizeof(line), fp ) ) {
+		fclose( fp );
+		return false;
+	}
+	char *rparen = strrchr( line, ')' );
+	char *lparen = strchr( line, '(' );
+	if( lparen && rparen && lparen < rparen ) {
+		for( ; lparen != rparen; lparen++ ) {
+			if( *lparen == ' ' ) {
+				*lparen = '_';
+			}
+		}
+	}
+
+	long i;
+	unsigned long u;
+	unsigned long long imgsize_bytes;
+	char c;
+	char s[256];
+	int n = sscanf( line, "%d %s %c %d "
+		"%ld %ld %ld %ld "
+		"%lu %ld %lu %ld %lu "
+		"%ld %ld %ld %ld %ld %ld "
+		"%lu %lu %llu %llu %lu %lu %lu %lu %lu %lu %lu "
+		"%ld %ld %ld %ld %lu",
+		&procRaw.pid, s, &c, &procRaw.ppid,
+		&i, &i, &i, &i,
+		&procRaw.proc_flags, &procRaw.minfault, &u, &procRaw.majfault, &u,
+		&procRaw.user_time_1, &procRaw.sys_time_1, &i, &i, &i, &i,
+		&u, &u, &procRaw.creation_time, &imgsize_bytes, &procRaw.rssize, &u, &u, &u,
+		&u, &u, &u, &i, &i, &i, &i, &u );
+	procRaw.imgsize = imgsize_bytes / 1024;
+
+	struct stat si;
+	if( fstat( fileno( fp ), &si ) == 0 ) {
+		procRaw.owner = si.st_uid;
+	}
+	fclose( fp );
+	return n == 35;
+}
+
+	// the way ProcAPI used to scan the whole tree, allocating a node
+	// for each process
+static int
+scan_stdio( std::string const &dir, std::vector<procInfoRaw *> &nodes )
+{
+	DIR *dirp = opendir( dir.c_str() );
+	if( !dirp ) {
+		return 0;
+	}
+	struct dirent *direntp;
+	while( (direntp = readdir( dirp )) != NULL ) {
+		if( !isdigit( direntp->d_name[0] ) ) {
+			continue;
+		}
+		std::string path;
+		formatstr( path, "%s/%s/stat", dir.c_str(), direntp->d_name );
+		procInfoRaw *node = new procInfoRaw;
+		memset( node, 0, sizeof(*node) );
+		if( !read_stat_stdio( path.c_str(), *node ) ) {
+			delete node;
+			continue;
+		}
+		nodes.push_back( node );
+	}
+	closedir( dirp );
+
+	int count = (int)nodes.size();
+	for( procInfoRaw *node : nodes ) {
+		delete node;
+	}
+	nodes.clear();
+	return count;
+}
+
+int main( int argc, char *argv[] )
+{
+	int processes = argc > 1 ? atoi( argv[1] ) : 5000;
+	int iterations = argc > 2 ? atoi( argv[2] ) : 100;
+	if( processes <= 0 || iterations <= 0 ) {
+		fprintf( stderr, "usage: %s [processes] [iterations]\n", argv[0] );
+		return 1;
+	}
+
+	config();
+
+	char dir_template[] = "/tmp/procapi_bench.XXXXXX";
+	if( !mkdtemp( dir_template ) ) {
+		fprintf( stderr, "mkdtemp failed: %s\n", strerror( errno ) );
+		return 1;
+	}
+	std::string dir = dir_template;
+	if( !build_tree( dir, processes ) ) {
+		remove_tree( dir, processes );
+		return 1;
+	}
+
+	int stdio_count = 0;
+	std::vector<procInfoRaw *> nodes;
+	auto start = std::chrono::steady_clock::now();
+	for( int i = 0; i < iterations; i++ ) {
+		stdio_count = scan_stdio( dir, nodes );
+	}
+	std::chrono::duration<double> stdio_secs = std::chrono::steady_clock::now() - start;
+
+	if( !ProcAPI::setProcDir( dir.c_str() ) ) {
+		remove_tree( dir, processes );
+		return 1;
+	}
+	std::vector<procInfoRaw> list;
+	start = std::chrono::steady_clock::now();
+	for( int i = 0; i < iterations; i++ ) {
+		ProcAPI::getProcInfoRawList( list );
+	}
+	std::chrono::duration<double> raw_secs = std::chrono::steady_clock::now() - start;
+
+	remove_tree( dir, processes );
+
+	if( stdio_count != processes || (int)list.size() != processes ) {
+		fprintf( stderr, "expected %d processes, stdio scan found %d, getProcInfoRawList found %d\n",
+				 processes, stdio_count, (int)list.size() );
+		return 1;
+	}
+
+	printf( "%d processes, %d scans\n", processes, iterations );
+	printf( "stdio + sscanf       %8.3f ms/scan  %6.2f us/process\n",
+			1000 * stdio_secs.count() / iterations,
+			1e6 * stdio_secs.count() / iterations / processes );
+	printf( "getProcInfoRawList   %8.3f ms/scan  %6.2f us/process\n",
+			1000 * raw_secs.count() / iterations,
+			1e6 * raw_secs.count() / iterations / processes );
+	return 0;
+}
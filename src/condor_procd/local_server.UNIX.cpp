@@ -144,7 +144,7 @@ LocalServer::set_client_principal(const char* uid_str)
 }
 
 bool
-LocalServer::accept_connection(int timeout, bool &accepted)
+LocalServer::accept_connection(int timeout, bool &accepted, int event_fd, bool* event_ready)
 {
 	ASSERT(m_initialized);
 
@@ -157,7 +157,7 @@ LocalServer::accept_connection(int timeout, bool &accepted)
 	// see if a connection arrives within the timeout period
 	//
 	bool ready;
-	if (!m_reader->poll(timeout, ready)) {
+	if (!m_reader->poll(timeout, ready, event_fd, event_ready)) {
 		return false;
 	}
 	if (!ready) {
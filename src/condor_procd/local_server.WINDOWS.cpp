@@ -96,8 +96,14 @@ LocalServer::set_client_principal(const char*)
 }
 
 bool
-LocalServer::accept_connection(int timeout, bool& ready)
+LocalServer::accept_connection(int timeout, bool& ready, int /*event_fd*/, bool* event_ready)
 {
+	// there are no process events to wait for on Windows
+	//
+	if (event_ready != NULL) {
+		*event_ready = false;
+	}
+
 	// initiate a nonblocking "accept", if one isn't already pending
 	//
 	if (m_accept_overlapped == NULL) {
@@ -144,7 +144,7 @@ NamedPipeReader::read_data(void* buffer, int len)
 }
 
 bool
-NamedPipeReader::poll(int timeout, bool& ready)
+NamedPipeReader::poll(int timeout, bool& ready, int extra_fd, bool* extra_ready)
 {
 	// TODO: select on the watchdog pipe, if we have one. this
 	// currently isn't a big deal since we only use poll() on
@@ -156,6 +156,12 @@ NamedPipeReader::poll(int timeout, bool& ready)
 
 	Selector selector;
 	selector.add_fd( m_pipe, Selector::IO_READ );
+	if (extra_fd != -1) {
+		selector.add_fd( extra_fd, Selector::IO_READ );
+	}
+	if (extra_ready != NULL) {
+		*extra_ready = false;
+	}
 
 	if (timeout != -1) {
 		selector.set_timeout( timeout );
@@ -179,6 +185,9 @@ NamedPipeReader::poll(int timeout, bool& ready)
 	}
 
 	ready = selector.fd_ready( m_pipe, Selector::IO_READ );
+	if (extra_fd != -1 && extra_ready != NULL) {
+		*extra_ready = selector.fd_ready( extra_fd, Selector::IO_READ );
+	}
 
 	return true;
 }
@@ -62,9 +62,11 @@ public:
 
 	// second parameter is set to true if the named pipe
 	// becomes ready for reading within the given timeout
-	// period, otherwise it's set to false
+	// period, otherwise it's set to false. if an extra file
+	// descriptor is given, we also wait for it to become readable
+	// and say whether it did via the last parameter
 	//
-	bool poll(int, bool&);
+	bool poll(int, bool&, int extra_fd = -1, bool* extra_ready = NULL);
 
 	// Determine if the named pipe on the disk is the actual named pipe that
 	// was initially opened. In practice it means that the dev and inode fields
@@ -0,0 +1,213 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "condor_common.h"
+#include "proc_connector.linux.h"
+#include "proc_family_monitor.h"
+
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+
+// tell the kernel to start or stop sending us process events
+//
+static bool
+send_mcast_op(int sock, enum proc_cn_mcast_op op)
+{
+	char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))];
+	memset(buf, 0, sizeof(buf));
+
+	struct nlmsghdr* hdr = (struct nlmsghdr*)buf;
+	hdr->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+	hdr->nlmsg_type = NLMSG_DONE;
+	hdr->nlmsg_pid = getpid();
+
+	struct cn_msg* msg = (struct cn_msg*)NLMSG_DATA(hdr);
+	msg->id.idx = CN_IDX_PROC;
+	msg->id.val = CN_VAL_PROC;
+	msg->len = sizeof(op);
+	memcpy(msg->data, &op, sizeof(op));
+
+	if (send(sock, buf, hdr->nlmsg_len, 0) == -1) {
+		dprintf(D_ALWAYS,
+		        "ProcConnector: send error: %s (%d)\n",
+		        strerror(errno),
+		        errno);
+		return false;
+	}
+	return true;
+}
+
+ProcConnector::ProcConnector() :
+	m_sock(-1)
+{
+}
+
+ProcConnector::~ProcConnector()
+{
+	if (m_sock != -1) {
+		send_mcast_op(m_sock, PROC_CN_MCAST_IGNORE);
+		close(m_sock);
+	}
+}
+
+bool
+ProcConnector::initialize()
+{
+	ASSERT(m_sock == -1);
+
+	int sock = socket(PF_NETLINK,
+	                  SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+	                  NETLINK_CONNECTOR);
+	if (sock == -1) {
+		dprintf(D_ALWAYS,
+		        "ProcConnector: socket error: %s (%d)\n",
+		        strerror(errno),
+		        errno);
+		return false;
+	}
+
+	struct sockaddr_nl addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = CN_IDX_PROC;
+	addr.nl_pid = 0;
+	if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+		dprintf(D_ALWAYS,
+		        "ProcConnector: bind error: %s (%d)\n",
+		        strerror(errno),
+		        errno);
+		close(sock);
+		return false;
+	}
+
+	if (!send_mcast_op(sock, PROC_CN_MCAST_LISTEN)) {
+		close(sock);
+		return false;
+	}
+
+	m_sock = sock;
+	return true;
+}
+
+bool
+ProcConnector::handle_events(ProcFamilyMonitor& monitor)
+{
+	ASSERT(m_sock != -1);
+
+	bool complete = true;
+	while (true) {
+
+		// netlink messages are always aligned, so make sure our buffer is
+		//
+		union {
+			struct nlmsghdr hdr;
+			char data[8192];
+		} buf;
+
+		struct sockaddr_nl from;
+		socklen_t from_len = sizeof(from);
+		ssize_t len = recvfrom(m_sock,
+		                       &buf,
+		                       sizeof(buf),
+		                       0,
+		                       (struct sockaddr*)&from,
+		                       &from_len);
+		if (len == -1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == ENOBUFS) {
+				// the kernel dropped events since we last read
+				//
+				dprintf(D_ALWAYS,
+				        "ProcConnector: process events were lost\n");
+				complete = false;
+				continue;
+			}
+			dprintf(D_ALWAYS,
+			        "ProcConnector: recv error: %s (%d)\n",
+			        strerror(errno),
+			        errno);
+			return false;
+		}
+
+		// only the kernel gets to tell us about processes
+		//
+		if (from.nl_pid != 0) {
+			continue;
+		}
+
+		int remaining = (int)len;
+		for (struct nlmsghdr* hdr = &buf.hdr;
+		     NLMSG_OK(hdr, remaining);
+		     hdr = NLMSG_NEXT(hdr, remaining))
+		{
+			if (hdr->nlmsg_type == NLMSG_ERROR ||
+			    hdr->nlmsg_type == NLMSG_NOOP ||
+			    hdr->nlmsg_type == NLMSG_OVERRUN)
+			{
+				if (hdr->nlmsg_type == NLMSG_OVERRUN) {
+					complete = false;
+				}
+				continue;
+			}
+
+			struct cn_msg* msg = (struct cn_msg*)NLMSG_DATA(hdr);
+			if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC) {
+				continue;
+			}
+
+			struct proc_event* ev = (struct proc_event*)msg->data;
+			switch (ev->what) {
+
+				// new threads show up as forks too; we only care about
+				// new processes
+				//
+				case proc_event::PROC_EVENT_FORK:
+					if (ev->event_data.fork.child_pid ==
+					        ev->event_data.fork.child_tgid)
+					{
+						monitor.process_forked(
+							ev->event_data.fork.parent_tgid,
+							ev->event_data.fork.child_pid);
+					}
+					break;
+
+				case proc_event::PROC_EVENT_EXIT:
+					if (ev->event_data.exit.process_pid ==
+					        ev->event_data.exit.process_tgid)
+					{
+						monitor.process_exited(
+							ev->event_data.exit.process_pid);
+					}
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+
+	return complete;
+}
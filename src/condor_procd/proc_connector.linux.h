@@ -0,0 +1,62 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef _PROC_CONNECTOR_H
+#define _PROC_CONNECTOR_H
+
+class ProcFamilyMonitor;
+
+// a subscription to the kernel's process events (fork, exec, exit)
+// via the netlink "proc connector". this lets the monitor keep its
+// family membership up to date as processes come and go, instead of
+// having to find new processes by scanning all of /proc
+//
+class ProcConnector {
+
+public:
+
+	ProcConnector();
+
+	~ProcConnector();
+
+	// open the netlink socket and subscribe to process events. this
+	// fails if the kernel lacks the proc connector or if we lack the
+	// CAP_NET_ADMIN capability; the reason is logged
+	//
+	bool initialize();
+
+	// the socket to select on for pending events
+	//
+	int get_fd() { return m_sock; }
+
+	// read all pending events off the socket, passing fork and exit
+	// events for whole processes (not threads) on to the monitor.
+	// returns false if the kernel had to drop events because we didn't
+	// read them fast enough, in which case only a full scan of the
+	// system can bring the monitor back up to date
+	//
+	bool handle_events(ProcFamilyMonitor&);
+
+private:
+
+	int m_sock;
+};
+
+#endif
@@ -40,6 +40,13 @@ ProcFamilyMember::still_alive(procInfo* pi)
 	m_still_alive = true;
 }
 
+void
+ProcFamilyMember::exited(procInfo* pi)
+{
+	delete m_proc_info;
+	m_proc_info = pi;
+}
+
 void
 ProcFamilyMember::move_to_subfamily(ProcFamily* subfamily)
 {
@@ -40,6 +40,12 @@ public:
 	//
 	void still_alive(procInfo*);
 
+	// this is called by ProcFamilyMonitor::process_exited() to
+	// record the final procInfo of a process that has exited but
+	// hasn't been reaped yet. it does not mark the process as alive
+	//
+	void exited(procInfo*);
+
 	// this is called from ProcFamilyMonitor::register_subfamily
 	// to move a process into the newly-registered subfamily
 	// (of which it will be the "root" process)
@@ -37,6 +37,10 @@
 #include "cgroup_tracker.linux.h"
 #endif
 
+#if defined(LINUX)
+#include "proc_connector.linux.h"
+#endif
+
 ProcFamilyMonitor::ProcFamilyMonitor(pid_t pid,
                                      birthday_t birthday,
                                      int snapshot_interval,
@@ -58,6 +62,10 @@ ProcFamilyMonitor::ProcFamilyMonitor(pid_t pid,
 	ASSERT(m_pid_tracker != NULL);
 #if defined(LINUX)
 	m_group_tracker = NULL;
+	m_proc_connector = NULL;
+	m_reconcile_interval = 0;
+	m_last_reconcile = 0;
+	m_reconcile_needed = false;
 #endif
 #if defined(HAVE_EXT_LIBCGROUP)
 	m_cgroup_tracker = NULL;
@@ -123,6 +131,9 @@ ProcFamilyMonitor::~ProcFamilyMonitor()
 	if (m_group_tracker != NULL) {
 		delete m_group_tracker;
 	}
+	if (m_proc_connector != NULL) {
+		delete m_proc_connector;
+	}
 #endif
 #if defined(HAVE_EXT_LIBCGROUP)
 	if (m_cgroup_tracker != NULL) {
@@ -145,8 +156,158 @@ ProcFamilyMonitor::enable_group_tracking(gid_t min_tracking_gid,
 									   allocating);
 	ASSERT(m_group_tracker != NULL);
 }
+
+bool
+ProcFamilyMonitor::enable_event_tracking(int reconcile_interval)
+{
+	ASSERT(m_proc_connector == NULL);
+	ASSERT(reconcile_interval > 0);
+
+	m_proc_connector = new ProcConnector;
+	ASSERT(m_proc_connector != NULL);
+	if (!m_proc_connector->initialize()) {
+		dprintf(D_ALWAYS,
+		        "process events unavailable; "
+		            "falling back to scanning all processes\n");
+		delete m_proc_connector;
+		m_proc_connector = NULL;
+		return false;
+	}
+	m_reconcile_interval = reconcile_interval;
+
+	// we may have missed processes between our last snapshot and
+	// subscribing to events, so make sure the next snapshot is a
+	// full one
+	//
+	m_reconcile_needed = true;
+
+	dprintf(D_ALWAYS,
+	        "tracking processes via process events; "
+	            "scanning all processes every %d seconds\n",
+	        reconcile_interval);
+	return true;
+}
+
+void
+ProcFamilyMonitor::handle_events()
+{
+	ASSERT(m_proc_connector != NULL);
+	if (!m_proc_connector->handle_events(*this)) {
+		m_reconcile_needed = true;
+	}
+}
+
+void
+ProcFamilyMonitor::process_forked(pid_t parent_pid, pid_t child_pid)
+{
+	// we only need to act on children of processes in the families
+	// we're tracking; anything else is left for the next full scan
+	//
+	ProcFamilyMember* parent = lookup_member(parent_pid);
+	if (parent == NULL || parent->get_proc_family() == m_everybody_else) {
+		return;
+	}
+
+	procInfo* pi = NULL;
+	int status;
+	if (ProcAPI::getProcInfo(child_pid, pi, status) != PROCAPI_SUCCESS) {
+		// the child is already gone; its usage will be included in
+		// its parent's once it's reaped
+		//
+		delete pi;
+		return;
+	}
+
+	ProcFamilyMember* member = lookup_member(child_pid);
+	if (member != NULL) {
+		if (member->get_proc_info()->birthday != pi->birthday) {
+			// this PID was reused since we last saw it exit; we
+			// can only clean up the stale entry with a full scan
+			//
+			m_reconcile_needed = true;
+		}
+		delete pi;
+		return;
+	}
+
+	add_member_to_family(parent->get_proc_family(), pi, "PROC_EVENT");
+}
+
+void
+ProcFamilyMonitor::process_exited(pid_t pid)
+{
+	ProcFamilyMember* member = lookup_member(pid);
+	if (member == NULL || member->get_proc_family() == m_everybody_else) {
+		return;
+	}
+
+	// the process is a zombie until it's reaped, so we can still grab
+	// its final usage. it will be removed from its family at the next
+	// snapshot, when it's no longer found
+	//
+	procInfo* pi = NULL;
+	int status;
+	if (ProcAPI::getProcInfo(pid, pi, status) == PROCAPI_SUCCESS &&
+	    pi->birthday == member->get_proc_info()->birthday)
+	{
+		member->exited(pi);
+	}
+	else {
+		delete pi;
+	}
+}
+
+void
+ProcFamilyMonitor::refresh()
+{
+	dprintf(D_ALWAYS, "refreshing tracked processes...\n");
+
+	// look up each process in the families we're tracking on its own;
+	// the ones we can't find anymore have exited. new processes were
+	// added as their fork events came in
+	//
+	pid_t pid;
+	ProcFamilyMember* member;
+	m_member_table.startIterations();
+	while (m_member_table.iterate(pid, member)) {
+		if (member->get_proc_family() == m_everybody_else) {
+			continue;
+		}
+		procInfo* pi = NULL;
+		int status;
+		if (ProcAPI::getProcInfo(pid, pi, status) == PROCAPI_SUCCESS &&
+		    pi->birthday == member->get_proc_info()->birthday)
+		{
+			member->still_alive(pi);
+		}
+		else {
+			delete pi;
+		}
+	}
+
+	// we haven't looked at anything in m_everybody_else, so leave it
+	// be until the next full scan
+	//
+	remove_exited_processes(m_tree);
+
+	delete_unwatched_families(m_tree);
+
+	update_max_image_sizes(m_tree);
+
+	dprintf(D_ALWAYS, "...refresh complete\n");
+}
 #endif
 
+int
+ProcFamilyMonitor::get_event_fd()
+{
+#if defined(LINUX)
+	return (m_proc_connector != NULL) ? m_proc_connector->get_fd() : -1;
+#else
+	return -1;
+#endif
+}
+
 #if defined(HAVE_EXT_LIBCGROUP)
 void
 ProcFamilyMonitor::enable_cgroup_tracking()
@@ -196,7 +357,7 @@ ProcFamilyMonitor::register_subfamily(pid_t root_pid,
 
 	// get our family tree state as up to date as possible
 	//
-	snapshot();
+	full_snapshot();
 
 	// find the root process of the (potential) new subfamily
 	// in our snapshot. we require that the process of any newly
@@ -471,7 +632,7 @@ ProcFamilyMonitor::signal_family(pid_t pid, int sig)
 {
 	// get as up to date as possible
 	//
-	snapshot();
+	full_snapshot();
 
 	// find the family
 	//
@@ -539,6 +700,25 @@ ProcFamilyMonitor::get_family_usage(pid_t pid, ProcFamilyUsage* usage)
 void
 ProcFamilyMonitor::snapshot()
 {
+#if defined(LINUX)
+	// with process events we already know about new processes in our
+	// families, so we only need to scan the whole system now and then
+	// to catch anything the events can't tell us (like processes that
+	// join a family via login or environment)
+	//
+	if (m_proc_connector != NULL) {
+		time_t now = time(NULL);
+		if (!m_reconcile_needed &&
+		    now - m_last_reconcile < m_reconcile_interval)
+		{
+			refresh();
+			return;
+		}
+		m_last_reconcile = now;
+		m_reconcile_needed = false;
+	}
+#endif
+
 	dprintf(D_ALWAYS, "taking a snapshot...\n");
 
 	// get a snapshot of all processes on the system
@@ -669,6 +849,23 @@ ProcFamilyMonitor::snapshot()
 	dprintf(D_ALWAYS, "...snapshot complete\n");
 }
 
+void
+ProcFamilyMonitor::full_snapshot()
+{
+#if defined(LINUX)
+	// with event tracking, a plain snapshot may only refresh the
+	// processes we already know about. take in any events that are
+	// still queued (so new children are in their families before we
+	// scan) and then make it a full scan
+	//
+	if (m_proc_connector != NULL) {
+		handle_events();
+		m_reconcile_needed = true;
+	}
+#endif
+	snapshot();
+}
+
 void
 ProcFamilyMonitor::add_member(ProcFamilyMember* member)
 {
@@ -35,6 +35,9 @@ class GroupTracker;
 #if defined(HAVE_EXT_LIBCGROUP)
 class CGroupTracker;
 #endif
+#if defined(LINUX)
+class ProcConnector;
+#endif
 class LoginTracker;
 class EnvironmentTracker;
 class ParentTracker;
@@ -58,8 +61,30 @@ public:
 	//
 	void enable_group_tracking(gid_t min_tracking_gid, 
 			gid_t max_tracking_gid, bool allocating);
+
+	// enable tracking based on process events from the kernel's
+	// netlink proc connector. once enabled, snapshots only refresh the
+	// processes in the families we're tracking, and a full scan of the
+	// system is only done every reconcile_interval seconds (or if events
+	// were lost). returns false if the proc connector isn't available
+	//
+	bool enable_event_tracking(int reconcile_interval);
+
+	// read pending process events and update our families accordingly
+	//
+	void handle_events();
+
+	// called by the ProcConnector when a process forks or exits
+	//
+	void process_forked(pid_t parent_pid, pid_t child_pid);
+	void process_exited(pid_t pid);
 #endif
 
+	// the socket to select on for process events, or -1 if event
+	// tracking is not enabled
+	//
+	int get_event_fd();
+
 	// create a "subfamily", which can then be signalled and accounted
 	// for as a unit
 	//
@@ -132,6 +157,12 @@ public:
 	//
 	void snapshot();
 
+	// like snapshot(), but always scans every process on the system,
+	// so that processes that only the GID, cgroup, login or environment
+	// trackers can place are found. used before acting on a family
+	//
+	void full_snapshot();
+
 	// used to access the pid_t to ProcFamilyMember hash table
 	// (these need to be public since they are called from the
 	//  various tracker classes)
@@ -185,6 +216,22 @@ private:
 	EnvironmentTracker* m_environment_tracker;
 	ParentTracker*      m_parent_tracker;
 
+#if defined(LINUX)
+	// our subscription to process events, if event tracking is enabled,
+	// along with what we need to know to decide when to do a full scan
+	// of the system rather than just refreshing the processes we know
+	//
+	ProcConnector*      m_proc_connector;
+	int                 m_reconcile_interval;
+	time_t              m_last_reconcile;
+	bool                m_reconcile_needed;
+
+	// update the procInfo of every process in the families we're
+	// tracking without scanning all processes on the system
+	//
+	void refresh();
+#endif
+
 	// find the minimum of all the ProcFamilys' requested "maximum
 	// snapshot intervals"
 	//
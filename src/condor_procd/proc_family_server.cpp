@@ -405,11 +405,31 @@ ProcFamilyServer::wait_loop()
 	
 		time_t time_before = time(NULL);
 		bool command_ready;
+		bool events_ready = false;
 		bool ok = m_server->accept_connection(snapshot_countdown,
-		                                      command_ready);
+		                                      command_ready,
+		                                      m_monitor.get_event_fd(),
+		                                      &events_ready);
 		if (!ok) {
 			EXCEPT("ProcFamilyServer: failed trying to accept client");
 		}
+#if defined(LINUX)
+		if (events_ready) {
+			m_monitor.handle_events();
+		}
+#endif
+		if (!command_ready && events_ready) {
+			// only process events arrived; just account for the
+			// time we waited (unless we're waiting forever)
+			//
+			if (snapshot_countdown > 0) {
+				snapshot_countdown -= (time(NULL) - time_before);
+				if (snapshot_countdown < 0) {
+					snapshot_countdown = 0;
+				}
+			}
+			continue;
+		}
 		if (!command_ready) {
 			// timeout; make sure we execute the timer handler
 			// next time around by explicitly setting the
@@ -64,6 +64,12 @@ static int max_snapshot_interval = 60;
 //
 static gid_t min_tracking_gid = 0;
 static gid_t max_tracking_gid = 0;
+
+// if positive, track processes via the kernel's process events
+// and only scan all processes on the system this often (in seconds)
+// (set with the "-N" option)
+//
+static int event_reconcile_interval = 0;
 #endif
 
 #if defined(WIN32)
@@ -122,6 +128,8 @@ usage(void)
 	"                         If -E is specified then procd_ctl must be used\n"
 	"                         to allocate gids which must then be in this\n"
 	"                         range.\n"
+	"  -N <seconds>           Track processes via kernel process events,\n"
+	"                         scanning all processes only this often.\n"
 	"  -I <glexec-kill-path> <glexec-path> <glexec-retries> <glexec-retry-delay>\n"
 	"                         Specify the binary which will send a signal\n"
 	"                         to a pid and the glexec binary which will run\n"
@@ -268,6 +276,16 @@ parse_command_line(int argc, char* argv[])
 				index++;
 				max_tracking_gid = (gid_t)atoi(argv[index]);
 				break;
+
+			// event-based process tracking
+			//
+			case 'N':
+				if (index + 1 >= argc) {
+					fail_option_args("-N", 1);
+				}
+				index++;
+				event_reconcile_interval = atoi(argv[index]);
+				break;
 #endif
 
 #if defined(WIN32)
@@ -504,6 +522,13 @@ main(int argc, char* argv[])
 			max_tracking_gid,
 			use_external_gid_association ? false : true);
 	}
+
+	// if a "-N" option was given, track processes via process events
+	// if the kernel lets us; otherwise we keep scanning as usual
+	//
+	if (event_reconcile_interval > 0) {
+		monitor.enable_event_tracking(event_reconcile_interval);
+	}
 #endif
 
 #if defined(HAVE_EXT_LIBCGROUP)
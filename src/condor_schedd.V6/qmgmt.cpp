@@ -215,7 +215,16 @@ static int 	MAX_PRIO_REC=INITIAL_MAX_PRIO_REC ;	// INITIAL_MAX_* in prio_rec.h
 
 JOB_ID_KEY_BUF HeaderKey(0,0);
 
-ForkWork schedd_forker;
+// ForkWork that hands queued condor_q requests to workers as they exit
+class ScheddForkWork : public ForkWork
+{
+  protected:
+	virtual void WorkerReaped( pid_t /*pid*/ ) {
+		scheduler.ServicePendingJobQueries();
+	}
+};
+static ScheddForkWork the_schedd_forker;
+ForkWork & schedd_forker = the_schedd_forker;
 
 // Create a hash table which, given a cluster id, tells how
 // many procs are in the cluster
@@ -6319,6 +6328,30 @@ MarkJobClean(int cluster_id, int proc_id)
 	MarkJobClean(key);
 }
 
+// Append the names of the attributes of ad that are candidates for $$()
+// expansion to attrs.  If child is not NULL, attributes that child
+// overrides are skipped since they will be (or were) added from child.
+static void
+AppendAttrsToExpand(StringList &attrs, const classad::ClassAd &ad, const classad::ClassAd *child)
+{
+	for ( auto itr = ad.begin(); itr != ad.end(); itr++ ) {
+		if ( strncasecmp(itr->first.c_str(),"MATCH_",6) == 0 ) {
+				// We do not want to expand MATCH_XXX attributes,
+				// because these are used to store the result of
+				// previous expansions, which could potentially
+				// contain literal $$(...) in the replacement text.
+			continue;
+		}
+		if ( strcasecmp(itr->first.c_str(),ATTR_JOB_CMD) == 0 ) {
+			continue;
+		}
+		if ( child && child->LookupIgnoreChain(itr->first) ) {
+			continue;
+		}
+		attrs.append(itr->first.c_str());
+	}
+}
+
 ClassAd *
 dollarDollarExpand(int cluster_id, int proc_id, ClassAd *ad, ClassAd *startd_ad, bool persist_expansions)
 {
@@ -6346,31 +6379,25 @@ dollarDollarExpand(int cluster_id, int proc_id, ClassAd *ad, ClassAd *startd_ad,
 		char *left,*name,*right,*value,*tvalue;
 		bool value_came_from_jobad;
 
-		// we must make a deep copy of the job ad; we do not
-		// want to expand the ad we have in memory.
-		expanded_ad = new ClassAd(*ad);  
-
-		// Copy attributes from chained parent ad into the expanded ad
-		// so if parent is deleted before caller is finished with this
-		// ad, things will still be ok.
-		ChainCollapse(*expanded_ad);
+		// we must make a copy of the job ad; we do not want to
+		// expand the ad we have in memory.  We copy only the
+		// attributes of the proc ad and leave the copy chained to
+		// the cluster ad, so the cluster's attributes are shared
+		// rather than duplicated for every job we start.  Anything
+		// we expand below is written into the copy, overriding the
+		// cluster's value.  Callers that hold on to the expanded ad
+		// after the cluster could be removed must ChainCollapse() it.
+		expanded_ad = new ClassAd(*ad);
 
 			// Make a stringlist of all attribute names in job ad.
 			// Note: ATTR_JOB_CMD must be first in AttrsToExpand...
 		StringList AttrsToExpand;
 		const char * curr_attr_to_expand;
 		AttrsToExpand.append(ATTR_JOB_CMD);
-		for ( auto itr = expanded_ad->begin(); itr != expanded_ad->end(); itr++ ) {
-			if ( strncasecmp(itr->first.c_str(),"MATCH_",6) == 0 ) {
-					// We do not want to expand MATCH_XXX attributes,
-					// because these are used to store the result of
-					// previous expansions, which could potentially
-					// contain literal $$(...) in the replacement text.
-				continue;
-			}
-			if ( strcasecmp(itr->first.c_str(),ATTR_JOB_CMD) ) {
-				AttrsToExpand.append(itr->first.c_str());
-			}
+		AppendAttrsToExpand(AttrsToExpand, *expanded_ad, NULL);
+		const classad::ClassAd *cluster_ad = expanded_ad->GetChainedParentAd();
+		if ( cluster_ad ) {
+			AppendAttrsToExpand(AttrsToExpand, *cluster_ad, expanded_ad);
 		}
 
 		index = -1;	
@@ -356,7 +356,9 @@ void DirtyPrioRecArray();
 extern ClassAd *dollarDollarExpand(int cid, int pid, ClassAd *job, ClassAd *res, bool persist_expansions);
 bool rewriteSpooledJobAd(ClassAd *job_ad, int cluster, int proc, bool modify_ad);
 
-// The returned expanded ad is a copy of the job classad, and must be deleted
+// The returned expanded ad is a copy of the job classad, and must be deleted.
+// It holds only the proc attributes and the expansions, and is chained to
+// the cluster ad; ChainCollapse() it if it must outlive the cluster ad.
 ClassAd* GetExpandedJobAd(const PROC_ID& jid, bool persist_expansions);
 
 #ifdef SCHEDD_INTERNAL_DECLARATIONS
@@ -588,6 +590,6 @@ extern void	FindRunnableJob(PROC_ID & jobid, ClassAd* my_match_ad, char const *
 extern int Runnable(PROC_ID*);
 extern int Runnable(JobQueueJob *job, const char *& reason);
 
-extern class ForkWork schedd_forker;
+extern class ForkWork & schedd_forker;
 
 #endif /* _QMGMT_H */
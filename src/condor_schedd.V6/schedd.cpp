@@ -185,6 +185,10 @@ schedd_runtime_probe WalkJobQ_clear_autocluster_id_runtime;
 schedd_runtime_probe WalkJobQ_add_runnable_local_jobs_runtime;
 schedd_runtime_probe WalkJobQ_fixAttrUser_runtime;
 schedd_runtime_probe WalkJobQ_updateSchedDInterval_runtime;
+schedd_runtime_probe SpawnShadow_runtime;
+schedd_runtime_probe QueryJobAdsInProc_runtime;
+schedd_runtime_probe QueryJobAdsWait_runtime;
+schedd_runtime_probe SendAlives_runtime;
 
 int	WallClockCkptInterval = 0;
 int STARTD_CONTACT_TIMEOUT = 45;  // how long to potentially block
@@ -602,6 +606,9 @@ Scheduler::Scheduler() :
 	m_use_slot_weights(false),
 	m_local_startd_pid(-1),
 	m_matchPasswordEnabled(false),
+	m_max_pending_job_queries(0),
+	m_pending_job_query_timeout(20),
+	m_pending_job_queries_tid(-1),
 	m_token_requester(&Scheduler::token_request_callback, this)
 {
 	MyShadowSockName = NULL;
@@ -665,6 +672,8 @@ Scheduler::Scheduler() :
 	CondorAdministrator = NULL;
 	Mail = NULL;
 	alive_interval = 0;
+	m_use_startd_channels = true;
+	m_batch_alives = true;
 	leaseAliveInterval = 500000;	// init to a nice big number
 	aliveid = -1;
 	ExitWhenDone = FALSE;
@@ -2259,6 +2268,8 @@ struct QueryJobAdsContinuation : Service {
 	bool summary_only;
 	bool unfinished_eom;
 	bool registered_socket;
+	Stream *pending_sock;	// set while waiting in m_pending_job_queries
+	double queued_time;
 
 	QueryJobAdsContinuation(classad_shared_ptr<classad::ExprTree> requirements_, int limit, int timeslice_ms=0, int iter_opts=0);
 	int finish(Stream *);
@@ -2271,7 +2282,9 @@ QueryJobAdsContinuation::QueryJobAdsContinuation(classad_shared_ptr<classad::Exp
 	  match_count(0),
 	  summary_only(false),
 	  unfinished_eom(false),
-	  registered_socket(false)
+	  registered_socket(false),
+	  pending_sock(NULL),
+	  queued_time(0)
 {
 	it.set_options(iter_opts);
 	my_job_counts.clear_counters();
@@ -2279,6 +2292,9 @@ QueryJobAdsContinuation::QueryJobAdsContinuation(classad_shared_ptr<classad::Exp
 
 int
 QueryJobAdsContinuation::finish(Stream *stream) {
+	// time spent here in the schedd proper (rather than a forked worker)
+	// is time the main loop is stalled on a query.
+	_condor_auto_accum_runtime<schedd_runtime_probe> rt(QueryJobAdsInProc_runtime);
 	ReliSock *sock = static_cast<ReliSock*>(stream);
 	JobQueueLogType::filter_iterator end = GetJobQueueIteratorEnd();
 	if (match_limit >= 0 && (match_count >= match_limit)) {
@@ -2375,6 +2391,12 @@ int Scheduler::command_query_job_ads(int cmd, Stream* stream)
 		return FALSE;
 	}
 
+	// job ads compress very well; if the session negotiated compression,
+	// spend a bit more cpu on the reply than we do on ordinary messages.
+	if (stream->get_compression()) {
+		((ReliSock*)stream)->set_compression_level(param_integer("QUERY_COMPRESSION_LEVEL", 6, 0, 9));
+	}
+
 	// if the groupby or useautocluster attributes exist and are true
 	bool group_by = false;
 	queryAd.LookupBool("ProjectionIsGroupBy", group_by);
@@ -2521,12 +2543,18 @@ int Scheduler::command_query_job_ads(int cmd, Stream* stream)
 		continuation->summary_only = true;
 	}
 
-	ForkStatus fork_status = schedd_forker.NewJob();
+		// if other queries are already waiting for a worker, get in
+		// line behind them rather than forking ahead of them.
+	ForkStatus fork_status = FORK_BUSY;
+	if (m_pending_job_queries.empty()) {
+		fork_status = schedd_forker.NewJob();
+	}
 	if (fork_status == FORK_PARENT)
 	{ // Successfully forked a child - as far as the schedd cares, this worked.
 	  // Throw away the socket and move on.
 		// need to delete the parent's copy of the continuation object
 		delete continuation;
+		stats.JobQueriesForked += 1;
 		return true;
 	}
 	else if (fork_status == FORK_CHILD)
@@ -2537,12 +2565,113 @@ int Scheduler::command_query_job_ads(int cmd, Stream* stream)
 		ASSERT( false );
 		while (true) {}
 	}
-	else // BUSY or FAILED
+	else if (fork_status == FORK_BUSY && queuePendingJobQuery(continuation, stream))
+	{ // All of the workers are busy, wait for one to exit rather than
+	  // answering the query on the main loop.
+		return KEEP_STREAM;
+	}
+	else // FAILED, or too many queries waiting
 	{ // Write the response; let DC handle the callbacks.
+		stats.JobQueriesInProc += 1;
 		return continuation->finish(stream);
 	}
 }
 
+bool
+Scheduler::queuePendingJobQuery(QueryJobAdsContinuation *continuation, Stream *stream)
+{
+	if (schedd_forker.getMaxWorkers() <= 0 ||
+		(int)m_pending_job_queries.size() >= m_max_pending_job_queries) {
+		return false;
+	}
+
+	continuation->pending_sock = stream;
+	continuation->queued_time = _condor_debug_get_time_double();
+	m_pending_job_queries.push_back(continuation);
+	stats.JobQueriesPending = (int)m_pending_job_queries.size();
+
+		// a worker exiting normally gets the queue moving again, but a
+		// timer makes sure that nothing waits forever on a worker that
+		// doesn't exit, or on workers that reconfig took away.
+	if (m_pending_job_queries_tid < 0) {
+		m_pending_job_queries_tid = daemonCore->Register_Timer(1, 1,
+			(TimerHandlercpp)&Scheduler::ServicePendingJobQueries,
+			"ServicePendingJobQueries", this);
+	}
+
+	dprintf(D_FULLDEBUG, "QUERY_JOB_ADS: all %d query workers busy, %d queries waiting\n",
+		schedd_forker.getNumWorkers(), (int)m_pending_job_queries.size());
+	return true;
+}
+
+void
+Scheduler::ServicePendingJobQueries()
+{
+	double now = _condor_debug_get_time_double();
+
+		// the client should be waiting quietly for our answer, so if
+		// its socket is readable it has given up on us.  Check every
+		// waiting query, not just the one at the front of the line.
+	for (auto it = m_pending_job_queries.begin(); it != m_pending_job_queries.end(); ) {
+		QueryJobAdsContinuation *continuation = *it;
+		ReliSock *sock = static_cast<ReliSock*>(continuation->pending_sock);
+		if (sock->deadline_expired() || sock->readReady()) {
+			dprintf(D_ALWAYS, "QUERY_JOB_ADS: dropping query from %s that waited %.3f sec for a worker, client gone\n",
+				sock->peer_description(), now - continuation->queued_time);
+			it = m_pending_job_queries.erase(it);
+			delete continuation;
+			delete sock;
+		} else {
+			++it;
+		}
+	}
+
+	while ( ! m_pending_job_queries.empty()) {
+		QueryJobAdsContinuation *continuation = m_pending_job_queries.front();
+		ReliSock *sock = static_cast<ReliSock*>(continuation->pending_sock);
+		double waited = now - continuation->queued_time;
+
+			// if reconfig took the workers away, answer in-process
+		ForkStatus fork_status = FORK_FAILED;
+		if (schedd_forker.getMaxWorkers() > 0) {
+			fork_status = schedd_forker.NewJob();
+		}
+		if (fork_status == FORK_BUSY) {
+			if (waited < m_pending_job_query_timeout) {
+				break;
+			}
+			dprintf(D_ALWAYS, "QUERY_JOB_ADS: query from %s waited %.3f sec for a worker, answering it in-process\n",
+				sock->peer_description(), waited);
+			fork_status = FORK_FAILED;
+		}
+		m_pending_job_queries.pop_front();
+		QueryJobAdsWait_runtime += waited;
+
+		if (fork_status == FORK_CHILD) {
+			int retval;
+			while ((retval = continuation->finish(sock)) == KEEP_STREAM) {}
+			_exit(!retval);
+		} else if (fork_status == FORK_PARENT) {
+			stats.JobQueriesForked += 1;
+			delete continuation;
+			delete sock;
+		} else {
+				// the continuation deletes itself and owns the socket
+				// from here on.
+			stats.JobQueriesInProc += 1;
+			if (continuation->finish(sock) != KEEP_STREAM) {
+				delete sock;
+			}
+		}
+	}
+	stats.JobQueriesPending = (int)m_pending_job_queries.size();
+
+	if (m_pending_job_queries.empty() && m_pending_job_queries_tid >= 0) {
+		daemonCore->Cancel_Timer(m_pending_job_queries_tid);
+		m_pending_job_queries_tid = -1;
+	}
+}
+
 void * BeginJobAggregation(bool use_def_autocluster, const char * projection, int result_limit, int return_jobid_limit, classad::ExprTree *constraint)
 {
 	JobAggregationResults *jar = NULL;
@@ -7616,6 +7745,12 @@ Scheduler::contactStartd( ContactStartdArgs* args )
 	}
 	else {
 		jobAd = GetExpandedJobAd(JOB_ID_KEY(mrec->cluster, mrec->proc), false);
+			// the claim request keeps a copy of this ad until the
+			// startd answers, so don't leave it pointing at the
+			// cluster ad, which might be removed in the meantime.
+		if( jobAd ) {
+			ChainCollapse(*jobAd);
+		}
 	}
 	if( ! jobAd ) {
 			// The match rec may have been deleted by now if the job
@@ -8872,6 +9007,7 @@ Scheduler::StartJobHandler()
 	int cluster, proc;
 	int status;
 	ClassAd *job_ad = NULL;
+	int jobs_started = 0;
 
 		// clear out our timer id since the hander just went off
 	StartJobTimer = -1;
@@ -8945,9 +9081,25 @@ Scheduler::StartJobHandler()
 			}
 		}
 
-			// we're done trying to spawn a job at this time.  call
+		jobs_started++;
+
+			// if jobThrottle() says the next job may start right
+			// away, start it in this pass rather than going back
+			// through the timer for every job in the burst.  we never
+			// start more than JobStartCount jobs per pass, so a
+			// JOB_START_DELAY of 0 can't starve the rest of the schedd.
+		if( RunnableJobQueue.empty() ) {
+			tryNextJob();
+			return;
+		}
+		int delay = jobThrottle();
+		if( delay == 0 && jobs_started < JobStartCount ) {
+			continue;
+		}
+
+			// we're done trying to spawn jobs at this time.  call
 			// tryNextJob() to let our timer logic handle the rest.
-		tryNextJob();
+		tryNextJob( delay );
 		return;
 	}
 }
@@ -9327,6 +9479,7 @@ Scheduler::spawnShadow( shadow_rec* srec )
 	//-------------------------------
 	// Actually fork the shadow
 	//-------------------------------
+	double spawn_begin = _condor_debug_get_time_double();
 
 	bool	rval;
 	ArgList args;
@@ -9513,6 +9666,8 @@ Scheduler::spawnShadow( shadow_rec* srec )
 			 "(shadow pid = %d)\n", job_id->cluster, job_id->proc,
 			 mrec->description(), srec->pid );
 
+	SpawnShadow_runtime += _condor_debug_get_time_double() - spawn_begin;
+
     //time_t now = time(NULL);
     time_t now = stats.Tick();
     stats.ShadowsStarted += 1;
@@ -9589,14 +9744,17 @@ Scheduler::setNextJobDelay( ClassAd *job_ad, ClassAd *machine_ad ) {
 }
 
 void
-Scheduler::tryNextJob()
+Scheduler::tryNextJob( int delay )
 {
 		// Re-set timer if there are any jobs left in the queue
 	if( !RunnableJobQueue.empty() ) {
+		if( delay < 0 ) {
+			delay = jobThrottle();
+		}
 		StartJobTimer = daemonCore->
 		// Queue the next job start via the daemoncore timer.  jobThrottle()
 		// implements job bursting, and returns the proper delay for the timer.
-			Register_Timer( jobThrottle(),
+			Register_Timer( delay,
 							(TimerHandlercpp)&Scheduler::StartJobHandler,
 							"start_job", this ); 
 	} else {
@@ -9656,7 +9814,18 @@ Scheduler::spawnJobHandlerRaw( shadow_rec* srec, const char* path,
 	int pipe_fds[2];
 	pipe_fds[0] = -1;
 	pipe_fds[1] = -1;
-	if( wants_pipe ) {
+#ifndef WIN32
+		// On unix, let DaemonCore own the stdin pipe and feed the job
+		// ad to the handler from the event loop.  Otherwise we block
+		// here until the new process has exec'd and drained the pipe,
+		// which caps how fast we can start shadows for large job ads.
+	bool async_ad_write = wants_pipe;
+#else
+	bool async_ad_write = false;
+#endif
+	if( async_ad_write ) {
+		std_fds[0] = DC_STD_FD_PIPE;
+	} else if( wants_pipe ) {
 		if( ! daemonCore->Create_Pipe(pipe_fds) ) {
 			dprintf( D_ALWAYS, 
 					 "ERROR: Can't create DC pipe for writing job "
@@ -9783,7 +9952,17 @@ Scheduler::spawnJobHandlerRaw( shadow_rec* srec, const char* path,
 
 		// finally, now that the handler has been spawned, we need to
 		// do some things with the pipe (if there is one):
-	if( wants_pipe ) {
+	if( async_ad_write ) {
+			// hand the job ad to DaemonCore, which writes it as the
+			// pipe drains and closes the pipe when it is done.
+		ASSERT( job_ad );
+		MyString ad_str;
+		sPrintAdWithSecrets(ad_str, *job_ad);
+		if( daemonCore->Write_Stdin_Pipe(pid, ad_str.Value(), ad_str.Length()) < 0 ) {
+			dprintf(D_ALWAYS, "writeJobAd: Write_Stdin_Pipe failed for pid %d\n", pid);
+			daemonCore->Close_Stdin_Pipe(pid);
+		}
+	} else if( wants_pipe ) {
 			// 1) close our copy of the read end of the pipe, so we
 			// don't leak it.  we have to use DC::Close_Pipe() for
 			// this, not just close(), so things work on windoze.
@@ -13277,6 +13456,12 @@ Scheduler::Init()
 		// jobs before ATTR_JOB_LEASE_DURATION has passed, thereby screwing
 		// up the operation of the disconnected shadow/starter feature.
 
+	m_batch_alives = param_boolean("SCHEDD_BATCH_ALIVES", true);
+	m_use_startd_channels = param_boolean("SCHEDD_PERSISTENT_STARTD_CONNECTIONS", true);
+	if( !m_use_startd_channels ) {
+		m_startd_channels.clear();
+	}
+
 		//
 		// CronTab Table
 		// We keep a list of proc_id's for jobs that define a cron
@@ -13516,6 +13701,9 @@ Scheduler::Init()
 	int max_history_concurrency = param_integer("HISTORY_HELPER_MAX_CONCURRENCY", 50);
 	HistoryQue.setup(1000, max_history_concurrency);
 
+	m_max_pending_job_queries = param_integer("SCHEDD_QUERY_WORKERS_PENDING", 50, 0);
+	m_pending_job_query_timeout = param_integer("SCHEDD_QUERY_WORKERS_PENDING_TIMEOUT", 20, 0);
+
     m_userlog_file_cache_max = param_integer("USERLOG_FILE_CACHE_MAX", 0, 0);
     m_userlog_file_cache_clear_interval = param_integer("USERLOG_FILE_CACHE_CLEAR_INTERVAL", 60, 0);
 
@@ -14646,7 +14834,17 @@ sendAlive( match_rec* mrec )
 
 	dprintf (D_PROTOCOL,"## 6. Sending alive msg to %s\n", mrec->description());
 
-	startd->sendMsg( msg.get() );
+		// Over TCP, keep one connection to each startd for all of the
+		// claims we hold there instead of one per claim.
+	StartdCommandChannels *channels = scheduler.startdChannels();
+	if( st == Stream::reli_sock && channels ) {
+		channels->sendMsg( startd, msg.get() );
+	}
+	else {
+		startd->sendMsg( msg.get() );
+	}
+
+	scheduler.stats.AliveMessagesSent += 1;
 
 	if( msg->deliveryStatus() == DCMsg::DELIVERY_FAILED ) {
 			// Status may also be DELIVERY_PENDING, in which case, we
@@ -14877,9 +15075,94 @@ Scheduler::handle_collector_token_request(int, Stream *stream)
 	return true;
 }
 
+/*
+ * Send one ALIVE_BATCH carrying all of the given claims, which must all
+ * be on the same startd.  The reply is handled by aliveBatchDone().
+ */
+bool
+Scheduler::sendAliveBatch( std::vector<match_rec*> const &mrecs )
+{
+	ASSERT( !mrecs.empty() );
+	match_rec *first = mrecs.front();
+
+	std::vector<std::string> claim_ids;
+	claim_ids.reserve( mrecs.size() );
+	for( auto itr = mrecs.begin(); itr != mrecs.end(); itr++ ) {
+		claim_ids.push_back( (*itr)->claimId() );
+	}
+
+	classy_counted_ptr<DCStartd> startd = new DCStartd( first->description(),NULL,first->peer,first->claimId() );
+	classy_counted_ptr<DCAliveBatchMsg> msg = new DCAliveBatchMsg( claim_ids );
+
+	msg->setSuccessDebugLevel(D_PROTOCOL);
+	msg->setTimeout( STARTD_CONTACT_TIMEOUT );
+	msg->setDeadlineTimeout( 300 );
+	msg->setStreamType( Stream::reli_sock );
+		// Any of the claims' sessions will do; the startd checks each
+		// claim id it is sent.
+	msg->setSecSessionId( first->secSessionId() );
+	msg->setCallback( new DCMsgCallback(
+		(DCMsgCallback::CppFunction)&Scheduler::aliveBatchDone, this ) );
+
+	dprintf( D_PROTOCOL, "## 6. Sending alive msg for %d claims to %s\n",
+			 (int)mrecs.size(), first->peer );
+
+	stats.AliveMessagesSent += 1;
+	stats.AliveBatchesSent += 1;
+	startd->sendMsg( msg.get() );
+
+	return msg->deliveryStatus() != DCMsg::DELIVERY_FAILED;
+}
+
+void
+Scheduler::aliveBatchDone( DCMsgCallback *cb )
+{
+	DCAliveBatchMsg *msg = (DCAliveBatchMsg *)cb->getMessage();
+	ASSERT( msg );
+
+	std::vector<std::string> const &claim_ids = msg->claimIds();
+	std::vector<int> const &statuses = msg->statuses();
+	if( msg->deliveryStatus() != DCMsg::DELIVERY_SUCCEEDED ||
+		statuses.size() != claim_ids.size() )
+	{
+			// Perhaps the session we sent it with is gone.  Fall back
+			// to one ALIVE per claim next time around.
+		ClaimIdParser idp( claim_ids.front().c_str() );
+		match_rec *mrec = FindMrecByClaimID( claim_ids.front().c_str() );
+		if( mrec ) {
+			m_alive_batch_fallback.insert( mrec->peer );
+		}
+		dprintf( D_FULLDEBUG, "ALIVE_BATCH with claim %s failed; "
+				 "will send separate alive messages next time.\n",
+				 idp.publicClaimId() );
+		return;
+	}
+
+	int num_missing = 0;
+	for( size_t i = 0; i < claim_ids.size(); i++ ) {
+		if( statuses[i] != ALIVE_BATCH_OK ) {
+			ClaimIdParser idp( claim_ids[i].c_str() );
+			char const *reason = "unknown status";
+			switch( statuses[i] ) {
+			case ALIVE_BATCH_NO_CLAIM: reason = "no such claim"; break;
+			case ALIVE_BATCH_NOT_ACTIVE: reason = "not the slot's current claim"; break;
+			case ALIVE_BATCH_REFUSED: reason = "claim is not in a state to be kept alive"; break;
+			}
+			dprintf( D_FULLDEBUG, "Startd did not accept keep alive for claim %s: %s (status %d)\n",
+					 idp.publicClaimId(), reason, statuses[i] );
+			num_missing++;
+		}
+	}
+	if( num_missing ) {
+		dprintf( D_ALWAYS, "Startd did not accept keep alives for %d of %d claims.\n",
+				 num_missing, (int)claim_ids.size() );
+	}
+}
+
 void
 Scheduler::sendAlives()
 {
+	_condor_auto_accum_runtime<schedd_runtime_probe> rt(SendAlives_runtime);
 	match_rec	*mrec;
 	int		  	numsent=0;
 	bool starter_handles_alives = param_boolean("STARTER_HANDLES_ALIVES",true);
@@ -14942,12 +15225,25 @@ Scheduler::sendAlives()
 	}
 	CommitNonDurableTransactionOrDieTrying();
 
+		// Claims on startds that understand ALIVE_BATCH are gathered
+		// per startd and kept alive with one message each, below.
+	std::map<std::string, std::vector<match_rec*> > batches;
+	std::set<std::string> batch_fallback;
+	batch_fallback.swap( m_alive_batch_fallback );
+
 	matches->startIterations();
 	while (matches->iterate(mrec) == 1) {
 		if( mrec->m_startd_sends_alives == false &&
 			( mrec->status == M_ACTIVE || mrec->status == M_CLAIMED ) ) {
 
-			if( sendAlive( mrec ) ) {
+			std::string version;
+			if( m_batch_alives && mrec->peer && !batch_fallback.count( mrec->peer ) &&
+				mrec->my_match_ad && mrec->my_match_ad->LookupString( ATTR_VERSION, version ) &&
+				CondorVersionInfo( version.c_str() ).built_since_version( 8, 9, 10 ) )
+			{
+				batches[mrec->peer].push_back( mrec );
+			}
+			else if( sendAlive( mrec ) ) {
 				numsent++;
 			}
 		}
@@ -14988,6 +15284,16 @@ Scheduler::sendAlives()
 			}
 		}
 	}
+		// Even a single claim goes in a batch, so that the startd
+		// channels are only used for startds that can't take batches,
+		// and close once they are idle.
+	for( auto itr = batches.begin(); itr != batches.end(); itr++ ) {
+		std::vector<match_rec*> &batch = itr->second;
+		if( sendAliveBatch( batch ) ) {
+			numsent += (int)batch.size();
+		}
+	}
+
 	if( numsent ) { 
 		dprintf( D_PROTOCOL, "## 6. (Done sending alive messages to "
 				 "%d startds)\n", numsent );
@@ -14997,6 +15303,15 @@ Scheduler::sendAlives()
 	// this, just call the dedicated_scheduler's version of the
 	// same thing so we keep all of those claims alive, too.
 	dedicated_scheduler.sendAlives();
+
+		// Connections to startds we no longer hold claims on (or
+		// only hold claims on that the startd sends alives for) are
+		// not needed anymore.
+	m_startd_channels.closeIdle( now );
+	if( m_startd_channels.numChannels() ) {
+		dprintf( D_FULLDEBUG, "Holding %d connections to startds for alive messages.\n",
+				 m_startd_channels.numChannels() );
+	}
 }
 
 void
@@ -195,6 +195,14 @@ void ScheddStatistics::InitMain()
    SCHEDD_STATS_ADD_VAL(Pool, ShadowsRunning,               IF_BASICPUB);
    SCHEDD_STATS_PUB_PEAK(Pool, ShadowsRunning,              IF_BASICPUB);
 
+   SCHEDD_STATS_ADD_RECENT(Pool, JobQueriesForked,          IF_VERBOSEPUB);
+   SCHEDD_STATS_ADD_RECENT(Pool, JobQueriesInProc,          IF_VERBOSEPUB);
+   SCHEDD_STATS_ADD_VAL(Pool, JobQueriesPending,            IF_VERBOSEPUB);
+   SCHEDD_STATS_PUB_PEAK(Pool, JobQueriesPending,           IF_VERBOSEPUB);
+
+   SCHEDD_STATS_ADD_RECENT(Pool, AliveMessagesSent,         IF_VERBOSEPUB);
+   SCHEDD_STATS_ADD_RECENT(Pool, AliveBatchesSent,          IF_VERBOSEPUB);
+
    SCHEDD_STATS_ADD_VAL(Pool, JobsRestartReconnectsFailed, IF_BASICPUB);
    SCHEDD_STATS_ADD_VAL(Pool, JobsRestartReconnectsLeaseExpired, IF_BASICPUB);
    SCHEDD_STATS_ADD_VAL(Pool, JobsRestartReconnectsSucceeded, IF_BASICPUB);
@@ -221,6 +229,17 @@ void ScheddStatistics::InitMain()
    SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, WalkJobQ_mark_idle,               IF_VERBOSEPUB);
    SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, WalkJobQ_get_job_prio,            IF_VERBOSEPUB);
 
+   // time spent forking shadows and handing them their job ads
+   SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, SpawnShadow, IF_VERBOSEPUB);
+
+   // time the main loop spends answering condor_q, and the time queries
+   // wait for a free SCHEDD_QUERY_WORKERS slot
+   SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, QueryJobAdsInProc, IF_VERBOSEPUB);
+   SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, QueryJobAdsWait,   IF_VERBOSEPUB);
+
+   // time spent in each alive cycle
+   SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, SendAlives, IF_VERBOSEPUB);
+
    // timings for the autocluster code
    SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, GetAutoCluster,           IF_VERBOSEPUB);
    SCHEDD_STATS_ADD_EXTERN_RUNTIME(Pool, GetAutoCluster_hit,       IF_VERBOSEPUB);
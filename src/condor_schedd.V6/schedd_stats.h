@@ -131,6 +131,15 @@ typedef struct ScheddStatistics : public ScheddJobCounters {
    //stats_entry_recent<int> ShadowExceptions;     // number of times shadows have excepted
    stats_entry_recent<int> ShadowsReconnections; // number of times shadows have reconnected
 
+   // condor_q (QUERY_JOB_ADS) handling
+   stats_entry_recent<int> JobQueriesForked;     // queries answered by a forked query worker
+   stats_entry_recent<int> JobQueriesInProc;     // queries answered on the schedd's main loop
+   stats_entry_abs<int>    JobQueriesPending;    // queries waiting for a query worker, also tracks the peak value.
+
+   // keep alives sent to startds
+   stats_entry_recent<int> AliveMessagesSent;    // ALIVE and ALIVE_BATCH messages sent
+   stats_entry_recent<int> AliveBatchesSent;     // ALIVE_BATCH messages sent
+
 
    // non-published values
    time_t InitTime;            // last time we init'ed the structure
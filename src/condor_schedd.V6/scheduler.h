@@ -34,6 +34,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <queue>
+#include <deque>
 
 // switch to using User (fully qualified) over Owner as the main job identity
 #define USER_IS_THE_NEW_OWNER 1
@@ -66,6 +67,7 @@
 #include "condor_holdcodes.h"
 #include "job_transforms.h"
 #include "history_queue.h"
+#include "startd_channels.h"
 
 extern  int         STARTD_CONTACT_TIMEOUT;
 const	int			NEGOTIATOR_CONTACT_TIMEOUT = 30;
@@ -506,6 +508,7 @@ private:
 };
 
 class JobSets; // forward reference - declared in jobsets.h
+struct QueryJobAdsContinuation; // declared in schedd.cpp
 
 class Scheduler : public Service
 {
@@ -613,8 +616,13 @@ class Scheduler : public Service
 	void			StartJobs();
 	void			StartJob(match_rec *rec);
 	void			sendAlives();
+	bool			sendAliveBatch( std::vector<match_rec*> const &mrecs );
+	void			aliveBatchDone( DCMsgCallback *cb );
 	void			RecomputeAliveInterval(int cluster, int proc);
 	void			StartJobHandler();
+		// hand condor_q requests that are waiting for a free
+		// SCHEDD_QUERY_WORKERS slot to newly forked workers
+	void			ServicePendingJobQueries();
 	void			addRunnableJob( shadow_rec* );
 	void			spawnShadow( shadow_rec* );
 	void			spawnLocalStarter( shadow_rec* );
@@ -690,6 +698,8 @@ class Scheduler : public Service
 		// Useful public info
 	char*			shadowSockSinful( void ) { return MyShadowSockName; };
 	int				aliveInterval( void ) const { return alive_interval; };
+		// NULL if SCHEDD_PERSISTENT_STARTD_CONNECTIONS is false
+	StartdCommandChannels* startdChannels( void ) { return m_use_startd_channels ? &m_startd_channels : NULL; };
 	char*			uidDomain( void ) { return UidDomain; };
 	int				getMaxMaterializedJobsPerCluster() const { return MaxMaterializedJobsPerCluster; }
 	bool			getAllowLateMaterialize() const { return AllowLateMaterialize; }
@@ -994,7 +1004,8 @@ private:
 	void			preempt( int n, bool force_sched_jobs = false );
 	void			attempt_shutdown();
 	static void		refuse( Stream* s );
-	void			tryNextJob();
+		// delay < 0 means ask jobThrottle() for the delay
+	void			tryNextJob( int delay = -1 );
 	int				jobThrottle( void );
 	void			initLocalStarterDir( void );
 	void	noShadowForJob( shadow_rec* srec, NoShadowFailure_t why );
@@ -1077,6 +1088,12 @@ private:
 	int				MaxFlockLevel;
 	int				FlockLevel;
     int         	alive_interval;  // how often to broadcast alive
+	bool			m_use_startd_channels;
+	bool			m_batch_alives;
+		// startds whose last ALIVE_BATCH failed; they get one ALIVE
+		// per claim in the next alive cycle
+	std::set<std::string> m_alive_batch_fallback;
+	StartdCommandChannels m_startd_channels; // connections for ALIVE messages to startds
 		// leaseAliveInterval is the minimum interval we need to send
 		// keepalives based upon ATTR_JOB_LEASE_DURATION...
 	int				leaseAliveInterval;  
@@ -1134,6 +1151,13 @@ private:
 	// object to manage history queries in flight
 	HistoryHelperQueue HistoryQue;
 
+	// condor_q requests waiting for a forked query worker, oldest first
+	std::deque<QueryJobAdsContinuation*> m_pending_job_queries;
+	int m_max_pending_job_queries;
+	int m_pending_job_query_timeout;	// seconds a query waits before being answered in-process
+	int m_pending_job_queries_tid;		// drains m_pending_job_queries while it isn't empty
+	bool queuePendingJobQuery(QueryJobAdsContinuation *continuation, Stream *stream);
+
 	bool m_matchPasswordEnabled;
 
 	bool m_include_default_flock_param{true};
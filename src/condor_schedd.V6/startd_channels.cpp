@@ -0,0 +1,315 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_daemon_core.h"
+#include "selector.h"
+#include "startd_channels.h"
+
+StartdCommandChannels::StartdCommandChannels()
+{
+}
+
+StartdCommandChannels::~StartdCommandChannels()
+{
+	clear();
+}
+
+void
+StartdCommandChannels::clear()
+{
+	while( !m_channels.empty() ) {
+		closeChannel( m_channels.begin()->first, false );
+	}
+	m_avoid.clear();
+}
+
+void
+StartdCommandChannels::sendMsg( classy_counted_ptr<DCStartd> startd, classy_counted_ptr<DCMsg> msg )
+{
+	ASSERT( msg->getStreamType() == Stream::reli_sock );
+
+	std::string addr = startd->addr() ? startd->addr() : "";
+	if( addr.empty() || m_avoid.count( addr ) ) {
+		startd->sendMsg( msg.get() );
+		return;
+	}
+
+	auto itr = m_channels.find( addr );
+	if( itr != m_channels.end() && itr->second.writing.get() ) {
+			// Still writing an earlier message; this one goes next.
+		itr->second.queued.push_back( msg );
+		return;
+	}
+
+	if( itr != m_channels.end() && !itr->second.first_cb.get() &&
+		peerClosed( itr->second.sock.get() ) )
+	{
+		dprintf( D_FULLDEBUG, "Connection for commands to %s was closed by the startd.\n",
+				 startd->idStr() );
+		closeChannel( addr, true );
+		startd->sendMsg( msg.get() );
+		return;
+	}
+
+	if( itr == m_channels.end() ) {
+		if( !openChannel( startd, msg ) ) {
+			startd->sendMsg( msg.get() );
+		}
+		return;
+	}
+
+	Channel &channel = itr->second;
+	if( channel.first_cb.get() ) {
+			// Still connecting or setting up the security session.
+		startd->sendMsg( msg.get() );
+		return;
+	}
+
+	channel.last_used = time(NULL);
+	if( !writeMsg( channel, msg ) ) {
+		dprintf( D_FULLDEBUG, "Failed to send %s to %s over existing connection.\n",
+				 msg->name(), startd->idStr() );
+		closeChannel( addr, false );
+		startd->sendMsg( msg.get() );
+	}
+}
+
+bool
+StartdCommandChannels::writeMsg( Channel &channel, classy_counted_ptr<DCMsg> msg )
+{
+		// The security session is already in place, so all that is
+		// needed is the command int followed by the message itself.
+	ReliSock *sock = static_cast<ReliSock *>( channel.sock.get() );
+	BlockingModeGuard guard( sock, true );
+	sock->encode();
+	if( !sock->put( msg->getCommand() ) || !msg->writeMsg( channel.messenger.get(), sock ) ) {
+		return false;
+	}
+	int rc = sock->end_of_message_nonblocking();
+	if( sock->clear_backlog_flag() ) {
+			// The startd's end of the connection is full.  Leave the
+			// rest to DaemonCore rather than stalling the schedd.
+		int reg_rc = daemonCore->Register_Socket( sock, "startd command channel",
+			(SocketHandlercpp)&StartdCommandChannels::finishWrite,
+			"StartdCommandChannels::finishWrite", this, ALLOW, HANDLE_WRITE );
+		if( reg_rc < 0 ) {
+			return false;
+		}
+		channel.writing = msg;
+		return true;
+	}
+	if( !rc ) {
+		return false;
+	}
+	msg->deliveryStatus( DCMsg::DELIVERY_SUCCEEDED );
+	msg->messageSent( channel.messenger.get(), sock );
+	return true;
+}
+
+int
+StartdCommandChannels::finishWrite( Stream *stream )
+{
+	std::string addr;
+	for( auto itr = m_channels.begin(); itr != m_channels.end(); itr++ ) {
+		if( itr->second.sock.get() == stream ) {
+			addr = itr->first;
+			break;
+		}
+	}
+	if( addr.empty() ) {
+		daemonCore->Cancel_Socket( stream );
+		return KEEP_STREAM;
+	}
+
+	Channel &channel = m_channels[addr];
+	ReliSock *sock = static_cast<ReliSock *>( stream );
+	sock->encode();
+	int rc = sock->finish_end_of_message();
+	if( sock->clear_backlog_flag() ) {
+		return KEEP_STREAM; // still more to send
+	}
+	daemonCore->Cancel_Socket( stream );
+	if( !rc ) {
+		writeFailed( addr, "failed to send EOM" );
+		return KEEP_STREAM;
+	}
+
+	classy_counted_ptr<DCMsg> msg = channel.writing;
+	channel.writing = NULL;
+	msg->deliveryStatus( DCMsg::DELIVERY_SUCCEEDED );
+	msg->messageSent( channel.messenger.get(), sock );
+
+		// Now the messages that were waiting for this one.
+	while( !channel.queued.empty() && !channel.writing.get() ) {
+		msg = channel.queued.front();
+		channel.queued.pop_front();
+		if( !writeMsg( channel, msg ) ) {
+			dprintf( D_FULLDEBUG, "Failed to send %s to %s over existing connection.\n",
+					 msg->name(), channel.startd->idStr() );
+			classy_counted_ptr<DCStartd> startd = channel.startd;
+			closeChannel( addr, false );
+			startd->sendMsg( msg.get() );
+			break;
+		}
+	}
+	return KEEP_STREAM;
+}
+
+void
+StartdCommandChannels::writeFailed( std::string const &addr, char const *reason )
+{
+	auto itr = m_channels.find( addr );
+	if( itr == m_channels.end() || !itr->second.writing.get() ) {
+		return;
+	}
+	classy_counted_ptr<DCMsg> msg = itr->second.writing;
+	classy_counted_ptr<DCMessenger> messenger = itr->second.messenger;
+	itr->second.writing = NULL;
+	if( daemonCore ) {
+		daemonCore->Cancel_Socket( itr->second.sock.get() );
+	}
+
+	msg->addError( CEDAR_ERR_PUT_FAILED, "%s", reason );
+	msg->deliveryStatus( DCMsg::DELIVERY_FAILED );
+	msg->messageSendFailed( messenger.get() );
+
+		// Only that message is lost; closing the channel sends the ones
+		// waiting behind it on connections of their own.
+	closeChannel( addr, false );
+}
+
+bool
+StartdCommandChannels::openChannel( classy_counted_ptr<DCStartd> startd, classy_counted_ptr<DCMsg> msg )
+{
+	CondorError errstack;
+	Sock *sock = startd->makeConnectedSocket( Stream::reli_sock, msg->getTimeout(),
+											  msg->getDeadline(), &errstack, true );
+	if( !sock ) {
+		return false;
+	}
+
+	std::string addr = startd->addr();
+	Channel &channel = m_channels[addr];
+	channel.startd = startd;
+	channel.sock = sock;
+	channel.messenger = new DCMessenger( startd.get(), channel.sock );
+	channel.first_cb = new DCMsgCallback(
+		(DCMsgCallback::CppFunction)&StartdCommandChannels::firstMsgDone,
+		this, new std::string( addr ) );
+	channel.last_used = time(NULL);
+
+	dprintf( D_FULLDEBUG, "Opening connection for commands to %s.\n", startd->idStr() );
+
+	msg->setCallback( channel.first_cb );
+	channel.messenger->startCommand( msg );
+	return true;
+}
+
+void
+StartdCommandChannels::firstMsgDone( DCMsgCallback *cb )
+{
+	std::string *addr = (std::string *)cb->getMiscDataPtr();
+	ASSERT( addr );
+
+	auto itr = m_channels.find( *addr );
+	if( itr != m_channels.end() && itr->second.first_cb.get() == cb ) {
+		itr->second.first_cb = NULL;
+		if( cb->getMessage()->deliveryStatus() != DCMsg::DELIVERY_SUCCEEDED ) {
+			closeChannel( *addr, false );
+		}
+	}
+	delete addr;
+}
+
+void
+StartdCommandChannels::closeChannel( std::string const &addr, bool peer_closed )
+{
+	auto itr = m_channels.find( addr );
+	if( itr == m_channels.end() ) {
+		return;
+	}
+	if( itr->second.writing.get() ) {
+		writeFailed( addr, "connection closed before the message was sent" );
+		return;
+	}
+	if( itr->second.first_cb.get() ) {
+			// The messenger still holds the socket; let it finish
+			// the first command on its own.
+		delete (std::string *)itr->second.first_cb->getMiscDataPtr();
+		itr->second.first_cb->cancelCallback();
+	}
+	if( peer_closed ) {
+		m_avoid[addr] = time(NULL);
+	}
+	classy_counted_ptr<DCStartd> startd = itr->second.startd;
+	std::deque< classy_counted_ptr<DCMsg> > queued;
+	queued.swap( itr->second.queued );
+	m_channels.erase( itr );
+
+	for( auto q = queued.begin(); q != queued.end(); q++ ) {
+		startd->sendMsg( q->get() );
+	}
+}
+
+bool
+StartdCommandChannels::peerClosed( Sock *sock )
+{
+		// The startd never writes to this socket, so if there is anything
+		// to read, it is the end of the stream.
+	Selector selector;
+	selector.add_fd( sock->get_file_desc(), Selector::IO_READ );
+	selector.set_timeout( 0 );
+	selector.execute();
+	return !sock->is_connected() || selector.has_ready() || selector.failed();
+}
+
+void
+StartdCommandChannels::closeIdle( time_t unused_since )
+{
+	for( auto itr = m_avoid.begin(); itr != m_avoid.end(); ) {
+		if( itr->second < unused_since ) {
+			itr = m_avoid.erase( itr );
+		}
+		else {
+			itr++;
+		}
+	}
+
+	std::set<std::string> idle;
+	std::set<std::string> stuck;
+	for( auto itr = m_channels.begin(); itr != m_channels.end(); itr++ ) {
+		DCMsg *writing = itr->second.writing.get();
+		if( writing && writing->getDeadlineExpired() ) {
+			stuck.insert( itr->first );
+		}
+		else if( !writing && itr->second.last_used < unused_since ) {
+			idle.insert( itr->first );
+		}
+	}
+	for( auto itr = stuck.begin(); itr != stuck.end(); itr++ ) {
+		dprintf( D_ALWAYS, "Giving up on connection for commands to %s: the startd is not reading.\n",
+				 itr->c_str() );
+		writeFailed( *itr, "deadline expired" );
+	}
+	for( auto itr = idle.begin(); itr != idle.end(); itr++ ) {
+		closeChannel( *itr, false );
+	}
+}
@@ -0,0 +1,109 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef _CONDOR_STARTD_CHANNELS_H
+#define _CONDOR_STARTD_CHANNELS_H
+
+#include "dc_service.h"
+#include "dc_message.h"
+#include "dc_startd.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
+/*
+  StartdCommandChannels keeps one TCP connection open to each startd
+  that the schedd sends one-way claim commands (such as ALIVE) to, so
+  that a burst of those commands does not open a connection per claim.
+
+  The first command sent to a startd opens the connection and
+  establishes the security session, just like any other command.  The
+  startd keeps the socket registered for further commands, and later
+  commands are written to it directly, back to back, within that
+  session, the same way TCP updates are sent to the collector.  Only
+  commands the startd does not reply to may be sent this way.
+
+  Writes never block.  If the startd is not keeping up, the rest of
+  the message is left for DaemonCore to send when the socket becomes
+  writable, and further messages wait in a queue until then.  If that
+  write fails, only the message being written fails; the queued ones
+  are sent on connections of their own.
+
+  Whenever a connection is not usable (still being set up, closed by
+  the startd, or failed), the message is sent on a connection of its
+  own, as it always was.
+ */
+
+class StartdCommandChannels: public Service {
+ public:
+	StartdCommandChannels();
+	~StartdCommandChannels();
+
+		// Send msg to startd.  msg must be a one-way TCP message with no
+		// callback of its own; its delivery status is set as usual, and
+		// stays DELIVERY_PENDING while it waits for the socket.
+	void sendMsg( classy_counted_ptr<DCStartd> startd, classy_counted_ptr<DCMsg> msg );
+
+		// Close connections that have not been used since the given time,
+		// and start trusting connections to startds that closed them on us
+		// before then again.
+	void closeIdle( time_t unused_since );
+
+		// Close all connections.
+	void clear();
+
+	int numChannels() const { return (int)m_channels.size(); }
+
+ private:
+	struct Channel {
+		classy_counted_ptr<DCStartd> startd;
+		classy_counted_ptr<Sock> sock;
+		classy_counted_ptr<DCMessenger> messenger;
+		classy_counted_ptr<DCMsgCallback> first_cb; // set until the connection is set up
+		classy_counted_ptr<DCMsg> writing; // set while a message is partly written
+		std::deque< classy_counted_ptr<DCMsg> > queued; // waiting for writing
+		time_t last_used;
+	};
+
+	std::map<std::string, Channel> m_channels;
+
+		// Startds that closed a connection we were using, mapped to when we
+		// noticed.  Until the next closeIdle() after that, messages to them
+		// are sent on connections of their own, so that a startd that does
+		// not keep the socket cannot make us lose every other message.
+	std::map<std::string, time_t> m_avoid;
+
+	bool openChannel( classy_counted_ptr<DCStartd> startd, classy_counted_ptr<DCMsg> msg );
+	void closeChannel( std::string const &addr, bool peer_closed );
+	bool peerClosed( Sock *sock );
+	void firstMsgDone( DCMsgCallback *cb );
+
+		// Write msg to the channel without blocking.  Returns false if it
+		// could not be written at all, in which case the channel must be
+		// closed and msg sent some other way.
+	bool writeMsg( Channel &channel, classy_counted_ptr<DCMsg> msg );
+		// DaemonCore handler for a channel with a partly written message
+	int finishWrite( Stream *sock );
+		// The message being written to the channel has failed.
+	void writeFailed( std::string const &addr, char const *reason );
+};
+
+#endif
@@ -28,6 +28,16 @@
 #include "condor_email.h"
 #include "algorithm"
 
+static const time_t xfer_queue_wait_levels[] = {
+	1, 10, 30, 60, 3*60, 10*60, 30*60, 60*60, 3*60*60, 6*60*60
+};
+static const int64_t xfer_rate_levels[] = {
+	(int64_t)0x10000,            (int64_t)0x10000 * 0x4,      // 64KB/s, 256KB/s
+	(int64_t)0x10000 * 0x10,     (int64_t)0x10000 * 0x40,     //  1MB/s,   4MB/s
+	(int64_t)0x10000 * 0x100,    (int64_t)0x10000 * 0x400,    // 16MB/s,  64MB/s
+	(int64_t)0x10000 * 0x1000,   (int64_t)0x10000 * 0x4000    //256MB/s,   1GB/s
+};
+
 TransferQueueRequest::TransferQueueRequest(ReliSock *sock,filesize_t sandbox_size,char const *fname,char const *jobid,char const *queue_user,bool downloading,time_t max_queue_age):
 	m_sock(sock),
 	m_queue_user(queue_user),
@@ -41,6 +51,7 @@ TransferQueueRequest::TransferQueueRequest(ReliSock *sock,filesize_t sandbox_siz
 	m_notified_about_taking_too_long = false;
 	m_time_born = time(NULL);
 	m_time_go_ahead = 0;
+	m_bytes_transferred = 0;
 
 		// the up_down_queue_user name uniquely identifies the user and the direction of transfer
 	if( m_downloading ) {
@@ -121,6 +132,9 @@ TransferQueueManager::TransferQueueManager() {
 	m_max_downloads = 0;
 	m_check_queue_timer = -1;
 	m_default_max_queue_age = 0;
+	m_policy = POLICY_ROUND_ROBIN;
+	m_upload_rate = 0;
+	m_download_rate = 0;
 	m_throttle_disk_load = false;
 	m_disk_load_low_throttle = 0;
 	m_disk_load_high_throttle = 0;
@@ -148,6 +162,15 @@ TransferQueueManager::TransferQueueManager() {
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_NUM_WAITING_TO_DOWNLOAD,&m_waiting_to_download_stat,NULL,IF_BASICPUB|m_waiting_to_download_stat.PubDefault);
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_UPLOAD_WAIT_TIME,&m_upload_wait_time_stat,NULL,IF_BASICPUB|m_upload_wait_time_stat.PubDefault);
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_DOWNLOAD_WAIT_TIME,&m_download_wait_time_stat,NULL,IF_BASICPUB|m_download_wait_time_stat.PubDefault);
+
+	m_upload_wait_times.set_levels(xfer_queue_wait_levels,COUNTOF(xfer_queue_wait_levels));
+	m_download_wait_times.set_levels(xfer_queue_wait_levels,COUNTOF(xfer_queue_wait_levels));
+	m_upload_rates.set_levels(xfer_rate_levels,COUNTOF(xfer_rate_levels));
+	m_download_rates.set_levels(xfer_rate_levels,COUNTOF(xfer_rate_levels));
+	m_stat_pool.AddProbe("TransferQueueUploadWaitTimes",&m_upload_wait_times,NULL,IF_BASICPUB|m_upload_wait_times.PubValue);
+	m_stat_pool.AddProbe("TransferQueueDownloadWaitTimes",&m_download_wait_times,NULL,IF_BASICPUB|m_download_wait_times.PubValue);
+	m_stat_pool.AddProbe("TransferQueueUploadRates",&m_upload_rates,NULL,IF_BASICPUB|m_upload_rates.PubValue);
+	m_stat_pool.AddProbe("TransferQueueDownloadRates",&m_download_rates,NULL,IF_BASICPUB|m_download_rates.PubValue);
 	RegisterStats(NULL,m_iostats);
 }
 
@@ -232,6 +255,19 @@ TransferQueueManager::InitAndReconfig() {
 	m_max_uploads = param_integer("MAX_CONCURRENT_UPLOADS",100,0);
 	m_default_max_queue_age = param_integer("MAX_TRANSFER_QUEUE_AGE",3600*2,0);
 
+	std::string policy;
+	param(policy,"TRANSFER_QUEUE_SCHEDULING_POLICY");
+	if( strcasecmp(policy.c_str(),"ShortestFirst") == 0 ) {
+		m_policy = POLICY_SHORTEST_FIRST;
+	}
+	else {
+		if( !policy.empty() && strcasecmp(policy.c_str(),"RoundRobin") != 0 ) {
+			dprintf(D_ALWAYS,"WARNING: unknown TRANSFER_QUEUE_SCHEDULING_POLICY=%s; using RoundRobin\n",
+					policy.c_str());
+		}
+		m_policy = POLICY_ROUND_ROBIN;
+	}
+
 	parseThrottleConfig("FILE_TRANSFER_DISK_LOAD_THROTTLE",m_throttle_disk_load,m_disk_load_low_throttle,m_disk_load_high_throttle,m_disk_throttle_short_horizon,m_disk_throttle_long_horizon,m_throttle_disk_load_increment_wait);
 
 	if( m_throttle_disk_load ) {
@@ -433,6 +469,7 @@ TransferQueueManager::HandleReport( Stream *sock )
 						"TransferQueueManager: dequeueing %s.\n",
 						client->Description());
 
+				TransferFinished(client);
 				delete client;
 				m_xfer_queue.DeleteCurrent();
 
@@ -458,7 +495,7 @@ TransferQueueManager::HandleReport( Stream *sock )
 }
 
 bool
-TransferQueueRequest::ReadReport(TransferQueueManager *manager) const
+TransferQueueRequest::ReadReport(TransferQueueManager *manager)
 {
 	MyString report;
 	m_sock->decode();
@@ -504,6 +541,8 @@ TransferQueueRequest::ReadReport(TransferQueueManager *manager) const
 	iostats.net_read = (double)recent_usec_net_read/1000000;
 	iostats.net_write = (double)recent_usec_net_write/1000000;
 
+	m_bytes_transferred += (double)recent_bytes_sent + (double)recent_bytes_received;
+
 	manager->AddRecentIOStats(iostats,m_up_down_queue_user);
 	return true;
 }
@@ -827,6 +866,8 @@ TransferQueueManager::CheckTransferQueue() {
 		TransferQueueRequest *best_client = NULL;
 		int best_recency = 0;
 		unsigned int best_running_count = 0;
+		double best_ratio = 0;
+		time_t now = time(NULL);
 
 		if( m_throttle_disk_load && (uploading + downloading >= m_throttle_disk_load_max_concurrency) ) {
 			break;
@@ -845,6 +886,10 @@ TransferQueueManager::CheckTransferQueue() {
 				TransferQueueUser &this_user = GetUserRec(client->m_up_down_queue_user);
 				unsigned int this_user_active_count = this_user.running;
 				int this_user_recency = this_user.recency;
+				double this_ratio = 0;
+				if( m_policy == POLICY_SHORTEST_FIRST ) {
+					this_ratio = ResponseRatio(client,now);
+				}
 
 				bool this_client_is_better = false;
 				if( !best_client ) {
@@ -856,6 +901,13 @@ TransferQueueManager::CheckTransferQueue() {
 						this_client_is_better = true;
 					}
 				}
+				else if( m_policy == POLICY_SHORTEST_FIRST ) {
+						// prefer transfers that are short compared to
+						// how long they have been waiting
+					if( this_ratio > best_ratio ) {
+						this_client_is_better = true;
+					}
+				}
 				else if( best_running_count > this_user_active_count ) {
 						// prefer users with fewer active transfers
 						// (only counting transfers in one direction for this comparison)
@@ -870,6 +922,7 @@ TransferQueueManager::CheckTransferQueue() {
 					best_client = client;
 					best_running_count = this_user_active_count;
 					best_recency = this_user_recency;
+					best_ratio = this_ratio;
 				}
 			}
 		}
@@ -901,9 +954,11 @@ TransferQueueManager::CheckTransferQueue() {
 			user.idle -= 1;
 			if( client->m_downloading ) {
 				downloading += 1;
+				m_download_wait_times.Add(client->m_time_go_ahead - client->m_time_born);
 			}
 			else {
 				uploading += 1;
+				m_upload_wait_times.Add(client->m_time_go_ahead - client->m_time_born);
 			}
 		}
 	}
@@ -978,6 +1033,51 @@ TransferQueueManager::CheckTransferQueue() {
 	}
 }
 
+double
+TransferQueueManager::ResponseRatio(TransferQueueRequest *client,time_t now) const
+{
+		// Until some transfers have finished, assume 1MB/s.  Only the
+		// relative order of waiting transfers matters here.
+	double rate = client->m_downloading ? m_download_rate : m_upload_rate;
+	if( rate <= 0 ) {
+		rate = 1024*1024;
+	}
+	double expected = client->m_sandbox_size_MB*1024*1024 / rate;
+	if( expected < 1 ) {
+		expected = 1;
+	}
+	double waited = now > client->m_time_born ? (double)(now - client->m_time_born) : 0;
+	return (waited + expected) / expected;
+}
+
+void
+TransferQueueManager::TransferFinished(TransferQueueRequest *client)
+{
+	if( !client->m_gave_go_ahead || client->m_bytes_transferred <= 0 ) {
+		return;
+	}
+	time_t duration = time(NULL) - client->m_time_go_ahead;
+	if( duration < 1 ) {
+		duration = 1;
+	}
+	double rate = client->m_bytes_transferred / duration;
+
+	double &avg_rate = client->m_downloading ? m_download_rate : m_upload_rate;
+	if( avg_rate <= 0 ) {
+		avg_rate = rate;
+	}
+	else {
+		avg_rate = 0.9*avg_rate + 0.1*rate;
+	}
+
+	if( client->m_downloading ) {
+		m_download_rates.Add((int64_t)rate);
+	}
+	else {
+		m_upload_rates.Add((int64_t)rate);
+	}
+}
+
 void
 TransferQueueManager::notifyAboutTransfersTakingTooLong()
 {
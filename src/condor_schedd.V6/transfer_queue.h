@@ -55,7 +55,7 @@ class TransferQueueRequest {
 
 	bool SendGoAhead(XFER_QUEUE_ENUM go_ahead=XFER_QUEUE_GO_AHEAD,char const *reason=NULL);
 
-	bool ReadReport(class TransferQueueManager *manager) const;
+	bool ReadReport(class TransferQueueManager *manager);
 
 	ReliSock *m_sock;
 	MyString m_queue_user;   // Name of file transfer queue user. (TRANSFER_QUEUE_USER_EXPR)
@@ -74,6 +74,7 @@ class TransferQueueRequest {
 	                        // 0 indicates no limit
 	time_t m_time_born;
 	time_t m_time_go_ahead;
+	double m_bytes_transferred; // as reported by the client since GoAhead
 
 	MyString m_description; // buffer for Description()
 };
@@ -116,10 +117,21 @@ class TransferQueueManager: public Service {
 
 	void AddRecentIOStats(IOStats &s,const std::string &up_down_queue_user);
  private:
+	enum SchedulingPolicy {
+		POLICY_ROUND_ROBIN,    // fewest active transfers per user, then round robin
+		POLICY_SHORTEST_FIRST  // highest (wait + expected duration)/expected duration
+	};
+
 	SimpleList<TransferQueueRequest *> m_xfer_queue;
 	int m_max_uploads;   // 0 if unlimited
 	int m_max_downloads; // 0 if unlimited
 	time_t m_default_max_queue_age; // 0 if unlimited
+	SchedulingPolicy m_policy;
+
+		// moving average of the throughput (bytes/s) of finished transfers,
+		// used to estimate how long a waiting transfer will take
+	double m_upload_rate;
+	double m_download_rate;
 
 	bool m_throttle_disk_load;
 	double m_disk_load_low_throttle;
@@ -154,6 +166,11 @@ class TransferQueueManager: public Service {
 	stats_entry_ema<double> m_disk_throttle_excess;
 	stats_entry_ema<double> m_disk_throttle_shortfall;
 
+	stats_histogram<time_t> m_upload_wait_times;
+	stats_histogram<time_t> m_download_wait_times;
+	stats_histogram<int64_t> m_upload_rates;
+	stats_histogram<int64_t> m_download_rates;
+
 	unsigned int m_round_robin_counter; // increments each time we send GoAhead to a client
 
 	class TransferQueueUser {
@@ -186,6 +203,8 @@ class TransferQueueManager: public Service {
 	void CollectUserRecGarbage(ClassAd *unpublish_ad);
 	void ClearRoundRobinRecency();
 	void ClearTransferCounts();
+	double ResponseRatio(TransferQueueRequest *client,time_t now) const;
+	void TransferFinished(TransferQueueRequest *client);
 	void UpdateIOStats();
 	void IOStatsChanged();
 	void RegisterStats(char const *user,IOStats &iostats,bool unregister=false,ClassAd *unpublish_ad=NULL);
@@ -0,0 +1,210 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Report where the memory of running shadows goes.
+//
+// usage: condor_shadow_memory_report [pid ...]
+//
+// Reads /proc/<pid>/smaps for each of the given processes, or for every
+// condor_shadow on the machine if none are given, and prints how much of
+// each one's resident memory is shared with other processes and how much
+// is its own, with the private part split into the heap, other anonymous
+// mappings, file mappings (the data and relocations of the shadow and its
+// libraries) and the stack.  All sizes are in KiB.  The last line adds up
+// the proportional set sizes, which counts each shared page once, so it
+// is what the shadows really cost the machine.  Must be run as root
+// (or as the user the shadows run as) to read their smaps.
+
+#include "condor_common.h"
+
+#include "stl_string_utils.h"
+
+#include <string>
+#include <vector>
+
+enum Region { HEAP, ANON, FILE_MAP, STACK, OTHER, NUM_REGIONS };
+
+struct ShadowMemory {
+	pid_t pid;
+	long long rss;
+	long long pss;
+	long long shared;
+	long long priv[NUM_REGIONS];
+};
+
+static Region
+classify( char const *header )
+{
+		// the path, if any, comes after the address range, permissions,
+		// offset, device and inode
+	int path_offset = 0;
+	char range[64], perms[8], offset[32], dev[32];
+	unsigned long inode;
+	if( sscanf( header, "%63s %7s %31s %31s %lu %n",
+				range, perms, offset, dev, &inode, &path_offset ) < 5 ) {
+		return OTHER;
+	}
+	char const *path = header + path_offset;
+	if( *path == '\0' || *path == '\n' ) {
+		return ANON;
+	}
+	if( strncmp( path, "[heap]", 6 ) == 0 ) {
+		return HEAP;
+	}
+	if( strncmp( path, "[stack", 6 ) == 0 ) {
+		return STACK;
+	}
+	if( *path == '/' ) {
+		return FILE_MAP;
+	}
+	return OTHER;
+}
+
+static bool
+read_smaps( pid_t pid, ShadowMemory &mem )
+{
+	memset( &mem, 0, sizeof(mem) );
+	mem.pid = pid;
+
+	std::string path;
+	formatstr( path, "/proc/%d/smaps", (int)pid );
+	FILE *fp = fopen( path.c_str(), "r" );
+	if( !fp ) {
+		fprintf( stderr, "Can't open %s: %s\n", path.c_str(), strerror( errno ) );
+		return false;
+	}
+
+	char line[4096];
+	Region region = OTHER;
+	while( fgets( line, sizeof(line), fp ) ) {
+			// field lines are "Name:   value kB", mapping headers
+			// start with an address range
+		char const *space = strchr( line, ' ' );
+		if( space && space > line && space[-1] != ':' ) {
+			region = classify( line );
+			continue;
+		}
+		char name[64];
+		long long kb;
+		if( sscanf( line, "%63[^:]: %lld", name, &kb ) != 2 ) {
+			continue;
+		}
+		if( strcmp( name, "Rss" ) == 0 ) {
+			mem.rss += kb;
+		} else if( strcmp( name, "Pss" ) == 0 ) {
+			mem.pss += kb;
+		} else if( strcmp( name, "Shared_Clean" ) == 0 ||
+				   strcmp( name, "Shared_Dirty" ) == 0 ) {
+			mem.shared += kb;
+		} else if( strcmp( name, "Private_Clean" ) == 0 ||
+				   strcmp( name, "Private_Dirty" ) == 0 ) {
+			mem.priv[region] += kb;
+		}
+	}
+	fclose( fp );
+	return true;
+}
+
+static void
+find_shadows( std::vector<pid_t> &pids )
+{
+	DIR *dirp = opendir( "/proc" );
+	if( !dirp ) {
+		fprintf( stderr, "Can't open /proc: %s\n", strerror( errno ) );
+		return;
+	}
+	struct dirent *direntp;
+	while( (direntp = readdir( dirp )) != NULL ) {
+		if( !isdigit( direntp->d_name[0] ) ) {
+			continue;
+		}
+		std::string path;
+		formatstr( path, "/proc/%s/comm", direntp->d_name );
+		FILE *fp = fopen( path.c_str(), "r" );
+		if( !fp ) {
+			continue;
+		}
+		char comm[32] = "";
+		if( fgets( comm, sizeof(comm), fp ) &&
+			strcmp( comm, "condor_shadow\n" ) == 0 ) {
+			pids.push_back( atoi( direntp->d_name ) );
+		}
+		fclose( fp );
+	}
+	closedir( dirp );
+}
+
+int main( int argc, char *argv[] )
+{
+	std::vector<pid_t> pids;
+	for( int i = 1; i < argc; i++ ) {
+		pid_t pid = atoi( argv[i] );
+		if( pid <= 0 ) {
+			fprintf( stderr, "usage: %s [pid ...]\n", argv[0] );
+			return 1;
+		}
+		pids.push_back( pid );
+	}
+	if( pids.empty() ) {
+		find_shadows( pids );
+		if( pids.empty() ) {
+			fprintf( stderr, "No condor_shadow processes found\n" );
+			return 1;
+		}
+	}
+
+	printf( "%8s %9s %9s %9s %9s %9s %9s %9s %9s\n", "PID", "RSS", "PSS",
+			"SHARED", "PRIVATE", "HEAP", "ANON", "FILE", "STACK" );
+	ShadowMemory total;
+	memset( &total, 0, sizeof(total) );
+	int count = 0;
+	for( pid_t pid : pids ) {
+		ShadowMemory mem;
+		if( !read_smaps( pid, mem ) ) {
+			continue;
+		}
+		long long priv = 0;
+		for( int r = 0; r < NUM_REGIONS; r++ ) {
+			priv += mem.priv[r];
+			total.priv[r] += mem.priv[r];
+		}
+		total.rss += mem.rss;
+		total.pss += mem.pss;
+		total.shared += mem.shared;
+		count++;
+		printf( "%8d %9lld %9lld %9lld %9lld %9lld %9lld %9lld %9lld\n",
+				(int)pid, mem.rss, mem.pss, mem.shared, priv,
+				mem.priv[HEAP], mem.priv[ANON], mem.priv[FILE_MAP], mem.priv[STACK] );
+	}
+	if( count == 0 ) {
+		return 1;
+	}
+
+	long long priv = 0;
+	for( int r = 0; r < NUM_REGIONS; r++ ) {
+		priv += total.priv[r];
+	}
+	printf( "%8s %9lld %9lld %9lld %9lld %9lld %9lld %9lld %9lld\n", "AVERAGE",
+			total.rss / count, total.pss / count, total.shared / count, priv / count,
+			total.priv[HEAP] / count, total.priv[ANON] / count,
+			total.priv[FILE_MAP] / count, total.priv[STACK] / count );
+	printf( "%d shadows use %lld KiB (sum of PSS); %lld KiB of it private\n",
+			count, total.pss, priv );
+	return 0;
+}
@@ -37,6 +37,10 @@
 
 #include "strcasestr.h"
 
+#include <atomic>
+#include <system_error>
+#include <thread>
+
 
 ResMgr::ResMgr() :
 	extras_classad( NULL ),
@@ -47,7 +51,11 @@ ResMgr::ResMgr() :
 	config_classad = NULL;
 	up_tid = -1;
 	poll_tid = -1;
+	num_state_changes = 0;
 	m_cred_sweep_tid = -1;
+	m_adlist_refresh_tid = -1;
+	m_adlist_refresh_all = false;
+	m_adlist_refresh_update = false;
 
 	draining = false;
 	draining_is_graceful = false;
@@ -145,7 +153,7 @@ double ResMgr::Stats::BeginWalk(VoidResourceMember  /*memberfunc*/)
 double ResMgr::Stats::EndWalk(VoidResourceMember memberfunc, double before)
 {
     stats_recent_counter_timer * probe = &WalkOther;
-    if (memberfunc == &Resource::update) 
+    if (memberfunc == &Resource::update || memberfunc == &Resource::update_periodic)
        probe = &WalkUpdate;
     else if (memberfunc == &Resource::eval_state)
        probe = &WalkEvalState;
@@ -160,6 +168,9 @@ ResMgr::~ResMgr()
 	if( config_classad ) delete config_classad;
 	if( totals_classad ) delete totals_classad;
 	if( id_disp ) delete id_disp;
+	if( m_adlist_refresh_tid != -1 ) {
+		daemonCore->Cancel_Timer( m_adlist_refresh_tid );
+	}
 
 #if HAVE_BACKFILL
 	if( m_backfill_mgr ) {
@@ -724,6 +735,103 @@ ResMgr::walk( VoidResourceMember memberfunc )
 }
 
 
+	// set on the threads evaluating slot policy in parallel, where
+	// SlotEval() can't safely look at other slots
+static thread_local bool in_parallel_policy_eval = false;
+static thread_local bool parallel_policy_eval_refused = false;
+
+	// Functions registered from outside the ClassAd library, such as
+	// SlotEval(), userHome() or those from CLASSAD_USER_LIBS, may not
+	// be reentrant, so the worker threads refuse to call them.  The slot
+	// is then evaluated again on the main thread.
+static bool
+parallel_policy_eval_guard( const char * /*name*/ )
+{
+	if( in_parallel_policy_eval ) {
+		parallel_policy_eval_refused = true;
+		return false;
+	}
+	return true;
+}
+
+void
+ResMgr::walk_eval_state( void )
+{
+	if( policy_eval_threads <= 1 || nresources < 2 ) {
+		walk( &Resource::eval_state );
+		return;
+	}
+
+	double currenttime = stats.BeginWalk( &Resource::eval_state );
+
+		// As in walk(), eval_prefetched_state() can delete resources.
+	int ncache = nresources;
+	Resource **cache = new Resource*[ncache];
+	memcpy((void*)cache, (void*)resources, (sizeof(Resource*)*ncache));
+
+		// Everything that changes the slot ads happens here, before
+		// the worker threads start reading them.
+	for( int i = 0; i < ncache; i++ ) {
+		cache[i]->refresh_policy_attrs();
+	}
+
+		// Each slot's expressions are evaluated against only its own
+		// ads, so the slots can be handed out to threads in any order.
+	int nthreads = MIN( policy_eval_threads, ncache );
+	std::vector<classad::MatchClassAd> match_ads( nthreads );
+	std::atomic<int> next( 0 );
+	auto worker = [&]( classad::MatchClassAd *match_ad ) {
+		in_parallel_policy_eval = true;
+		int i;
+		while( (i = next++) < ncache ) {
+			parallel_policy_eval_refused = false;
+			cache[i]->prefetch_policy( *match_ad );
+			if( parallel_policy_eval_refused ) {
+					// it calls a registered function; evaluate it
+					// the usual way
+				cache[i]->clear_prefetched_policy();
+			}
+		}
+		in_parallel_policy_eval = false;
+	};
+	classad::FunctionCall::SetExternalFunctionGuard( parallel_policy_eval_guard );
+	std::vector<std::thread> threads;
+	for( int t = 1; t < nthreads; t++ ) {
+		try {
+			threads.emplace_back( worker, &match_ads[t] );
+		} catch( std::system_error &e ) {
+			dprintf( D_ALWAYS, "Failed to start policy evaluation thread: %s\n",
+					 e.what() );
+			break;
+		}
+	}
+	worker( &match_ads[0] );
+	for( auto &thread : threads ) {
+		thread.join();
+	}
+	classad::FunctionCall::SetExternalFunctionGuard( NULL );
+
+		// Evaluated one at a time, each slot would see the
+		// STARTD_SLOT_ATTRS of the slots before it as they are after
+		// those slots' state changes.  Once a slot has changed state,
+		// the values prefetched for the slots after it may be stale,
+		// so evaluate those the usual way.
+	unsigned int changes = num_state_changes;
+	for( int i = 0; i < ncache; i++ ) {
+		if( startd_slot_attrs && num_state_changes != changes ) {
+			cache[i]->clear_prefetched_policy();
+			cache[i]->eval_state();
+		} else {
+			cache[i]->eval_prefetched_state();
+		}
+	}
+
+	delete [] cache;
+
+	stats.EndWalk( &Resource::eval_state, currenttime );
+}
+
+
 void
 ResMgr::walk( ResourceMaskMember memberfunc, amask_t mask )
 {
@@ -806,6 +914,60 @@ ResMgr::adlist_publish( unsigned r_id, ClassAd *resAd, amask_t mask, const char
 }
 
 
+void
+ResMgr::adlist_refresh_soon( const char *name, const classad::References *changed, bool wants_update )
+{
+	if( ! changed ) {
+		m_adlist_refresh_all = true;
+		m_adlist_changes.clear();
+	} else if( ! m_adlist_refresh_all ) {
+		m_adlist_changes[name].insert( changed->begin(), changed->end() );
+	}
+	if( wants_update ) {
+		m_adlist_refresh_update = true;
+	}
+
+	if( m_adlist_refresh_tid == -1 ) {
+		int window = cron_job_mgr ? cron_job_mgr->getRefreshWindow() : 0;
+		m_adlist_refresh_tid = daemonCore->Register_Timer( window, 0,
+							(TimerHandlercpp)&ResMgr::adlist_refresh,
+							"ResMgr::adlist_refresh", this );
+	}
+}
+
+
+void
+ResMgr::adlist_refresh( void )
+{
+	m_adlist_refresh_tid = -1;
+
+	if( m_adlist_refresh_all ) {
+			// Resource::refresh_startd_cron_attrs() goes through
+			// adlist_publish() with A_PUBLIC | A_UPDATE, which is the
+			// (only) update we actually want.  We can't call it
+			// directly, because we need to update the internal ad for
+			// each Resource.
+		walk( &Resource::refresh_startd_cron_attrs );
+	} else if( ! m_adlist_changes.empty() ) {
+		walk( &Resource::refresh_startd_cron_changes );
+	}
+	m_adlist_refresh_all = false;
+	m_adlist_changes.clear();
+
+	if( m_adlist_refresh_update ) {
+		m_adlist_refresh_update = false;
+		update_all();
+	}
+}
+
+
+int
+ResMgr::adlist_publish_changes( unsigned r_id, ClassAd *resAd, const char * r_id_str )
+{
+	return extra_ads.PublishChanges( resAd, r_id, r_id_str, m_adlist_changes );
+}
+
+
 bool
 ResMgr::needsPolling( void )
 {
@@ -872,6 +1034,28 @@ ResMgr::getClaimById( const char* id )
 }
 
 
+void
+ResMgr::getClaimsById( std::unordered_map<std::string, Claim*> &claims_by_id )
+{
+	claims_by_id.clear();
+	if( ! resources ) {
+		return;
+	}
+		// in the order getClaimById() searches, so that the first
+		// claim added under an id is the one it would return
+	for( int i = 0; i < nresources; i++ ) {
+		Resource *rip = resources[i];
+		rip->r_cod_mgr->addClaimsById( claims_by_id );
+		if( rip->r_cur && rip->r_cur->id() ) {
+			claims_by_id.emplace( rip->r_cur->id(), rip->r_cur );
+		}
+		if( rip->r_pre && rip->r_pre->id() ) {
+			claims_by_id.emplace( rip->r_pre->id(), rip->r_pre );
+		}
+	}
+}
+
+
 Claim*
 ResMgr::getClaimByGlobalJobId( const char* id )
 {
@@ -1150,7 +1334,7 @@ ResMgr::send_update( int cmd, ClassAd* public_ad, ClassAd* private_ad,
 
 
 void
-ResMgr::update_all( void )
+ResMgr::update_all( bool periodic )
 {
 	num_updates = 0;
 
@@ -1172,12 +1356,12 @@ ResMgr::update_all( void )
 		// Evaluate the state change policy expressions (like PREEMPT)
 		// For certain changes this will trigger an update to the collector
 		// (all that really does is register a timer)
-	walk( &Resource::eval_state );
+	walk_eval_state();
 
 		// If we didn't update b/c of the eval_state, we need to
 		// actually do the update now. Tj 2020 sez: this is a lie, was it ever true?
 		// What this actually does is insure that the update timers have been registered for all slots
-	walk( &Resource::update );
+	walk( periodic ? &Resource::update_periodic : &Resource::update );
 
 	report_updates();
 	check_polling();
@@ -1192,7 +1376,7 @@ ResMgr::eval_and_update_all( void )
 	if ( !hibernating () ) {
 #endif
 		compute_dynamic(true);
-		update_all();
+		update_all(true);
 #if HAVE_HIBERNATION
 	}
 #endif
@@ -1207,7 +1391,7 @@ ResMgr::eval_all( void )
 #endif
 		num_updates = 0;
 		compute_dynamic(false);
-		walk( &Resource::eval_state );
+		walk_eval_state();
 		report_updates();
 		check_polling();
 #if HAVE_HIBERNATION
@@ -177,7 +177,9 @@ public:
 
 		// The first one is special, since we already computed
 		// everything and we don't need to recompute anything.
-	void	update_all( void );	
+		// A periodic update rebuilds only the slot ads whose inputs
+		// changed, besides the measurements of the machine.
+	void	update_all( bool periodic = false );
 	// These two functions walk through the array of rip pointers and
 	// call the specified function on each resource.  The first takes
 	// functions that take a rip as an arg.  The second takes Resource
@@ -186,6 +188,15 @@ public:
 	void	walk( VoidResourceMember );
 	void	walk( ResourceMaskMember, amask_t );
 
+	// Like walk( &Resource::eval_state ), but with the policy
+	// expressions of all slots evaluated in parallel, by
+	// STARTD_POLICY_EVAL_THREADS threads, before the state changes
+	// are made one slot at a time.
+	void	walk_eval_state( void );
+
+	// Called by every slot that changes state or activity.
+	void	state_changed( void ) { num_state_changes++; }
+
 	// This function walks through the array of rip pointers, calls
 	// the specified function on each one, sums the resulting return
 	// values, and returns the total.
@@ -207,6 +218,15 @@ public:
 	void	adlist_reset_monitors( unsigned r_id, ClassAd * forWhom );
 	void	adlist_unset_monitors( unsigned r_id, ClassAd * forWhom );
 
+		// Refresh the startd cron attributes in every slot, and update
+		// the collector if asked to, once the current
+		// STARTD_CRON_REFRESH_WINDOW is up.  changed names the
+		// attributes of the given ad that changed; NULL means every
+		// slot needs all of the ads merged in again.
+	void	adlist_refresh_soon( const char *name, const classad::References *changed, bool wants_update );
+	void	adlist_refresh( void );
+	int		adlist_publish_changes( unsigned r_id, ClassAd *resAd, const char * r_id_str );
+
 	// Methods to control various timers
 	void	check_polling( void );	// See if we need to poll frequently
 	int		start_sweep_timer(void); // Timer for sweeping SEC_CREDENTIAL_DIRECTORY
@@ -222,6 +242,9 @@ public:
 
 	Claim*		getClaimByPid( pid_t );	// Find Claim by pid of starter
 	Claim*		getClaimById( const char* id );	// Find Claim by ClaimId
+		// Map every claim to its ClaimId, for looking up many at once;
+		// each id maps to the claim getClaimById() would find.
+	void		getClaimsById( std::unordered_map<std::string, Claim*> &claims_by_id );
 	Claim*		getClaimByGlobalJobId( const char* id );
 	Claim*		getClaimByGlobalJobIdAndId( const char *claimId,
 											const char *job_id);
@@ -354,9 +377,16 @@ private:
 	bool 		is_shutting_down;
 
 	int		num_updates;
+	unsigned int	num_state_changes;
 	int		up_tid;		// DaemonCore timer id for update timer
 	int		poll_tid;	// DaemonCore timer id for polling timer
 	int		m_cred_sweep_tid;	// DaemonCore timer id for polling timer
+	int		m_adlist_refresh_tid;	// DaemonCore timer id for startd cron refresh
+
+		// what the next startd cron refresh has to do
+	bool	m_adlist_refresh_all;
+	bool	m_adlist_refresh_update;
+	std::map<std::string, classad::References> m_adlist_changes;
 	time_t	startTime;		// Time that we started
 	time_t	cur_time;		// current time
 
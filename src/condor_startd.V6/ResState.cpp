@@ -100,6 +100,11 @@ ResState::change( State new_state, Activity new_act )
 		return;   // If we're not changing anything, return
 	}
 
+		// Policy values evaluated ahead of time were for the state
+		// we are leaving.
+	rip->clear_prefetched_policy();
+	resmgr->state_changed();
+
 		// leave_action and enter_action return TRUE if they result in
 		// a state or activity change.  In these cases, we want to
 		// abort the current state change.
@@ -310,12 +310,17 @@ Resource::Resource( CpuAttributes* cap, int rid, bool multiple_slots, Resource*
 	r_no_collector_updates = SlotType::type_param_boolean(cap, "HIDDEN", false);
 
 	update_tid = -1;
+	r_dirty_inputs = DIRTY_ALL;
+	r_update_ad_built = 0;
+	r_update_ad_derived = false;
+	r_update_ad_sent_size = 0;
 
 	r_cpu_busy = 0;
 	r_cpu_busy_start_time = 0;
 	r_last_compute_condor_load = resmgr->now();
 	r_suspended_for_cod = false;
 	r_hack_load_for_cod = false;
+	r_policy_prefetched = false;
 	r_cod_load_hack_tid = -1;
 	r_pre_cod_total_load = -1.0;
 	r_pre_cod_condor_load = 0.0;
@@ -966,6 +971,9 @@ Resource::starterExited( Claim* cur_claim )
 		}
 		else {
 			change_state( idle_act );
+			if( r_cur && r_cur->hasHeldActivation() ) {
+				r_cur->releaseHeldActivation();
+			}
 		}
 		break;
 	case preempting_state:
@@ -1245,6 +1253,7 @@ Resource::init_classad( void )
 	// this catches all state updates
 	r_classad = new ClassAd();
 	r_classad->ChainToAd(r_config_classad);
+	mark_dirty(DIRTY_ALL);
 
 		// put in slottype overrides of the config_classad
 	this->publish_slot_config_overrides(r_config_classad);
@@ -1292,6 +1301,14 @@ Resource::benchmarks_finished( void )
 
 void
 Resource::eval_state( void )
+{
+	refresh_policy_attrs();
+	r_state->eval_policy();
+};
+
+
+void
+Resource::refresh_policy_attrs( void )
 {
 	// we may need to modify the load average in our internal
 	// policy classad if we're currently running a COD job or have
@@ -1303,9 +1320,113 @@ Resource::eval_state( void )
 	// before we evaluate our state, we should refresh cross-slot attrs
 	//PRAGMA_REMIND("tj: revisit this with SlotEval?")
 	resmgr->publishSlotAttrs( r_classad );
+}
+
+
+	// Evaluate a policy expression as EvalBool() does, once my and
+	// target are in a match ad, but without logging or param(), so that
+	// it is safe to call from a worker thread.  Returns -1 if undefined.
+static int
+prefetch_expr( ClassAd *my, ClassAd *target, const char *name )
+{
+	bool value = false;
+	if( my->Lookup( name ) ) {
+		if( my->EvaluateAttrBoolEquiv( name, value ) ) {
+			return value ? 1 : 0;
+		}
+	} else if( target && target->Lookup( name ) ) {
+		if( target->EvaluateAttrBoolEquiv( name, value ) ) {
+			return value ? 1 : 0;
+		}
+	}
+	return -1;
+}
 
+
+void
+Resource::prefetch_policy( classad::MatchClassAd &match_ad )
+{
+	for( int i = 0; i < NUM_POLICY_EXPRS; i++ ) {
+		r_policy_values[i] = -1;
+	}
+
+		// The shared match ad behind EvalBool() can't be used off the
+		// main thread, so each worker thread brings its own.
+	int universe = r_cur ? r_cur->universe() : 0;
+	ClassAd *job_ad = r_cur ? r_cur->ad() : NULL;
+	if( job_ad == r_classad ) {
+		job_ad = NULL;
+	}
+	if( job_ad ) {
+		match_ad.ReplaceLeftAd( r_classad );
+		match_ad.ReplaceRightAd( job_ad );
+	}
+
+		// same lookup order as eval_expr() with check_vanilla
+	auto eval = [&]( const char *name, bool check_vanilla ) -> int {
+		int rval = -1;
+		if( check_vanilla && universe == CONDOR_UNIVERSE_VANILLA ) {
+			std::string vanilla_name( name );
+			vanilla_name += "_VANILLA";
+			rval = prefetch_expr( r_classad, job_ad, vanilla_name.c_str() );
+		} else if( check_vanilla && universe == CONDOR_UNIVERSE_VM ) {
+			std::string vm_name( name );
+			vm_name += "_VM";
+			rval = prefetch_expr( r_classad, job_ad, vm_name.c_str() );
+		}
+		if( rval < 0 ) {
+			rval = prefetch_expr( r_classad, job_ad, name );
+		}
+		return rval;
+	};
+
+		// only what eval_policy() will look at in our current state
+	switch( state() ) {
+	case claimed_state:
+		r_policy_values[POLICY_WANT_SUSPEND] = eval( "WANT_SUSPEND", true );
+		r_policy_values[POLICY_PREEMPT] = eval( "PREEMPT", true );
+		r_policy_values[POLICY_SUSPEND] = eval( "SUSPEND", true );
+		r_policy_values[POLICY_CONTINUE] = eval( "CONTINUE", true );
+		r_policy_values[POLICY_START] = eval( "START", false );
+		break;
+	case preempting_state:
+		r_policy_values[POLICY_KILL] = eval( "KILL", true );
+		break;
+	case unclaimed_state:
+	case owner_state:
+		r_policy_values[POLICY_IS_OWNER] = eval( ATTR_IS_OWNER, false );
+		break;
+	default:
+		break;
+	}
+
+	if( job_ad ) {
+		match_ad.RemoveLeftAd();
+		match_ad.RemoveRightAd();
+	}
+	r_policy_prefetched = true;
+}
+
+
+void
+Resource::eval_prefetched_state( void )
+{
 	r_state->eval_policy();
-};
+	r_policy_prefetched = false;
+}
+
+
+bool
+Resource::prefetched_policy( PolicyExpr which, int &value )
+{
+	if( ! r_policy_prefetched || r_policy_values[which] < 0 ) {
+			// undefined values are evaluated again, so that they are
+			// logged (or fatal) just as before
+		return false;
+	}
+	value = r_policy_values[which];
+	return true;
+}
 
 
 void
@@ -1319,11 +1440,28 @@ Resource::reconfig( void )
 	}
 	m_hook_keyword_initialized = false;
 #endif /* HAVE_JOB_HOOKS */
+	mark_dirty( DIRTY_RESOURCES );
 }
 
 
+	// Something about the slot besides its measurements changed, so
+	// the next update rebuilds the slot ad.
 void
 Resource::update( void )
+{
+	mark_dirty( DIRTY_CLAIM );
+	queue_update();
+}
+
+void
+Resource::update_periodic( void )
+{
+	mark_dirty( DIRTY_LOAD );
+	queue_update();
+}
+
+void
+Resource::queue_update( void )
 {
 	if (r_no_collector_updates)
 		return;
@@ -1354,9 +1492,11 @@ Resource::update( void )
 // Process SlotEval and StartdCron aggregation
 // inject attributes that the update ad needs to see, but that are not necessarily configured
 //
-void
+bool
 Resource::process_update_ad(ClassAd & public_ad, int snapshot) // change the update ad before we send it 
 {
+	bool derived = false;
+
 	// this special unparser works only in the Startd.
 	// it evaluates SlotEval as it unparses
 	classad::SlotEvalUnParser unparser(&public_ad);
@@ -1379,6 +1519,7 @@ Resource::process_update_ad(ClassAd & public_ad, int snapshot) // change the upd
 		// flatten that function and write the flattened expression into the ad
 		//
 		if (ExprHasSlotEval(i->second)) {
+			derived = true;
 			unparse_buffer.clear();
 			if (ExprTreeIsSlotEval(i->second)) {
 				// if the entire expression is a single SlotEval call, just flatten it
@@ -1412,6 +1553,7 @@ Resource::process_update_ad(ClassAd & public_ad, int snapshot) // change the upd
 		// some other startd cron job).
 		//
 		if( name.find( "Uptime" ) == 0 ) {
+			derived = true;
 			std::string resourceName;
 			if( StartdCronJobParams::attributeIsPeakMetric( name ) ) {
 				// Convert Uptime<Resource>PeakUsage to
@@ -1453,6 +1595,7 @@ Resource::process_update_ad(ClassAd & public_ad, int snapshot) // change the upd
 			public_ad.Assign( computedName, average );
 
 		} else if (name.find("StartOfJob") == 0) {
+			derived = true;
 
 			// Compute the SUM metrics' *Usage values.  The PEAK metrics
 			// have already inserted their *Usage values into the ad.
@@ -1513,6 +1656,39 @@ Resource::process_update_ad(ClassAd & public_ad, int snapshot) // change the upd
 	if ( ! public_ad.Lookup(ATTR_RANK)) {
 		public_ad.Assign(ATTR_RANK, 0);
 	}
+	return derived;
+}
+
+	// Does the ad we sent last have to be built again from scratch?
+bool
+Resource::update_needs_rebuild( time_t now )
+{
+	int interval = param_integer( "STARTD_FULL_UPDATE_INTERVAL", 0, 0 );
+	if( interval <= 0 || ! r_update_ad_built || now - r_update_ad_built >= interval ) {
+		return true;
+	}
+	if( (r_dirty_inputs & ~DIRTY_LOAD) || r_update_ad_derived ) {
+		return true;
+	}
+		// our address can change under us, e.g. when we reconnect to CCB
+	std::string addr;
+	const char * sinful = daemonCore->InfoCommandSinfulString();
+	return ! r_update_ad.LookupString( ATTR_STARTD_IP_ADDR, addr ) || ! sinful || addr != sinful;
+}
+
+	// Only the measurements (load, idle times, disk, and so on) changed
+	// since the update ad was built, so refresh the attributes that
+	// depend on them and leave the config, resource, and cron
+	// attributes as they are.
+void
+Resource::refresh_update_ad( void )
+{
+	r_attr->publish_static( &r_update_ad );	// virtual memory is recomputed for each update
+	publish_dynamic( &r_update_ad, true );
+	resmgr->publishSlotAttrs( &r_update_ad );
+	if( vmapi_is_usable_for_condor() == FALSE ) {
+		r_update_ad.Assign( ATTR_START, false );
+	}
 }
 
 void
@@ -1520,10 +1696,26 @@ Resource::do_update( void )
 {
 	int rval;
 	ClassAd private_ad;
-	ClassAd public_ad;
 
 	// Get the public and private ads
-	publish_single_slot_ad(public_ad, 0, Resource::Purpose::for_update);
+	time_t now = time( NULL );
+	bool refreshed = false;
+	if( update_needs_rebuild( now ) ) {
+		r_update_ad.Clear();
+		r_update_ad.DisableDirtyTracking();
+		r_update_ad_derived = publish_single_slot_ad( r_update_ad, 0, Resource::Purpose::for_update );
+		r_update_ad_built = now;
+	} else {
+			// mark what we refresh, so that a delta update need only
+			// carry those attributes
+		dprintf( D_FULLDEBUG, "Only measurements changed, refreshing them in the update ad\n" );
+		r_update_ad.ClearAllDirtyFlags();
+		r_update_ad.EnableDirtyTracking();
+		refresh_update_ad();
+		refreshed = true;
+	}
+	r_dirty_inputs = 0;
+	ClassAd & public_ad = r_update_ad;
 
 		// refresh the machine ad in the job sandbox
 	refresh_sandbox_ad(&public_ad);
@@ -1537,8 +1729,15 @@ Resource::do_update( void )
 #endif
 
 		// Send class ads to collector(s)
-	rval = resmgr->send_update( UPDATE_STARTD_AD, &public_ad,
-								&private_ad, true );
+	ClassAd delta_ad;
+	if( refreshed && make_delta_update_ad( delta_ad ) ) {
+		rval = resmgr->send_update( UPDATE_STARTD_AD_DELTA, &delta_ad,
+									NULL, true );
+	} else {
+		rval = resmgr->send_update( UPDATE_STARTD_AD, &public_ad,
+									&private_ad, true );
+		r_update_ad_sent_size = public_ad.size();
+	}
 	if( rval ) {
 		dprintf( D_FULLDEBUG, "Sent update to %d collector(s)\n", rval );
 	} else {
@@ -1550,11 +1749,47 @@ Resource::do_update( void )
 	update_tid = -1;
 }
 
+// Build a delta update for an update ad in which only the measurements
+// were refreshed: the attributes refresh_update_ad() set, which are all
+// of the ones that may have changed since the ad was last sent whole, so
+// a lost (UDP) delta is made good by the next one.  We send the ad whole
+// instead if it has gained or lost an attribute since then, since a
+// merge can't remove one.  With UPDATE_COLLECTOR_WITH_DELTAS, DCCollector
+// sends the versioned deltas of the generic protocol instead; a merge it
+// doesn't know about would leave its copy of our ad out of date.
+bool
+Resource::make_delta_update_ad( ClassAd & delta_ad )
+{
+	if( ! param_boolean( "STARTD_SEND_DELTA_UPDATES", false ) ||
+		param_boolean( "UPDATE_COLLECTOR_WITH_DELTAS", false ) ||
+		r_update_ad.size() != r_update_ad_sent_size )
+	{
+		return false;
+	}
+
+	for( auto it = r_update_ad.dirtyBegin(); it != r_update_ad.dirtyEnd(); ++it ) {
+		CopyAttribute( *it, delta_ad, r_update_ad );
+	}
+
+		// The collector needs these to find the ad to merge into.
+	CopyAttribute( ATTR_MY_TYPE, delta_ad, r_update_ad );
+	CopyAttribute( ATTR_TARGET_TYPE, delta_ad, r_update_ad );
+	CopyAttribute( ATTR_NAME, delta_ad, r_update_ad );
+	CopyAttribute( ATTR_MACHINE, delta_ad, r_update_ad );
+	CopyAttribute( ATTR_MY_ADDRESS, delta_ad, r_update_ad );
+	CopyAttribute( ATTR_STARTD_IP_ADDR, delta_ad, r_update_ad );
+
+	dprintf( D_FULLDEBUG, "Sending %d of %d attributes as a delta update\n",
+			 (int)delta_ad.size(), (int)r_update_ad.size() );
+	return true;
+}
+
 // build a slot ad from whole cloth, used for updating the collector, etc
 // it is an ERROR to pass r_classad as input ad here!!
-void Resource::publish_single_slot_ad(ClassAd & ad, time_t cur_time, Purpose purpose)
+bool Resource::publish_single_slot_ad(ClassAd & ad, time_t cur_time, Purpose purpose)
 {
 	ASSERT(&ad != r_classad && &ad != r_config_classad);
+	bool derived = false;
 
 	publish_static(&ad);
 	publish_dynamic(&ad, true);
@@ -1565,26 +1800,26 @@ void Resource::publish_single_slot_ad(ClassAd & ad, time_t cur_time, Purpose pur
 	case Purpose::for_update:
 		if (is_partitionable_slot()) { publishDynamicChildSummaries(&ad); }
 		resmgr->publishSlotAttrs(&ad);
-		process_update_ad(ad);
+		derived = process_update_ad(ad);
 		break;
 	case Purpose::for_cod:
 	case Purpose::for_req_claim:
 		if (is_partitionable_slot()) { publishDynamicChildSummaries(&ad); }
 		resmgr->publishSlotAttrs(&ad);
-		process_update_ad(ad);
+		derived = process_update_ad(ad);
 		break;
 	case Purpose::for_workfetch:
 		if (is_partitionable_slot()) { publishDynamicChildSummaries(&ad); }
 		resmgr->publishSlotAttrs(&ad);
-		process_update_ad(ad);
+		derived = process_update_ad(ad);
 		break;
 	case Purpose::for_query:
 		if (is_partitionable_slot()) { publishDynamicChildSummaries(&ad); }
 		resmgr->publishSlotAttrs(&ad);
-		process_update_ad(ad);
+		derived = process_update_ad(ad);
 		break;
 	case Purpose::for_snap:
-		process_update_ad(ad);
+		derived = process_update_ad(ad);
 		break;
 	}
 
@@ -1594,6 +1829,7 @@ void Resource::publish_single_slot_ad(ClassAd & ad, time_t cur_time, Purpose pur
 		ad.Assign( ATTR_START, false );
 	}
 
+	return derived;
 }
 
 
@@ -1626,6 +1862,9 @@ Resource::final_update( void )
 #endif
 
 	resmgr->send_update( INVALIDATE_STARTD_ADS, &invalidate_ad, NULL, false );
+
+		// anything we send after this has to be a full update
+	r_update_ad_built = 0;
 }
 
 
@@ -1850,6 +2089,11 @@ Resource::wants_vacate( void )
 int
 Resource::wants_suspend( void )
 {
+	int prefetched;
+	if( prefetched_policy( POLICY_WANT_SUSPEND, prefetched ) ) {
+		return prefetched;
+	}
+
 	bool want_suspend;
 	bool unknown = true;
 	if( r_cur->universe() == CONDOR_UNIVERSE_VANILLA ) {
@@ -2242,6 +2486,10 @@ Resource::evaluateHibernate( std::string &state_str ) const
 int
 Resource::eval_kill()
 {
+	int prefetched;
+	if( prefetched_policy( POLICY_KILL, prefetched ) ) {
+		return prefetched;
+	}
 	return eval_expr( "KILL", false, true );
 }
 
@@ -2249,6 +2497,10 @@ Resource::eval_kill()
 int
 Resource::eval_preempt( void )
 {
+	int prefetched;
+	if( prefetched_policy( POLICY_PREEMPT, prefetched ) ) {
+		return prefetched;
+	}
 	return eval_expr( "PREEMPT", false, true );
 }
 
@@ -2256,6 +2508,10 @@ Resource::eval_preempt( void )
 int
 Resource::eval_suspend( void )
 {
+	int prefetched;
+	if( prefetched_policy( POLICY_SUSPEND, prefetched ) ) {
+		return prefetched;
+	}
 	return eval_expr( "SUSPEND", false, true );
 }
 
@@ -2263,6 +2519,10 @@ Resource::eval_suspend( void )
 int
 Resource::eval_continue( void )
 {
+	int prefetched;
+	if( !m_bUserSuspended && prefetched_policy( POLICY_CONTINUE, prefetched ) ) {
+		return prefetched;
+	}
 	return (m_bUserSuspended)?false:eval_expr( "CONTINUE", false, true );
 }
 
@@ -2273,6 +2533,11 @@ Resource::eval_is_owner( void )
 	if( vmapi_is_usable_for_condor() == FALSE )
 		return 1;
 
+	int prefetched;
+	if( prefetched_policy( POLICY_IS_OWNER, prefetched ) ) {
+		return prefetched;
+	}
+
 	// fatal if undefined, don't check vanilla
 	return eval_expr( ATTR_IS_OWNER, true, false );
 }
@@ -2284,6 +2549,11 @@ Resource::eval_start( void )
 	if( vmapi_is_usable_for_condor() == FALSE )
 		return 0;
 
+	int prefetched;
+	if( prefetched_policy( POLICY_START, prefetched ) ) {
+		return prefetched;
+	}
+
 	// -1 if undefined, don't check vanilla
 	return eval_expr( "START", false, false );
 }
@@ -2359,6 +2629,7 @@ Resource::hardkill_backfill( void )
 #endif /* HAVE_BACKFILL */
 
 void Resource::refresh_draining_attrs() {
+	mark_dirty(DIRTY_CLAIM);
 	// this needs to refresh 
 	if (r_classad) {
 		r_classad->InsertAttr( "AcceptedWhileDraining", m_acceptedWhileDraining );
@@ -2370,11 +2641,18 @@ void Resource::refresh_draining_attrs() {
 	}
 }
 void Resource::refresh_startd_cron_attrs() {
+	mark_dirty(DIRTY_CRON);
 	if (r_classad) {
 		// Publish the supplemental Class Ads IS_UPDATE
 		resmgr->adlist_publish( r_id, r_classad, A_PUBLIC | A_UPDATE, r_id_str );
 	}
 }
+void Resource::refresh_startd_cron_changes() {
+	mark_dirty(DIRTY_CRON);
+	if (r_classad) {
+		resmgr->adlist_publish_changes( r_id, r_classad, r_id_str );
+	}
+}
 
 void Resource::refresh_classad_slot_attrs() {
 	if (r_classad) {
@@ -2528,6 +2806,7 @@ void Resource::publish_static(ClassAd* cap)
 		case PARTITIONABLE_SLOT:
 			cap->Assign(ATTR_SLOT_PARTITIONABLE, true);
 			cap->Assign(ATTR_SLOT_TYPE, "Partitionable");
+			publishFragmentationScore(cap);
 			break;
 		case DYNAMIC_SLOT:
 			cap->Assign(ATTR_SLOT_DYNAMIC, true);
@@ -2710,6 +2989,7 @@ Resource::publish_dynamic(ClassAd* cap, bool /*for_update*/)
 
 // called when the resource bag of a slot has changed (p-slot or coalesced slot)
 void Resource::refresh_classad_resources() {
+	mark_dirty(DIRTY_RESOURCES);
 	if (r_classad) {
 		// Put in cpu-specific attributes (A_STATIC, A_UPDATE, A_TIMEOUT)
 		r_attr->publish_static(r_config_classad);
@@ -2870,6 +3150,43 @@ Resource::publish_private( ClassAd *ad )
 	}
 }
 
+	// The fraction of this p-slot's resources that have been carved off
+	// into dynamic slots, averaged over the resources it has any of: 0
+	// for an untouched p-slot, approaching 1 as it fills up.  It is an
+	// expression rather than a value so that it follows Cpus, Memory and
+	// so on as the negotiator hands out the p-slot within a cycle.
+void
+Resource::publishFragmentationScore(ClassAd *cap)
+{
+	std::vector<std::string> resources = { ATTR_CPUS, ATTR_MEMORY };
+	for (auto j = r_attr->get_slotres_map().begin(); j != r_attr->get_slotres_map().end(); ++j) {
+		resources.push_back(j->first);
+	}
+
+	std::string free_sum;
+	int num_resources = 0;
+	for (auto j = resources.begin(); j != resources.end(); ++j) {
+		std::string total_attr = ATTR_TOTAL_SLOT_PREFIX + *j;
+		double total = 0;
+		if ( ! cap->LookupFloat(total_attr, total) || total <= 0) {
+			continue;
+		}
+		if ( ! free_sum.empty()) {
+			free_sum += " + ";
+		}
+		formatstr_cat(free_sum, "%s / %s", j->c_str(), total_attr.c_str());
+		num_resources++;
+	}
+	if ( ! num_resources) {
+		cap->Delete(ATTR_FRAGMENTATION_SCORE);
+		return;
+	}
+
+	std::string expr;
+	formatstr(expr, "1.0 - (%s) / %d", free_sum.c_str(), num_resources);
+	cap->AssignExpr(ATTR_FRAGMENTATION_SCORE, expr.c_str());
+}
+
 std::string
 Resource::makeChildClaimIds() {
 		std::string attrValue = "{";
@@ -136,6 +136,16 @@ public:
 	// refresh ad and evaluate state change policy
 	void	eval_state(void);
 
+		// eval_state() split up so that the policy expressions of
+		// all slots can be evaluated in parallel.  Only
+		// prefetch_policy() may be called off the main thread; it
+		// evaluates the expressions eval_policy() will want, so that
+		// eval_prefetched_state() can use their values.
+	void	refresh_policy_attrs( void );
+	void	prefetch_policy( classad::MatchClassAd &match_ad );
+	void	eval_prefetched_state( void );
+	void	clear_prefetched_policy( void ) { r_policy_prefetched = false; }
+
 		// does this resource need polling frequency for compute/eval?
 	bool	needsPolling( void );
 	bool	hasOppClaim( void );
@@ -183,7 +193,8 @@ public:
 	// publish a full ad for update or writing to disk etc
 	// do NOT pass r_classad into this function!!
 	typedef enum _purpose { for_update, for_req_claim, for_cod, for_workfetch, for_query, for_snap } Purpose;
-	void    publish_single_slot_ad(ClassAd & ad, time_t cur_time, Purpose perp);
+	// returns true if the ad has attributes computed from other slots or from the time
+	bool    publish_single_slot_ad(ClassAd & ad, time_t cur_time, Purpose perp);
 
 	void    publish_private( ClassAd *ad );
     void	publishDeathTime( ClassAd* cap );
@@ -278,12 +289,25 @@ public:
 	void	refresh_classad_slot_attrs(); // refresh cross-slot attrs into r_classad
 	void	refresh_draining_attrs();    // specialized refresh for changes caused by draining
 	void	refresh_startd_cron_attrs(); // got startd cron updates, refresh now
+	void	refresh_startd_cron_changes(); // merge in only what changed
 	void	reconfig( void );
 	void	publish_slot_config_overrides(ClassAd * cad);
 
+		// The inputs of the slot ad, so that an update can tell
+		// which of them changed since the ad was last built.
+	enum DirtyInput {
+		DIRTY_LOAD		= 0x01,	// load, idle times, disk and other measurements
+		DIRTY_CLAIM		= 0x02,	// state, activity, claims and jobs
+		DIRTY_CRON		= 0x04,	// STARTD_CRON output
+		DIRTY_RESOURCES	= 0x08,	// slot resources, machine attributes and config
+		DIRTY_ALL		= 0x0f
+	};
+	void	mark_dirty( unsigned inputs ) { r_dirty_inputs |= inputs; }
+
 	void	update( void );		// Schedule to update the central manager.
+	void	update_periodic( void );	// Ditto, when only the measurements may have changed
 	void	do_update( void );			// Actually update the CM
-	void    process_update_ad(ClassAd & ad, int snapshot=0); // change the update ad before we send it 
+	bool    process_update_ad(ClassAd & ad, int snapshot=0); // change the update ad before we send it 
     int     update_with_ack( void );    // Actually update the CM and wait for an ACK
 	void	final_update( void );		// Send a final update to the CM
 									    // with Requirements = False.
@@ -400,6 +424,7 @@ public:
     Resource* get_parent() { return m_parent; }
 
 	std::string makeChildClaimIds();
+	void publishFragmentationScore(ClassAd *cap);
 	void add_dynamic_child(Resource *rip) { m_children.insert(rip); }
 	void remove_dynamic_child(Resource *rip) {m_children.erase(rip); }
 
@@ -421,6 +446,18 @@ private:
 
 	int			update_tid;	// DaemonCore timer id for update delay
 
+		// The public ad as last sent to the collector, which is rebuilt
+		// only when an input other than DIRTY_LOAD has changed.
+	unsigned	r_dirty_inputs;
+	ClassAd		r_update_ad;
+	time_t		r_update_ad_built;		// when r_update_ad was last built in full
+	bool		r_update_ad_derived;	// r_update_ad has attributes computed from other slots or the time
+	size_t		r_update_ad_sent_size;	// attributes in r_update_ad when it was last sent whole
+	void		queue_update( void );
+	bool		update_needs_rebuild( time_t now );
+	void		refresh_update_ad( void );
+	bool		make_delta_update_ad( ClassAd & delta_ad );
+
 	int		r_cpu_busy;
 	time_t	r_cpu_busy_start_time;
 	time_t	r_last_compute_condor_load;
@@ -434,6 +471,20 @@ private:
 	void	endCODLoadHack( void );
 	int		eval_expr( const char* expr_name, bool fatal, bool check_vanilla );
 
+	enum PolicyExpr {
+		POLICY_START,
+		POLICY_IS_OWNER,
+		POLICY_PREEMPT,
+		POLICY_SUSPEND,
+		POLICY_CONTINUE,
+		POLICY_KILL,
+		POLICY_WANT_SUSPEND,
+		NUM_POLICY_EXPRS
+	};
+	bool	r_policy_prefetched;
+	int		r_policy_values[NUM_POLICY_EXPRS];	// -1 if not defined
+	bool	prefetched_policy( PolicyExpr which, int &value );
+
 	MyString m_execute_dir;
 	MyString m_execute_partition_id;
 
@@ -70,6 +70,8 @@ Claim::Claim( Resource* res_ip, ClaimType claim_type, int lease_duration )
 	, c_match_tid(-1)
 	, c_lease_tid(-1)
 	, c_sendalive_tid(-1)
+	, c_held_activation(NULL)
+	, c_held_activation_tid(-1)
 	, c_alive_inprogress_sock(NULL)
 	, c_lease_duration(lease_duration)
 	, c_aliveint(-1)
@@ -126,6 +128,19 @@ Claim::~Claim()
 		// Cancel any daemonCore events associated with this claim
 	this->cancel_match_timer();
 	this->cancelLeaseTimer();
+	if( c_held_activation_tid != -1 ) {
+		daemonCore->Cancel_Timer( c_held_activation_tid );
+		c_held_activation_tid = -1;
+	}
+	if( c_held_activation ) {
+			// the claim is going away, so the activation can't happen
+		dprintf( D_ALWAYS, "Claim %s going away, refusing held "
+				 "activate claim request.\n", publicClaimId() );
+		c_held_activation->end_of_message();
+		reply( c_held_activation, NOT_OK );
+		delete c_held_activation;
+		c_held_activation = NULL;
+	}
 	if ( c_alive_inprogress_sock ) {
 		daemonCore->Cancel_Socket(c_alive_inprogress_sock);
 		c_alive_inprogress_sock = NULL;
@@ -2003,6 +2018,68 @@ Claim::finishDeactivateCmd( void )
 }
 
 
+void
+Claim::holdActivation( Stream* stream )
+{
+	if( c_held_activation ) {
+		EXCEPT( "Claim::holdActivation() called with an activation "
+				"already held" );
+	}
+	c_held_activation = stream;
+	c_held_activation_tid =
+		daemonCore->Register_Timer( activation_wait_time, 0,
+				(TimerHandlercpp)&Claim::finishHeldActivation,
+				"Claim::finishHeldActivation", this );
+	if( c_held_activation_tid == -1 ) {
+		EXCEPT( "Couldn't register timer (out of memory)." );
+	}
+}
+
+
+void
+Claim::releaseHeldActivation( void )
+{
+	if( c_held_activation_tid != -1 ) {
+		daemonCore->Reset_Timer( c_held_activation_tid, 0 );
+	}
+}
+
+
+void
+Claim::finishHeldActivation( void )
+{
+	Stream* stream = c_held_activation;
+	c_held_activation = NULL;
+	c_held_activation_tid = -1;
+	if( ! stream ) {
+		return;
+	}
+
+	if( c_rip->r_cur == this && c_rip->state() == claimed_state &&
+		c_rip->activity() == idle_act )
+	{
+		c_rip->dprintf( D_ALWAYS, "Starter exited, finishing held "
+						"activate claim request.\n" );
+		activate_claim( c_rip, stream );
+	} else {
+			// The starter is still around, so give the shadow the
+			// same answer it would have gotten without waiting.
+		int code = isDeactivating() ? CONDOR_TRY_AGAIN : NOT_OK;
+		c_rip->dprintf( D_ALWAYS, "Starter still alive after %d seconds, "
+						"telling shadow %s.\n", activation_wait_time,
+						code == CONDOR_TRY_AGAIN ? "to try again later" :
+						"the activation failed" );
+		stream->end_of_message();
+		reply( stream, code );
+	}
+
+		// DaemonCore's not going to delete this stream for us, since
+		// the command handler kept it.  The starter, if any, has
+		// inherited its own copy by now.
+	delete stream;
+}
+
+
 void
 Claim::resetClaim( void )
 {
@@ -285,6 +285,18 @@ public:
 	int	 finishPendingCmd( void );
 	void changeState( ClaimState s );
 
+		/** Hold an ACTIVATE_CLAIM request that arrived while the
+			previous starter on this claim was still exiting, rather
+			than making the shadow retry or give up.  The request is
+			finished once the starter is gone, or refused as before if
+			that takes longer than STARTD_ACTIVATION_WAIT_TIME.  We
+			take ownership of the stream.
+		*/
+	void holdActivation( Stream* stream );
+	bool hasHeldActivation() const {return c_held_activation != NULL;};
+		/// Finish the held activation once we're back in the event loop
+	void releaseHeldActivation( void );
+
 
 		/** Write out the request's ClassAd to the given file
 			descriptor.  This is used in the COD world to write the
@@ -344,6 +356,9 @@ private:
 		*/
 	int			c_lease_tid;
 	int			c_sendalive_tid;
+	Stream*		c_held_activation;	// ACTIVATE_CLAIM waiting for the
+									// previous starter to exit
+	int			c_held_activation_tid;
 	Sock*		c_alive_inprogress_sock;	// NULL if no alive in progress
 	int			c_lease_duration; // Duration of our claim/job lease
 	int			c_aliveint;		// Alive interval for this claim
@@ -371,6 +386,7 @@ private:
 
 		// Helper methods
 	int  finishReleaseCmd( void );
+	void finishHeldActivation( void );
 	int  finishDeactivateCmd( void );
 	int  finishKillClaim( void );
 
@@ -81,6 +81,19 @@ CODMgr::findClaimById( const char* id )
 }
 
 
+void
+CODMgr::addClaimsById( std::unordered_map<std::string, Claim*> &claims_by_id )
+{
+	Claim* tmp_claim;
+	claims.Rewind();
+	while( claims.Next(tmp_claim) ) {
+		if( tmp_claim->id() ) {
+			claims_by_id.emplace( tmp_claim->id(), tmp_claim );
+		}
+	}
+}
+
+
 Claim*
 CODMgr::findClaimByPid( pid_t pid )
 {
@@ -24,6 +24,9 @@
 
 #include "simplelist.h"
 
+#include <string>
+#include <unordered_map>
+
 class Resource;
 class Claim;
 
@@ -44,6 +47,9 @@ public:
 
 	Claim* findClaimById( const char* id );
 	Claim* findClaimByPid( pid_t pid );
+		// add each claim to the map under its ClaimId, unless the id
+		// is already there
+	void addClaimsById( std::unordered_map<std::string, Claim*> &claims_by_id );
 
 	int numClaims( void );
 	bool hasClaims( void );
@@ -27,6 +27,7 @@
 #include "consumption_policy.h"
 #include "credmon_interface.h"
 #include "ToE.h"
+#include "dc_startd.h"
 
 #include <map>
 using std::map;
@@ -36,6 +37,39 @@ using std::map;
 
 static int deactivate_claim(Stream *stream, Resource *rip, bool graceful);
 
+// The schedd keeps a TCP connection open to send all of its ALIVE
+// messages for claims on this startd.  Register the socket so that we
+// handle the following commands on it, like the collector does for
+// TCP updates.
+static int
+stash_alive_socket( Stream *stream )
+{
+	if( stream->type() != Stream::reli_sock ) {
+		return TRUE;
+	}
+	if( daemonCore->SocketIsRegistered( stream ) ) {
+		return KEEP_STREAM;
+	}
+
+	Sock *sock = (Sock *)stream;
+	MyString msg;
+	if( daemonCore->TooManyRegisteredSockets( sock->get_file_desc(), &msg ) ) {
+		dprintf( D_FULLDEBUG, "Not keeping TCP socket from %s for more ALIVE messages: %s\n",
+				 sock->peer_description(), msg.Value() );
+		return TRUE;
+	}
+
+	int rc = daemonCore->Register_Command_Socket( sock, "ALIVE Socket" );
+	if( rc < 0 ) {
+		dprintf( D_ALWAYS, "Failed to register TCP socket from %s for ALIVE messages: error %d.\n",
+				 sock->peer_description(), rc );
+		return TRUE;
+	}
+	dprintf( D_FULLDEBUG, "Registered TCP socket from %s for ALIVE messages.\n",
+			 sock->peer_description() );
+	return KEEP_STREAM;
+}
+
 int
 command_handler(int cmd, Stream* stream )
 {
@@ -50,11 +84,16 @@ command_handler(int cmd, Stream* stream )
 		// The rest of these only make sense in claimed state 
 	if( s != claimed_state ) {
 		rip->log_ignore( cmd, s );
+		if( cmd == ALIVE ) {
+				// Other claims may still be using this socket.
+			return stash_alive_socket( stream );
+		}
 		return FALSE;
 	}
 	switch( cmd ) {
 	case ALIVE:
-		rval = rip->got_alive();
+		rip->got_alive();
+		rval = stash_alive_socket( stream );
 		break;
 	case DEACTIVATE_CLAIM:
 	case DEACTIVATE_CLAIM_FORCIBLY:
@@ -75,6 +114,84 @@ command_handler(int cmd, Stream* stream )
 	return rval;
 }
 
+int
+command_alive_batch(int, Stream* stream )
+{
+	int num_claims = 0;
+	stream->decode();
+	if( !stream->get( num_claims ) || num_claims < 0 || num_claims > ALIVE_BATCH_MAX_CLAIMS ) {
+		dprintf( D_ALWAYS, "Failed to read number of claims in ALIVE_BATCH\n" );
+		return FALSE;
+	}
+
+	std::vector<int> statuses;
+	statuses.reserve( num_claims );
+	int num_ok = 0;
+		// one pass over the slots for the whole batch, rather than one
+		// per claim
+	std::unordered_map<std::string, Claim*> claims_by_id;
+	if( num_claims > 0 ) {
+		resmgr->getClaimsById( claims_by_id );
+	}
+	for( int i = 0; i < num_claims; i++ ) {
+		char *id = NULL;
+		if( !stream->get_secret( id ) ) {
+			dprintf( D_ALWAYS, "Failed to read ClaimId %d of %d in ALIVE_BATCH\n",
+					 i+1, num_claims );
+			free( id );
+			return FALSE;
+		}
+
+		int status = ALIVE_BATCH_NO_CLAIM;
+		auto found = claims_by_id.find( id ? id : "" );
+		Claim *claim = found != claims_by_id.end() ? found->second : NULL;
+		ClaimIdParser idp( id );
+		if( !claim ) {
+			dprintf( D_FULLDEBUG, "ALIVE_BATCH: can't find claim %s\n", idp.publicClaimId() );
+		}
+		else if( !claim->rip() || claim->rip()->r_cur != claim ) {
+			status = ALIVE_BATCH_NOT_ACTIVE;
+			dprintf( D_FULLDEBUG, "ALIVE_BATCH: claim %s is not the current claim of its slot\n",
+					 idp.publicClaimId() );
+		}
+		else if( !claim->rip()->got_alive() ) {
+			status = ALIVE_BATCH_REFUSED;
+			dprintf( D_FULLDEBUG, "ALIVE_BATCH: slot %s refused keep alive for claim %s\n",
+					 claim->rip()->r_name, idp.publicClaimId() );
+		}
+		else {
+			status = ALIVE_BATCH_OK;
+			num_ok++;
+		}
+		statuses.push_back( status );
+		free( id );
+	}
+	if( !stream->end_of_message() ) {
+		dprintf( D_ALWAYS, "Failed to read end of message for ALIVE_BATCH\n" );
+		return FALSE;
+	}
+
+	stream->encode();
+	if( !stream->put( num_claims ) ) {
+		dprintf( D_ALWAYS, "Failed to send ALIVE_BATCH reply\n" );
+		return FALSE;
+	}
+	for( auto itr = statuses.begin(); itr != statuses.end(); itr++ ) {
+		if( !stream->put( *itr ) ) {
+			dprintf( D_ALWAYS, "Failed to send ALIVE_BATCH reply\n" );
+			return FALSE;
+		}
+	}
+	if( !stream->end_of_message() ) {
+		dprintf( D_ALWAYS, "Failed to send ALIVE_BATCH reply\n" );
+		return FALSE;
+	}
+
+	dprintf( D_PROTOCOL, "Got ALIVE_BATCH for %d claims from %s (%d kept alive)\n",
+			 num_claims, stream->peer_description(), num_ok );
+	return TRUE;
+}
+
 int
 deactivate_claim(Stream *stream, Resource *rip, bool graceful)
 {
@@ -190,6 +307,24 @@ command_activate_claim(int cmd, Stream* stream )
 		return FALSE;
 	}
 
+	if( rip->isDeactivating() && activation_wait_time > 0 &&
+		! rip->r_cur->hasHeldActivation() )
+	{
+			// The last activation has been deactivated and its starter
+			// is on its way out, but hasn't been reaped yet.  Rather
+			// than make the shadow sleep and retry, hold on to the
+			// request and finish it as soon as the starter is reaped.
+			// A claim that is still busy running a job is not held:
+			// nothing says that starter is about to exit.
+		rip->dprintf( D_ALWAYS,
+					  "Got activate claim while starter is still alive.\n" );
+		rip->dprintf( D_ALWAYS,
+					  "Holding request for up to %d seconds until it exits.\n",
+					  activation_wait_time );
+		rip->r_cur->holdActivation( stream );
+		return KEEP_STREAM;
+	}
+
 	if( rip->isDeactivating() ) { 
 			// We're in the middle of deactivating another claim, so
 			// tell the shadow to try again.  Any shadow before 6.1.9
@@ -39,6 +39,13 @@ int command_handler(int, Stream* );
 */
 int command_with_opts_handler(int, Stream* );
 
+/*
+  ALIVE_BATCH carries the ClaimIds of all of the claims a schedd holds
+  on this startd.  Each one is handled like an ALIVE, and the reply is
+  one AliveBatchStatus per ClaimId, in the same order.
+*/
+int command_alive_batch(int, Stream* );
+
 /*
   ACTIVATE_CLAIM is a special case of the above case, in that more
   stuff is sent over the wire than just the command and the
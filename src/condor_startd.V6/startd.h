@@ -126,6 +126,13 @@ extern	int		startd_noclaim_shutdown;
     // # of seconds we can go without being claimed before we "pull
     // the plug" and tell the master to shutdown.
 
+extern	int		policy_eval_threads;
+    // # of threads evaluating slot policy expressions
+
+extern	int		activation_wait_time;
+    // # of seconds to hold an ACTIVATE_CLAIM that arrives before the
+    // claim's previous starter has exited
+
 extern	char*	Name;			// The startd's name
 
 extern	int		pid_snapshot_interval;	
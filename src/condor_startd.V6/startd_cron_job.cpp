@@ -49,6 +49,33 @@ StartdCronJob::Initialize( void )
 	return CronJob::Initialize( );
 }
 
+	// Collect the names of the attributes of new_ad that are missing from
+	// or different in old_ad.  Returns false if one of the attributes that
+	// decide which slots the ad goes into changed, in which case every
+	// slot needs the whole ad again.
+static bool
+changed_attributes( ClassAd &old_ad, ClassAd &new_ad, classad::References &changed )
+{
+	for( auto itr = new_ad.begin(); itr != new_ad.end(); itr++ ) {
+		ExprTree *old_expr = old_ad.Lookup( itr->first );
+		if( old_expr && old_expr->SameAs( itr->second ) ) {
+			continue;
+		}
+		if( StartdNamedClassAd::SelectsSlots( itr->first ) ) {
+			return false;
+		}
+		changed.insert( itr->first );
+	}
+	for( auto itr = old_ad.begin(); itr != old_ad.end(); itr++ ) {
+		if( StartdNamedClassAd::SelectsSlots( itr->first ) &&
+			! new_ad.Lookup( itr->first ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 int
 StartdCronJob::Publish( const char *ad_name, const char *args, ClassAd *ad )
 {
@@ -87,6 +114,8 @@ StartdCronJob::Publish( const char *ad_name, const char *args, ClassAd *ad )
 		// new ads that point back to this class
 		// so we replicate the relevent bits of adlist_replace here.
 	int rval = 0; // set to 1 to indicate the ad has changed.
+	bool refresh_all = true; // false once we know which attributes changed
+	classad::References changed;
 	StartdNamedClassAd * sad = resmgr->adlist_find( ad_name );
 	if ( ! sad ) {
 		sad = new StartdNamedClassAd( ad_name, *this, ad );
@@ -106,6 +135,12 @@ StartdCronJob::Publish( const char *ad_name, const char *args, ClassAd *ad )
 				StringList ignore_list(ignore.c_str());
 				rval =  ! ClassAdsAreSame(ad, oldAd, &ignore_list);
 			}
+		}
+			// resource monitor ads are aggregated rather than merged,
+			// so those slots always need the whole thing
+		ClassAd* oldAd = sad->GetAd();
+		if ( oldAd && ! sad->isResourceMonitor() ) {
+			refresh_all = ! changed_attributes( *oldAd, *ad, changed );
 		}
 		sad->AggregateFrom(ad);
 	}
@@ -144,17 +179,15 @@ StartdCronJob::Publish( const char *ad_name, const char *args, ClassAd *ad )
 				(int)auto_publish );
 		break;
 	}
-	if( wants_update ) {
-		resmgr->update_all();
-	}
 
-	// Update our internal (policy) ads immediately.  Otherwise, this cron
-	// job's output won't effect anything until the next UPDATE_INTERVAL.
-	// The flag argument must be at least A_PUBLIC | A_UPDATE to pass the
-	// check in ResMgr::adlist_publish(), which is the (only) update we
-	// actually want.  (We can't call it directly, because we need to
-	// update the internal ad for each Resource.)
-	resmgr->walk( &Resource::refresh_startd_cron_attrs);
+	// Update our internal (policy) ads soon, rather than waiting for the
+	// next UPDATE_INTERVAL.  The refresh (and collector update, if we
+	// want one) is batched with those of other cron jobs that publish
+	// within STARTD_CRON_REFRESH_WINDOW, so a burst of cron output only
+	// costs one pass over the slots, and only the attributes that
+	// changed are merged into them.
+	resmgr->adlist_refresh_soon( ad_name, refresh_all ? NULL : &changed,
+								 wants_update );
 	return rval;
 }
 
@@ -28,7 +28,8 @@
 StartdCronJobMgr::StartdCronJobMgr( void )
 		: CronJobMgr( ),
 		  m_shutting_down( false ),
-		  m_auto_publish( CAP_NEVER )
+		  m_auto_publish( CAP_NEVER ),
+		  m_refresh_window( 1 )
 {
 }
 
@@ -74,6 +75,8 @@ StartdCronJobMgr::Reconfig( void )
 void
 StartdCronJobMgr::ParamAutoPublish( void )
 {
+	m_refresh_window = param_integer( "STARTD_CRON_REFRESH_WINDOW", 1, 0 );
+
 	m_auto_publish = CAP_NEVER;  // always default to never if not set
 	char* tmp = param("STARTD_CRON_AUTOPUBLISH");
 	if( tmp ) {
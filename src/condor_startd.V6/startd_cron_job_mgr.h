@@ -43,6 +43,9 @@ class StartdCronJobMgr : public CronJobMgr
 	CronAutoPublish_t getAutoPublishValue( void ) const {
 		return m_auto_publish;
 	};
+	int getRefreshWindow( void ) const {
+		return m_refresh_window;
+	};
 
   protected:
 	StartdCronJobParams *CreateJobParams( const char *job_name );
@@ -52,6 +55,7 @@ class StartdCronJobMgr : public CronJobMgr
 	bool m_shutting_down;
 	void ParamAutoPublish( void );
 	CronAutoPublish_t m_auto_publish;
+	int m_refresh_window;	// seconds to batch up slot refreshes for
 };
 
 #endif /* _STARTD_CRON_JOB_MGR_H */
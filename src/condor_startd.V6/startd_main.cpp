@@ -89,6 +89,13 @@ int		startd_noclaim_shutdown = 0;
     // # of seconds we can go without being claimed before we "pull
     // the plug" and tell the master to shutdown.
 
+int		policy_eval_threads = 1;
+    // # of threads evaluating slot policy expressions
+
+int		activation_wait_time = 10;
+    // # of seconds to hold an ACTIVATE_CLAIM that arrives before the
+    // claim's previous starter has exited
+
 char* Name = NULL;
 
 #define DEFAULT_PID_SNAPSHOT_INTERVAL 15
@@ -258,6 +265,10 @@ main_init( int, char* argv[] )
 								  command_handler,
 								  "command_handler", DAEMON,
 								  D_FULLDEBUG ); 
+	daemonCore->Register_Command( ALIVE_BATCH, "ALIVE_BATCH",
+								  command_alive_batch,
+								  "command_alive_batch", DAEMON,
+								  D_FULLDEBUG );
 	daemonCore->Register_Command( DEACTIVATE_CLAIM,
 								  "DEACTIVATE_CLAIM",  
 								  command_handler,
@@ -583,6 +594,13 @@ init_params( int first_time)
 
 	startd_noclaim_shutdown = param_integer( "STARTD_NOCLAIM_SHUTDOWN", 0 );
 
+	policy_eval_threads = param_integer( "STARTD_POLICY_EVAL_THREADS", 1, 1 );
+	if( policy_eval_threads > 1 ) {
+		dprintf_make_thread_safe();
+	}
+
+	activation_wait_time = param_integer( "STARTD_ACTIVATION_WAIT_TIME", 10, 0, 15 );
+
 	// a 0 or negative value for the timer interval will disable cleanup reminders entirely
 	cleanup_reminder_timer_interval = param_integer( "STARTD_CLEANUP_REMINDER_TIMER_INTERVAL", 62 );
 
@@ -111,6 +111,36 @@ StartdNamedClassAd::MergeInto(ClassAd *merge_into)
 	return StartdNamedClassAd::Merge( merge_into, this->GetAd() );
 }
 
+bool
+StartdNamedClassAd::MergeInto(ClassAd *merge_into, const classad::References &attrs)
+{
+	ClassAd *merge_from = this->GetAd();
+	if ( ! merge_into || ! merge_from ) {
+		return false;
+	}
+
+	int cMerged = 0;
+	for ( auto it = attrs.begin(); it != attrs.end(); ++it ) {
+		if ( dont_merge_attrs.find(*it) != dont_merge_attrs.end() ) {
+			continue;
+		}
+		ExprTree *expr = merge_from->Lookup( *it );
+		if ( expr ) {
+			merge_into->Insert( *it, expr->Copy() );
+			cMerged++;
+		}
+	}
+	return cMerged > 0;
+}
+
+bool
+StartdNamedClassAd::SelectsSlots( const std::string & attr )
+{
+		// the attributes ShouldMergeInto() looks at are exactly the
+		// ones we never merge
+	return dont_merge_attrs.find( attr ) != dont_merge_attrs.end();
+}
+
 bool
 StartdNamedClassAd::isResourceMonitor() {
 	return m_job.isResourceMonitor();
@@ -35,11 +35,14 @@ class StartdNamedClassAd : public NamedClassAd
 	bool IsJob(StartdCronJob * job) const { return &m_job == job; }
 	bool ShouldMergeInto(ClassAd * merge_into, const char ** pattr_used);
 	bool MergeInto(ClassAd *merge_to);
+	bool MergeInto(ClassAd *merge_to, const classad::References &attrs);
 
 	void AggregateFrom(ClassAd *aggregateFrom);
 	bool AggregateInto(ClassAd *aggregateInfo);
 	bool isResourceMonitor();
 	static bool Merge( ClassAd * to, ClassAd * from );
+		// does this attribute decide which slots an ad is merged into?
+	static bool SelectsSlots( const std::string & attr );
 	void reset_monitor();
 	void unset_monitor();
 
@@ -27,6 +27,8 @@
 #include "startd_named_classad.h"
 #include "startd_named_classad_list.h"
 
+#include <vector>
+
 StartdNamedClassAdList::StartdNamedClassAdList( void )
 		: NamedClassAdList( )
 {
@@ -187,6 +189,55 @@ StartdNamedClassAdList::Publish( ClassAd *merged_ad, unsigned r_id, const char *
 	return 0;
 }
 
+int
+StartdNamedClassAdList::PublishChanges( ClassAd *merged_ad, unsigned r_id, const char * r_id_str,
+	const std::map<std::string, classad::References> &changes )
+{
+		// Publish() merges every ad that applies to this slot in list
+		// order, and the resource monitor totals after all of them, so
+		// the last ad to define an attribute wins.  Find the ads that
+		// apply first, so that we don't let a changed attribute of one
+		// ad overwrite the value of a later ad that didn't change.
+	std::vector<StartdNamedClassAd *> applies;
+	std::list<NamedClassAd *>::iterator iter;
+	for( iter = m_ads.begin(); iter != m_ads.end(); iter++ ) {
+		NamedClassAd		*nad = *iter;
+		StartdNamedClassAd	*sad = dynamic_cast<StartdNamedClassAd*>(nad);
+		ASSERT( sad );
+
+		if ( nad->GetAd() && sad->InSlotList(r_id) && sad->ShouldMergeInto(merged_ad, NULL) ) {
+			applies.push_back( sad );
+		}
+	}
+
+	for( size_t ix = 0; ix < applies.size(); ix++ ) {
+		StartdNamedClassAd	*sad = applies[ix];
+		if( sad->isResourceMonitor() ) { continue; }
+
+		auto changed = changes.find( sad->GetName() );
+		if( changed == changes.end() || changed->second.empty() ) { continue; }
+
+		classad::References attrs;
+		for( auto it = changed->second.begin(); it != changed->second.end(); ++it ) {
+			bool overridden = false;
+			for( size_t jx = 0; jx < applies.size() && ! overridden; jx++ ) {
+				if( jx <= ix && ! applies[jx]->isResourceMonitor() ) { continue; }
+				overridden = applies[jx]->GetAd()->Lookup( *it ) != NULL;
+			}
+			if( ! overridden ) {
+				attrs.insert( *it );
+			}
+		}
+		if( attrs.empty() ) { continue; }
+
+		dprintf( D_FULLDEBUG,
+				 "Publishing %d changed attributes of ClassAd '%s' to %s\n",
+				 (int)attrs.size(), sad->GetName(), r_id_str );
+		sad->MergeInto( merged_ad, attrs );
+	}
+	return 0;
+}
+
 void
 StartdNamedClassAdList::reset_monitors( unsigned r_id, ClassAd * forWhom ) {
 	std::list<NamedClassAd *>::iterator iter;
@@ -33,6 +33,10 @@ class StartdNamedClassAdList : public NamedClassAdList
 
 	bool Register( StartdNamedClassAd *ad );
 	int	Publish( ClassAd *ad, unsigned r_id, const char * r_id_str = NULL );
+		// Like Publish(), but only merge the given attributes of the
+		// given (non resource monitor) ads
+	int	PublishChanges( ClassAd *ad, unsigned r_id, const char * r_id_str,
+			const std::map<std::string, classad::References> &changes );
 	int DeleteJob ( StartdCronJob * job );
 	int ClearJob ( StartdCronJob * job );
 	virtual NamedClassAd * New( const char *name, ClassAd *ad = NULL );
@@ -0,0 +1,284 @@
+
+#include "condor_common.h"
+#include "cgroup_usage.h"
+
+#if defined(HAVE_EXT_LIBCGROUP)
+
+#include "cgroup.linux.h"
+#include "condor_debug.h"
+
+static long clock_tick = sysconf( _SC_CLK_TCK );
+
+// Read a whole (small) cgroup control file into buf.  These files are
+// generated by the kernel on every read, so there is no point in
+// buffering them through stdio.
+static bool
+read_cgroup_file(const std::string &path, char *buf, size_t size)
+{
+	int fd = safe_open_wrapper_follow(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		dprintf(D_FULLDEBUG, "Unable to open %s: %s\n", path.c_str(), strerror(errno));
+		return false;
+	}
+	size_t len = 0;
+	while (len < size - 1) {
+		ssize_t rc = read(fd, buf + len, size - 1 - len);
+		if (rc == -1 && errno == EINTR) {
+			continue;
+		}
+		if (rc <= 0) {
+			if (rc == -1) {
+				dprintf(D_FULLDEBUG, "Unable to read %s: %s\n", path.c_str(), strerror(errno));
+				close(fd);
+				return false;
+			}
+			break;
+		}
+		len += rc;
+	}
+	close(fd);
+	buf[len] = '\0';
+	return true;
+}
+
+CgroupUsage::CgroupUsage(const std::string &cgroup) :
+	m_cgroup_string(cgroup),
+	m_initial_user_cpu(0),
+	m_initial_sys_cpu(0),
+	m_initial_read_bytes(0),
+	m_initial_write_bytes(0),
+	m_initial_reads(0),
+	m_initial_writes(0),
+	m_last_sample(0),
+	m_last_cpu(0),
+	m_percent_cpu(0.0),
+	m_max_image_size(0)
+{
+	// Find where each controller is mounted; the job's cgroup is the
+	// same relative path under each of them.
+	void *handle = NULL;
+	struct cgroup_mount_point mount_info;
+	int ret = cgroup_get_controller_begin(&handle, &mount_info);
+	while (ret == 0) {
+		std::string dir = std::string(mount_info.path) + "/" + m_cgroup_string;
+		if (strcmp(mount_info.name, CPUACCT_CONTROLLER_STR) == 0) {
+			m_cpuacct_dir = dir;
+		} else if (strcmp(mount_info.name, MEMORY_CONTROLLER_STR) == 0) {
+			m_memory_dir = dir;
+		} else if (strcmp(mount_info.name, BLOCK_CONTROLLER_STR) == 0) {
+			m_blkio_dir = dir;
+		}
+		ret = cgroup_get_controller_next(&handle, &mount_info);
+	}
+	if (ret != ECGEOF) {
+		dprintf(D_ALWAYS,
+			"Error while locating cgroup controllers for %s: %u %s\n",
+			m_cgroup_string.c_str(), ret, cgroup_strerror(ret));
+	}
+	cgroup_get_controller_end(&handle);
+
+	if (m_cpuacct_dir.empty() || m_memory_dir.empty()) {
+		dprintf(D_ALWAYS,
+			"cpuacct or memory controller not mounted; usage for cgroup %s "
+			"will come from the procd.\n", m_cgroup_string.c_str());
+		m_cpuacct_dir.clear();
+		m_memory_dir.clear();
+		return;
+	}
+
+	// Whatever is already charged to the cgroup isn't ours.
+	read_cpu(m_initial_user_cpu, m_initial_sys_cpu);
+	read_blkio("blkio.throttle.io_service_bytes", m_initial_read_bytes, m_initial_write_bytes);
+	read_blkio("blkio.throttle.io_serviced", m_initial_reads, m_initial_writes);
+	m_last_sample = time(NULL);
+	m_last_cpu = 0;
+}
+
+bool
+CgroupUsage::read_cpu(long &user_time, long &sys_time)
+{
+	char buf[256];
+	if (!read_cgroup_file(m_cpuacct_dir + "/cpuacct.stat", buf, sizeof(buf))) {
+		return false;
+	}
+
+	// cpuacct.stat is "user <ticks>\nsystem <ticks>\n"
+	bool found_user = false, found_sys = false;
+	char *line = buf;
+	while (*line) {
+		char *end = strchr(line, '\n');
+		if (end) {
+			*end = '\0';
+		}
+		if (strncmp(line, "user ", 5) == 0) {
+			user_time = strtoull(line + 5, NULL, 10) / clock_tick;
+			found_user = true;
+		} else if (strncmp(line, "system ", 7) == 0) {
+			sys_time = strtoull(line + 7, NULL, 10) / clock_tick;
+			found_sys = true;
+		}
+		if (!end) {
+			break;
+		}
+		line = end + 1;
+	}
+	return found_user && found_sys;
+}
+
+bool
+CgroupUsage::read_memory(unsigned long &usage_kbytes)
+{
+	char buf[64];
+	if (!read_cgroup_file(m_memory_dir + "/memory.usage_in_bytes", buf, sizeof(buf))) {
+		return false;
+	}
+	usage_kbytes = strtoull(buf, NULL, 10) / 1024;
+	return true;
+}
+
+// Sum the Read and Write lines across all devices of one of the
+// blkio.throttle.* files, as the procd does.
+bool
+CgroupUsage::read_blkio(const char *name, int64_t &reads, int64_t &writes)
+{
+	if (m_blkio_dir.empty()) {
+		return false;
+	}
+
+	// one line per device per operation type, so this can get long on
+	// machines with many disks
+	char buf[16384];
+	if (!read_cgroup_file(m_blkio_dir + "/" + name, buf, sizeof(buf))) {
+		return false;
+	}
+
+	reads = 0;
+	writes = 0;
+	char *tok_handle = NULL;
+	for (char *line = strtok_r(buf, "\n", &tok_handle); line; line = strtok_r(NULL, "\n", &tok_handle)) {
+		char *op = strchr(line, ' ');
+		if (!op) {
+			continue;
+		}
+		op++;
+		char *value = strchr(op, ' ');
+		if (!value) {
+			continue;
+		}
+		*value++ = '\0';
+		if (strcmp(op, "Read") == 0) {
+			reads += strtoll(value, NULL, 10);
+		} else if (strcmp(op, "Write") == 0) {
+			writes += strtoll(value, NULL, 10);
+		}
+	}
+	return true;
+}
+
+int
+CgroupUsage::count_tasks()
+{
+	char buf[16384];
+	std::string path = m_cpuacct_dir + "/cgroup.procs";
+	int fd = safe_open_wrapper_follow(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		dprintf(D_FULLDEBUG, "Unable to open %s: %s\n", path.c_str(), strerror(errno));
+		return -1;
+	}
+	int tasks = 0;
+	ssize_t rc;
+	while ((rc = read(fd, buf, sizeof(buf))) != 0) {
+		if (rc == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			dprintf(D_FULLDEBUG, "Unable to read %s: %s\n", path.c_str(), strerror(errno));
+			tasks = -1;
+			break;
+		}
+		for (ssize_t i = 0; i < rc; i++) {
+			if (buf[i] == '\n') {
+				tasks++;
+			}
+		}
+	}
+	close(fd);
+	return tasks;
+}
+
+bool
+CgroupUsage::get_usage(ProcFamilyUsage &usage)
+{
+	if (m_cpuacct_dir.empty()) {
+		return false;
+	}
+
+	long user_time = 0, sys_time = 0;
+	unsigned long image_size = 0;
+	if (!read_cpu(user_time, sys_time) || !read_memory(image_size)) {
+		return false;
+	}
+
+	usage.user_cpu_time = user_time - m_initial_user_cpu;
+	usage.sys_cpu_time = sys_time - m_initial_sys_cpu;
+
+	time_t now = time(NULL);
+	long cpu = usage.user_cpu_time + usage.sys_cpu_time;
+	if (now > m_last_sample) {
+		m_percent_cpu = 100.0 * (cpu - m_last_cpu) / (now - m_last_sample);
+		m_last_sample = now;
+		m_last_cpu = cpu;
+	}
+	usage.percent_cpu = m_percent_cpu;
+
+	// Like the procd, use memory.usage_in_bytes rather than
+	// memory.max_usage_in_bytes, which counts the page cache.
+	usage.total_image_size = image_size;
+	usage.total_resident_set_size = image_size;
+	if (image_size > m_max_image_size) {
+		m_max_image_size = image_size;
+	}
+	usage.max_image_size = m_max_image_size;
+#if HAVE_PSS
+	usage.total_proportional_set_size = 0;
+	usage.total_proportional_set_size_available = false;
+#endif
+
+	// -1 means "cannot record", as with the procd
+	int64_t reads, writes;
+	if (read_blkio("blkio.throttle.io_service_bytes", reads, writes)) {
+		usage.block_read_bytes = reads - m_initial_read_bytes;
+		usage.block_write_bytes = writes - m_initial_write_bytes;
+	} else {
+		usage.block_read_bytes = -1;
+		usage.block_write_bytes = -1;
+	}
+	if (read_blkio("blkio.throttle.io_serviced", reads, writes)) {
+		usage.block_reads = reads - m_initial_reads;
+		usage.block_writes = writes - m_initial_writes;
+	} else {
+		usage.block_reads = -1;
+		usage.block_writes = -1;
+	}
+	usage.io_wait = -1;
+	char buf[16384];
+	if (!m_blkio_dir.empty() &&
+		read_cgroup_file(m_blkio_dir + "/blkio.io_wait_time", buf, sizeof(buf)))
+	{
+		// the last line is "Total <nanoseconds>"
+		char *total = strstr(buf, "Total ");
+		if (total) {
+			usage.io_wait = strtoll(total + 6, NULL, 10) / 1.e9;
+		}
+	}
+
+	int tasks = count_tasks();
+	if (tasks < 0) {
+		return false;
+	}
+	usage.num_procs = tasks;
+
+	return true;
+}
+
+#endif
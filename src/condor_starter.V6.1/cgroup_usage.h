@@ -0,0 +1,54 @@
+/*
+ * This class reads a job's resource usage straight out of its
+ * cgroup, without going through the procd.
+ *
+ */
+
+#ifndef _CGROUP_USAGE_H
+#define _CGROUP_USAGE_H
+
+#include "proc_family_io.h"
+
+#if defined(HAVE_EXT_LIBCGROUP)
+
+class CgroupUsage {
+
+public:
+	// the CPU time and block I/O already charged to the cgroup
+	// are taken as the starting point
+	CgroupUsage(const std::string &cgroup);
+
+	// fill in usage the same way the procd would for a family tracked
+	// by this cgroup. returns false if the cgroup can't be read, in
+	// which case the caller should ask the procd instead.
+	bool get_usage(ProcFamilyUsage &usage);
+
+private:
+	bool read_cpu(long &user_time, long &sys_time);
+	bool read_memory(unsigned long &usage_kbytes);
+	bool read_blkio(const char *name, int64_t &reads, int64_t &writes);
+	int count_tasks();
+
+	const std::string m_cgroup_string;
+	std::string m_cpuacct_dir;
+	std::string m_memory_dir;
+	std::string m_blkio_dir;
+
+	long m_initial_user_cpu;
+	long m_initial_sys_cpu;
+	int64_t m_initial_read_bytes;
+	int64_t m_initial_write_bytes;
+	int64_t m_initial_reads;
+	int64_t m_initial_writes;
+
+	// for computing percent_cpu between calls
+	time_t m_last_sample;
+	long m_last_cpu;
+	double m_percent_cpu;
+
+	unsigned long m_max_image_size;
+};
+
+#endif
+
+#endif
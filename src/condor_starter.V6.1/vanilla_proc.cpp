@@ -34,6 +34,7 @@
 #include "env.h"
 #include "subsystem_info.h"
 #include "cgroup_limits.h"
+#include "cgroup_usage.h"
 #include "selector.h"
 #include "singularity.h"
 #include "has_sysadmin_cap.h"
@@ -143,6 +144,9 @@ VanillaProc::VanillaProc(ClassAd* jobAd) : OsProc(jobAd),
 	m_oom_fd(-1),
 	m_oom_efd(-1),
 	m_oom_efd2(-1),
+#if defined(HAVE_EXT_LIBCGROUP)
+	m_cgroup_usage(NULL),
+#endif
 	isCheckpointing(false),
 	isSoftKilling(false)
 {
@@ -155,6 +159,9 @@ VanillaProc::VanillaProc(ClassAd* jobAd) : OsProc(jobAd),
 VanillaProc::~VanillaProc()
 {
 	cleanupOOM();
+#if defined(HAVE_EXT_LIBCGROUP)
+	delete m_cgroup_usage;
+#endif
 }
 
 int
@@ -334,6 +341,7 @@ VanillaProc::StartJob()
 	param(cgroup_base, "BASE_CGROUP", "");
 	MyString cgroup_str;
 	const char *cgroup = NULL;
+	bool cgroup_only_accounting = false;
 		/* Note on CONDOR_UNIVERSE_LOCAL - The cgroup setup code below
 		 *  requires a unique name for the cgroup. It relies on
 		 *  uniqueness of the MachineAd's Name
@@ -373,6 +381,13 @@ VanillaProc::StartJob()
 		ASSERT (cgroup != NULL);
 		fi.cgroup = cgroup;
 		dprintf(D_FULLDEBUG, "Requesting cgroup %s for job.\n", cgroup);
+
+			// The starter will read usage from the cgroup itself, so
+			// this family should never make the procd take a snapshot.
+		cgroup_only_accounting = param_boolean("CGROUP_ONLY_ACCOUNTING", false);
+		if (cgroup_only_accounting) {
+			fi.max_snapshot_interval = -1;
+		}
 	}
 
 #endif
@@ -649,6 +664,15 @@ VanillaProc::StartJob()
 
 #if defined(HAVE_EXT_LIBCGROUP)
 
+	// StartJob() is called again when a self-checkpointing job restarts;
+	// usage up to that point is already in m_checkpoint_usage, so start
+	// counting afresh.
+	delete m_cgroup_usage;
+	m_cgroup_usage = NULL;
+	if (cgroup_only_accounting && retval) {
+		m_cgroup_usage = new CgroupUsage(cgroup);
+	}
+
 	// Set fairshare limits.  Note that retval == 1 indicates success, 0 is failure.
 	// See Note near setup of param(BASE_CGROUP)
 	if (CONDOR_UNIVERSE_LOCAL != job_universe && cgroup && retval) {
@@ -745,7 +769,7 @@ VanillaProc::PublishUpdateAd( ClassAd* ad )
 	if( m_proc_exited ) {
 		current_usage = m_final_usage;
 	} else {
-		if (daemonCore->Get_Family_Usage(JobPid, current_usage) == FALSE) {
+		if (!getFamilyUsage(current_usage)) {
 			dprintf(D_ALWAYS, "error getting family usage in "
 					"VanillaProc::PublishUpdateAd() for pid %d\n", JobPid);
 			return false;
@@ -848,8 +872,17 @@ int VanillaProc::pidNameSpaceReaper( int status ) {
 void VanillaProc::notifySuccessfulEvictionCheckpoint() { /* FIXME (#4969) */ }
 void VanillaProc::notifySuccessfulPeriodicCheckpoint() { /* FIXME (#4969) */ }
 
+bool VanillaProc::getFamilyUsage( ProcFamilyUsage &usage ) {
+#if defined(HAVE_EXT_LIBCGROUP)
+	if( m_cgroup_usage && m_cgroup_usage->get_usage( usage ) ) {
+		return true;
+	}
+#endif
+	return daemonCore->Get_Family_Usage( JobPid, usage ) != FALSE;
+}
+
 void VanillaProc::recordFinalUsage() {
-	if( daemonCore->Get_Family_Usage(JobPid, m_final_usage) == FALSE ) {
+	if( !getFamilyUsage( m_final_usage ) ) {
 		dprintf( D_ALWAYS, "error getting family usage for pid %d in "
 			"VanillaProc::JobReaper()\n", JobPid );
 	}
@@ -870,7 +903,7 @@ void VanillaProc::killFamilyIfWarranted() {
 
 void VanillaProc::restartCheckpointedJob() {
 	ProcFamilyUsage last_usage;
-	if( daemonCore->Get_Family_Usage( JobPid, last_usage ) == FALSE ) {
+	if( !getFamilyUsage( last_usage ) ) {
 		dprintf( D_ALWAYS, "error getting family usage for pid %d in "
 			"VanillaProc::restartCheckpointedJob()\n", JobPid );
 	}
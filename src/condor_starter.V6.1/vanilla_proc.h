@@ -26,6 +26,7 @@
 
 /* forward reference */
 class SafeSock;
+class CgroupUsage;
 
 struct StarterStatistics {
     // these are used by generic tick
@@ -137,8 +138,15 @@ private:
 
 	std::string m_pid_ns_status_filename;
 
+#if defined(HAVE_EXT_LIBCGROUP)
+		// Reads the job's usage straight from its cgroup when
+		// CGROUP_ONLY_ACCOUNTING is enabled; NULL otherwise.
+	CgroupUsage *m_cgroup_usage;
+#endif
+
 	// Internal helper functions.
 	int pidNameSpaceReaper( int status );
+	bool getFamilyUsage( ProcFamilyUsage &usage );
 	void recordFinalUsage();
 	void killFamilyIfWarranted();
 	void notifySuccessfulEvictionCheckpoint();
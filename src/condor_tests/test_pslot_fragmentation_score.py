@@ -0,0 +1,106 @@
+#!/usr/bin/env pytest
+
+#
+# A partitionable slot advertises FragmentationScore, the fraction of its
+# Cpus and Memory given to dynamic slots.  Carve a known share out of a
+# partitionable slot and check the score it publishes.
+#
+
+import logging
+
+import htcondor
+
+from ornithology import (
+    config,
+    standup,
+    action,
+    Condor,
+    ClusterState,
+)
+
+logger = logging.getLogger(__name__)
+logger.setLevel(logging.DEBUG)
+
+
+@config
+def slot_config():
+    return {
+        "NUM_CPUS": "4",
+        "MEMORY": "1024",
+        "SLOT_TYPE_1": "cpus=100%,memory=100%,disk=100%",
+        "SLOT_TYPE_1_PARTITIONABLE": "True",
+        "NUM_SLOTS_TYPE_1": "1",
+        "UPDATE_INTERVAL": "2",
+    }
+
+
+@standup
+def condor(test_dir, slot_config):
+    with Condor(local_dir=test_dir / "condor", config=slot_config) as condor:
+        yield condor
+
+
+def pslot_ad(condor):
+    ads = condor.direct_status(
+        htcondor.DaemonTypes.Startd,
+        htcondor.AdTypes.Startd,
+        projection=[
+            "PartitionableSlot",
+            "FragmentationScore",
+            "Cpus",
+            "Memory",
+            "TotalSlotCpus",
+            "TotalSlotMemory",
+        ],
+    )
+    pslots = [ad for ad in ads if ad.get("PartitionableSlot", False)]
+    assert len(pslots) == 1
+    return pslots[0]
+
+
+@action
+def empty_pslot(condor):
+    return pslot_ad(condor)
+
+
+@action
+def running_job(condor, path_to_sleep, empty_pslot):
+    # one of the four cpus and a quarter of the memory
+    handle = condor.submit(
+        description={
+            "executable": path_to_sleep,
+            "arguments": "60",
+            "request_cpus": "1",
+            "request_memory": "256MB",
+            "request_disk": "10MB",
+        },
+        count=1,
+    )
+
+    assert handle.wait(
+        condition=ClusterState.all_running,
+        timeout=120,
+        fail_condition=ClusterState.any_terminal,
+    )
+
+    yield handle
+
+    handle.remove()
+
+
+@action
+def carved_pslot(condor, running_job):
+    return pslot_ad(condor)
+
+
+class TestPslotFragmentationScore:
+    def test_empty_pslot_score(self, empty_pslot):
+        assert empty_pslot.eval("FragmentationScore") == 0.0
+
+    def test_carved_pslot_resources(self, carved_pslot):
+        assert carved_pslot["Cpus"] == 3
+        assert carved_pslot["Memory"] == 768
+
+    def test_carved_pslot_score(self, carved_pslot):
+        # 1 - (3/4 + 768/1024) / 2
+        assert abs(carved_pslot.eval("FragmentationScore") - 0.25) < 1e-9
@@ -0,0 +1,134 @@
+#!/usr/bin/env pytest
+
+#
+# The startd merges only the attributes of a STARTD_CRON ad that changed
+# since the job's last output into its slot ads.  Check that the changes
+# show up, that an attribute which changed in one job's output doesn't
+# beat the (unchanged) value of a job later in STARTD_CRON_JOBLIST, and
+# that an ad which picks its slot by SlotId only goes into that slot.
+#
+
+import logging
+import time
+
+import htcondor
+
+from ornithology import (
+    config,
+    standup,
+    action,
+    Condor,
+    write_file,
+    format_script,
+)
+
+logger = logging.getLogger(__name__)
+logger.setLevel(logging.DEBUG)
+
+CRON_PERIOD = 2
+NUM_RUNS = 4
+
+
+def counter_script(counter, lines):
+    # print the given lines, with COUNT replaced by the number of times
+    # the script has run
+    return format_script(
+        """
+        #!/usr/bin/python3
+
+        from pathlib import Path
+
+        counter = Path("{counter}")
+        count = int(counter.read_text()) + 1 if counter.exists() else 1
+        counter.write_text(str(count))
+
+        for line in {lines!r}:
+            print(line.replace("COUNT", str(count)))
+        """.format(
+            counter=counter.as_posix(), lines=lines
+        )
+    )
+
+
+@config
+def cron_scripts(test_dir):
+    return {
+        "early": counter_script(
+            test_dir / "early.count",
+            ['CronShared = "earlyCOUNT"', "CronEarlyCount = COUNT"],
+        ),
+        "late": counter_script(test_dir / "late.count", ['CronShared = "late"']),
+        "oneslot": counter_script(
+            test_dir / "oneslot.count", ["SlotId = 1", "CronOneSlotCount = COUNT"]
+        ),
+    }
+
+
+@config
+def slot_config():
+    return {
+        "NUM_CPUS": "2",
+        "NUM_SLOTS": "2",
+        "STARTD_CRON_AUTOPUBLISH": "If_Changed",
+        "STARTD_CRON_REFRESH_WINDOW": "1",
+        "STARTD_CRON_JOBLIST": "EARLY LATE ONESLOT",
+        "STARTD_CRON_EARLY_EXECUTABLE": "$(TEST_DIR)/early.py",
+        "STARTD_CRON_EARLY_MODE": "periodic",
+        "STARTD_CRON_EARLY_PERIOD": str(CRON_PERIOD),
+        "STARTD_CRON_LATE_EXECUTABLE": "$(TEST_DIR)/late.py",
+        "STARTD_CRON_LATE_MODE": "periodic",
+        "STARTD_CRON_LATE_PERIOD": str(CRON_PERIOD),
+        "STARTD_CRON_ONESLOT_EXECUTABLE": "$(TEST_DIR)/oneslot.py",
+        "STARTD_CRON_ONESLOT_MODE": "periodic",
+        "STARTD_CRON_ONESLOT_PERIOD": str(CRON_PERIOD),
+    }
+
+
+@standup
+def condor(test_dir, slot_config, cron_scripts):
+    for name, script in cron_scripts.items():
+        write_file(test_dir / "{}.py".format(name), script)
+
+    with Condor(
+        local_dir=test_dir / "condor",
+        config={**slot_config, "TEST_DIR": test_dir.as_posix()},
+    ) as condor:
+        yield condor
+
+
+@action
+def slot_ads(condor):
+    # wait until the early job's output has changed a few times
+    deadline = time.time() + 60 + NUM_RUNS * CRON_PERIOD
+    while True:
+        ads = condor.direct_status(
+            htcondor.DaemonTypes.Startd,
+            htcondor.AdTypes.Startd,
+            projection=[
+                "SlotID",
+                "CronShared",
+                "CronEarlyCount",
+                "CronOneSlotCount",
+            ],
+        )
+        counts = [ad.get("CronEarlyCount", 0) for ad in ads]
+        if len(ads) == 2 and min(counts) >= NUM_RUNS:
+            break
+        assert time.time() < deadline, "cron output never reached the slots"
+        time.sleep(1)
+
+    return {ad["SlotID"]: ad for ad in ads}
+
+
+class TestStartdCronMerge:
+    def test_changed_attributes_are_merged(self, slot_ads):
+        for ad in slot_ads.values():
+            assert ad["CronEarlyCount"] >= NUM_RUNS
+
+    def test_later_job_wins_over_changed_attribute(self, slot_ads):
+        for ad in slot_ads.values():
+            assert ad["CronShared"] == "late"
+
+    def test_slot_id_selects_slot(self, slot_ads):
+        assert slot_ads[1]["CronOneSlotCount"] >= 1
+        assert "CronOneSlotCount" not in slot_ads[2]
@@ -0,0 +1,176 @@
+#!/usr/bin/env pytest
+
+#
+# When an ACTIVATE_CLAIM arrives while the claim's last starter is still
+# on its way out, the startd holds the request until the starter is
+# reaped, for at most STARTD_ACTIVATION_WAIT_TIME seconds.  Run a starter
+# that lingers after it exits, so the shadow of the second of two jobs on
+# one claim always finds the first job's starter still alive, and check
+# that the held request is finished when the starter exits, answered when
+# the wait times out, and refused when the claim goes away first.
+#
+
+import logging
+
+import htcondor
+
+from ornithology import (
+    config,
+    standup,
+    action,
+    Condor,
+    write_file,
+    format_script,
+)
+
+logger = logging.getLogger(__name__)
+logger.setLevel(logging.DEBUG)
+
+
+@config(
+    params={
+        "released": (
+            "15",
+            "3",
+            False,
+            "Starter exited, finishing held activate claim request.",
+        ),
+        "timed_out": (
+            "1",
+            "5",
+            False,
+            "Starter still alive after 1 seconds, telling shadow to try again later.",
+        ),
+        "claim_released": (
+            "15",
+            "5",
+            True,
+            "going away, refusing held activate claim request.",
+        ),
+    }
+)
+def held_activation(request):
+    return request.param
+
+
+@config
+def wait_time(held_activation):
+    return held_activation[0]
+
+
+@config
+def linger_time(held_activation):
+    return held_activation[1]
+
+
+@config
+def vacate_while_held(held_activation):
+    return held_activation[2]
+
+
+@config
+def expected_message(held_activation):
+    return held_activation[3]
+
+
+@config
+def lingering_starter(linger_time):
+    # run the real starter, passing on the signals the startd sends it,
+    # then linger before exiting as it did
+    return format_script(
+        """
+        #!/usr/bin/python3
+
+        import os
+        import signal
+        import subprocess
+        import sys
+        import time
+
+        starter = subprocess.Popen(["{real_starter}"] + sys.argv[1:])
+        for sig in (signal.SIGTERM, signal.SIGQUIT, signal.SIGHUP,
+                    signal.SIGUSR1, signal.SIGUSR2):
+            signal.signal(sig, lambda sig, frame: starter.send_signal(sig))
+        rc = starter.wait()
+
+        if "-classad" not in sys.argv:
+            time.sleep({linger_time})
+
+        if rc < 0:
+            signal.signal(-rc, signal.SIG_DFL)
+            os.kill(os.getpid(), -rc)
+        sys.exit(rc)
+        """.format(
+            real_starter=htcondor.param["SBIN"] + "/condor_starter",
+            linger_time=linger_time,
+        )
+    )
+
+
+@config
+def slot_config(wait_time):
+    return {
+        "NUM_CPUS": "1",
+        "NUM_SLOTS": "1",
+        "STARTER": "$(TEST_DIR)/lingering_starter.py",
+        "STARTD_ACTIVATION_WAIT_TIME": wait_time,
+    }
+
+
+@standup
+def condor(test_dir, slot_config, lingering_starter):
+    write_file(test_dir / "lingering_starter.py", lingering_starter)
+    with Condor(
+        local_dir=test_dir / "condor",
+        config={**slot_config, "TEST_DIR": test_dir.as_posix()},
+    ) as condor:
+        yield condor
+
+
+@action
+def startd_log(condor):
+    return condor.startd_log.open()
+
+
+@action
+def jobs(condor, path_to_sleep, startd_log):
+    # the second job runs on the first one's claim as soon as it's done
+    handle = condor.submit(
+        description={
+            "executable": path_to_sleep,
+            "arguments": "1",
+            "request_memory": "10MB",
+            "request_disk": "10MB",
+        },
+        count=2,
+    )
+
+    yield handle
+
+    handle.remove()
+
+
+@action
+def held(condor, jobs, startd_log, vacate_while_held):
+    held = startd_log.wait(
+        condition=lambda msg: "Holding request for up to" in msg, timeout=120
+    )
+    if held and vacate_while_held:
+        rv = condor.run_command(["condor_vacate"])
+        assert rv.returncode == 0
+    return held
+
+
+@action
+def finished(held, startd_log, expected_message):
+    return held and startd_log.wait(
+        condition=lambda msg: expected_message in msg, timeout=60
+    )
+
+
+class TestStartdHeldActivation:
+    def test_activation_held(self, held):
+        assert held
+
+    def test_held_activation_finished(self, finished):
+        assert finished
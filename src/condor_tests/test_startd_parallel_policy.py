@@ -0,0 +1,94 @@
+#!/usr/bin/env pytest
+
+#
+# With STARTD_POLICY_EVAL_THREADS, the startd evaluates the policy
+# expressions of its slots on several threads.  Check that jobs still
+# start on every slot when START calls a function registered from outside
+# the ClassAd library (which the threads refuse to call, leaving it to
+# the main thread), and that STARTD_SLOT_ATTRS still shows each slot the
+# state of the others.
+#
+
+import logging
+
+import htcondor
+
+from ornithology import (
+    config,
+    standup,
+    action,
+    Condor,
+    ClusterState,
+)
+
+logger = logging.getLogger(__name__)
+logger.setLevel(logging.DEBUG)
+
+NUM_SLOTS = 4
+
+
+@config
+def slot_config():
+    return {
+        "NUM_CPUS": str(NUM_SLOTS),
+        "NUM_SLOTS": str(NUM_SLOTS),
+        "STARTD_POLICY_EVAL_THREADS": str(NUM_SLOTS),
+        "STARTD_SLOT_ATTRS": "State",
+        "START": 'stringListSize("a, b") == 2',
+        "POLLING_INTERVAL": "1",
+    }
+
+
+@standup
+def condor(test_dir, slot_config):
+    with Condor(local_dir=test_dir / "condor", config=slot_config) as condor:
+        yield condor
+
+
+@action
+def running_jobs(condor, path_to_sleep):
+    handle = condor.submit(
+        description={
+            "executable": path_to_sleep,
+            "arguments": "60",
+            "request_memory": "10MB",
+            "request_disk": "10MB",
+        },
+        count=NUM_SLOTS,
+    )
+
+    assert handle.wait(
+        condition=ClusterState.all_running,
+        timeout=120,
+        fail_condition=ClusterState.any_terminal,
+    )
+
+    yield handle
+
+    handle.remove()
+
+
+@action
+def slot_ads(condor, running_jobs):
+    ads = condor.direct_status(
+        htcondor.DaemonTypes.Startd,
+        htcondor.AdTypes.Startd,
+        projection=["SlotID", "State"]
+        + ["slot{}_State".format(i) for i in range(1, NUM_SLOTS + 1)],
+    )
+    return {ad["SlotID"]: ad for ad in ads}
+
+
+class TestStartdParallelPolicy:
+    def test_registered_function_in_start(self, running_jobs):
+        assert len(running_jobs.job_ids) == NUM_SLOTS
+
+    def test_all_slots_claimed(self, slot_ads):
+        assert len(slot_ads) == NUM_SLOTS
+        for ad in slot_ads.values():
+            assert ad["State"] == "Claimed"
+
+    def test_slot_attrs_published(self, slot_ads):
+        for ad in slot_ads.values():
+            for i in range(1, NUM_SLOTS + 1):
+                assert "slot{}_State".format(i) in ad
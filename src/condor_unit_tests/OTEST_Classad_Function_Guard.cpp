@@ -0,0 +1,203 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test the guard on ClassAd functions registered from outside the
+ * ClassAd library, which the startd uses to keep its policy evaluation
+ * threads from calling functions that may not be reentrant.
+ */
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+
+#include <string>
+#include <thread>
+
+	// a registered function: twice its integer argument
+static bool
+twice_func( const char * /*name*/, const classad::ArgumentList &arg_list,
+	classad::EvalState &state, classad::Value &result )
+{
+	classad::Value arg;
+	long long num;
+	if( arg_list.size() != 1 || !arg_list[0]->Evaluate( state, arg ) ||
+		!arg.IsIntegerValue( num ) ) {
+		result.SetErrorValue();
+		return true;
+	}
+	result.SetIntegerValue( num * 2 );
+	return true;
+}
+
+static int guard_calls = 0;
+static std::string guard_name;
+
+static bool refuse_all( const char *name ) {
+	guard_calls++;
+	guard_name = name;
+	return false;
+}
+
+static bool allow_all( const char *name ) {
+	guard_calls++;
+	guard_name = name;
+	return true;
+}
+
+	// as the startd does: refuse only on the worker threads
+static thread_local bool on_worker = false;
+static bool refuse_on_worker( const char * /*name*/ ) {
+	return !on_worker;
+}
+
+	// evaluate the expression, returning its value, or -1 if it isn't
+	// an integer
+static long long eval_int( const char *expr_str ) {
+	ClassAd ad;
+	if( !ad.AssignExpr( "Value", expr_str ) ) {
+		emit_alert( "failed to parse the expression" );
+		return -2;
+	}
+	long long value = -1;
+	if( !ad.EvaluateAttrInt( "Value", value ) ) {
+		return -1;
+	}
+	return value;
+}
+
+static bool check_eval( const char *expr_str, long long expected, int expected_calls ) {
+	guard_calls = 0;
+	guard_name.clear();
+	long long value = eval_int( expr_str );
+
+	emit_output_expected_header();
+	emit_param( "value", "%lld", expected );
+	emit_param( "guard calls", "%d", expected_calls );
+	emit_output_actual_header();
+	emit_param( "value", "%lld", value );
+	emit_param( "guard calls", "%d", guard_calls );
+	return value == expected && guard_calls == expected_calls;
+}
+
+static bool test_no_guard() {
+	emit_test( "Does a registered function work when no guard is set?" );
+	emit_input_header();
+	emit_param( "expression", "%s", "unitTestTwice(21)" );
+
+	classad::FunctionCall::SetExternalFunctionGuard( NULL );
+	if( !check_eval( "unitTestTwice(21)", 42, 0 ) ) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_refused() {
+	emit_test( "Does a registered function evaluate to error when the guard refuses it?" );
+	emit_input_header();
+	emit_param( "expression", "%s", "unitTestTwice(21)" );
+	emit_param( "guard", "%s", "refuses" );
+
+	classad::FunctionCall::SetExternalFunctionGuard( refuse_all );
+	bool ok = check_eval( "unitTestTwice(21)", -1, 1 );
+	classad::FunctionCall::SetExternalFunctionGuard( NULL );
+	if( !ok || strcasecmp( guard_name.c_str(), "unitTestTwice" ) != 0 ) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_allowed() {
+	emit_test( "Does a registered function work when the guard allows it?" );
+	emit_input_header();
+	emit_param( "expression", "%s", "unitTestTwice(21)" );
+	emit_param( "guard", "%s", "allows" );
+
+	classad::FunctionCall::SetExternalFunctionGuard( allow_all );
+	bool ok = check_eval( "unitTestTwice(21)", 42, 1 );
+	classad::FunctionCall::SetExternalFunctionGuard( NULL );
+	if( !ok ) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_builtin_not_guarded() {
+	emit_test( "Are the ClassAd library's own functions called without asking the guard?" );
+	emit_input_header();
+	emit_param( "expression", "%s", "size(strcat(\"ab\", \"cd\"))" );
+	emit_param( "guard", "%s", "refuses" );
+
+	classad::FunctionCall::SetExternalFunctionGuard( refuse_all );
+	bool ok = check_eval( "size(strcat(\"ab\", \"cd\"))", 4, 0 );
+	classad::FunctionCall::SetExternalFunctionGuard( NULL );
+	if( !ok ) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_refused_on_thread() {
+	emit_test( "Can the guard refuse a registered function on one thread only?" );
+	emit_input_header();
+	emit_param( "expression", "%s", "unitTestTwice(21)" );
+	emit_param( "guard", "%s", "refuses on the second thread" );
+
+	classad::FunctionCall::SetExternalFunctionGuard( refuse_on_worker );
+	long long worker_value = 0;
+	std::thread worker( [&worker_value]() {
+		on_worker = true;
+		worker_value = eval_int( "unitTestTwice(21)" );
+	} );
+	worker.join();
+	long long main_value = eval_int( "unitTestTwice(21)" );
+	classad::FunctionCall::SetExternalFunctionGuard( NULL );
+
+	emit_output_expected_header();
+	emit_param( "second thread", "%d", -1 );
+	emit_param( "main thread", "%d", 42 );
+	emit_output_actual_header();
+	emit_param( "second thread", "%lld", worker_value );
+	emit_param( "main thread", "%lld", main_value );
+	if( worker_value != -1 || main_value != 42 ) {
+		FAIL;
+	}
+	PASS;
+}
+
+bool OTEST_Classad_Function_Guard() {
+	emit_object( "ClassAd function guard" );
+	emit_comment( "Functions registered from outside the ClassAd library may "
+		"not be reentrant.  A guard set with "
+		"FunctionCall::SetExternalFunctionGuard() is asked before each call "
+		"to one of them, and a refused call evaluates to error." );
+
+	std::string name = "unitTestTwice";
+	classad::FunctionCall::RegisterFunction( name, twice_func );
+
+	FunctionDriver driver;
+	driver.register_function( test_no_guard );
+	driver.register_function( test_refused );
+	driver.register_function( test_allowed );
+	driver.register_function( test_builtin_not_guarded );
+	driver.register_function( test_refused_on_thread );
+
+	return driver.do_all_functions();
+}
@@ -0,0 +1,293 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test the AES-GCM crypto method: sealing and opening messages, and
+ * that altered, reordered or reflected messages are refused.
+ */
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+
+#ifdef HAVE_EXT_OPENSSL
+
+#include "condor_crypt_aesgcm.h"
+
+#include <string>
+
+static const unsigned char test_key[] = "0123456789abcdef0123456789abcdef";
+
+	// the two ends of a connection
+struct CryptoPair {
+	KeyInfo key;
+	Condor_Crypto_State client;
+	Condor_Crypto_State server;
+
+	CryptoPair() :
+		key(test_key, sizeof(test_key) - 1, CONDOR_AESGCM),
+		client(CONDOR_AESGCM, key, true),
+		server(CONDOR_AESGCM, key, false)
+	{}
+};
+
+static bool seal_message(Condor_Crypto_State &state, const std::string &plain, std::string &sealed) {
+	Condor_Crypt_AESGCM aes;
+	unsigned char *output = NULL;
+	int output_len = 0;
+	if (!aes.encrypt(&state, (const unsigned char *)plain.data(), plain.size(), output, output_len)) {
+		return false;
+	}
+	sealed.assign((char *)output, output_len);
+	free(output);
+	return true;
+}
+
+static bool open_message(Condor_Crypto_State &state, const std::string &sealed, std::string &plain) {
+	Condor_Crypt_AESGCM aes;
+	unsigned char *output = NULL;
+	int output_len = 0;
+	if (!aes.decrypt(&state, (const unsigned char *)sealed.data(), sealed.size(), output, output_len)) {
+		return false;
+	}
+	plain.assign((char *)output, output_len);
+	free(output);
+	return true;
+}
+
+static bool expect_open(Condor_Crypto_State &state, const std::string &sealed,
+	const std::string &expected, bool expect_ok)
+{
+	std::string plain;
+	bool opened = open_message(state, sealed, plain);
+
+	emit_output_expected_header();
+	emit_param("opened", "%s", expect_ok ? "yes" : "no");
+	if (expect_ok) {
+		emit_param("message", "%s", expected.c_str());
+	}
+	emit_output_actual_header();
+	emit_param("opened", "%s", opened ? "yes" : "no");
+	if (opened) {
+		emit_param("message", "%s", plain.c_str());
+	}
+
+	if (opened != expect_ok) {
+		return false;
+	}
+	return !opened || plain == expected;
+}
+
+static bool test_round_trip() {
+	emit_test("Do messages sealed by each end open at the other?");
+	emit_input_header();
+	emit_param("messages", "%s", "two from the client, one from the server");
+
+	CryptoPair pair;
+	std::string first, second, reply;
+	if (!seal_message(pair.client, "first", first) ||
+		!seal_message(pair.client, "second", second) ||
+		!seal_message(pair.server, "reply", reply))
+	{
+		emit_alert("encrypt() failed");
+		FAIL;
+	}
+	if (!expect_open(pair.server, first, "first", true) ||
+		!expect_open(pair.server, second, "second", true) ||
+		!expect_open(pair.client, reply, "reply", true))
+	{
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_empty_message() {
+	emit_test("Does an empty message survive the round trip?");
+	emit_input_header();
+	emit_param("message", "%s", "");
+
+	CryptoPair pair;
+	std::string sealed;
+	if (!seal_message(pair.client, "", sealed)) {
+		emit_alert("encrypt() failed");
+		FAIL;
+	}
+	if (!expect_open(pair.server, sealed, "", true)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_altered_tag() {
+	emit_test("Is a message with an altered tag refused?");
+	emit_input_header();
+	emit_param("alteration", "%s", "last byte of the tag flipped");
+
+	CryptoPair pair;
+	std::string sealed;
+	if (!seal_message(pair.client, "secret", sealed)) {
+		emit_alert("encrypt() failed");
+		FAIL;
+	}
+	sealed[sealed.size() - 1] ^= 0x01;
+	if (!expect_open(pair.server, sealed, "", false)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_altered_data() {
+	emit_test("Is a message with altered ciphertext refused?");
+	emit_input_header();
+	emit_param("alteration", "%s", "first byte of the ciphertext flipped");
+
+	CryptoPair pair;
+	std::string sealed;
+	if (!seal_message(pair.client, "secret", sealed)) {
+		emit_alert("encrypt() failed");
+		FAIL;
+	}
+	sealed[Condor_Crypt_AESGCM::IV_SIZE] ^= 0x01;
+	if (!expect_open(pair.server, sealed, "", false)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_reordered() {
+	emit_test("Is a message that arrives out of order refused?");
+	emit_input_header();
+	emit_param("order", "%s", "first, third");
+
+	CryptoPair pair;
+	std::string first, second, third;
+	if (!seal_message(pair.client, "first", first) ||
+		!seal_message(pair.client, "second", second) ||
+		!seal_message(pair.client, "third", third))
+	{
+		emit_alert("encrypt() failed");
+		FAIL;
+	}
+	if (!expect_open(pair.server, first, "first", true) ||
+		!expect_open(pair.server, third, "third", false))
+	{
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_replayed() {
+	emit_test("Is a message that arrives twice refused the second time?");
+	emit_input_header();
+	emit_param("order", "%s", "first, first");
+
+	CryptoPair pair;
+	std::string first;
+	if (!seal_message(pair.client, "first", first)) {
+		emit_alert("encrypt() failed");
+		FAIL;
+	}
+	if (!expect_open(pair.server, first, "first", true) ||
+		!expect_open(pair.server, first, "first", false))
+	{
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_reflected() {
+	emit_test("Is a message reflected back to the end that sealed it refused?");
+	emit_input_header();
+	emit_param("sealed by", "%s", "client");
+	emit_param("opened by", "%s", "a second client with the same key");
+
+	CryptoPair pair;
+	Condor_Crypto_State other_client(CONDOR_AESGCM, pair.key, true);
+	std::string sealed;
+	if (!seal_message(pair.client, "secret", sealed)) {
+		emit_alert("encrypt() failed");
+		FAIL;
+	}
+	if (!expect_open(other_client, sealed, "", false)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_stream_state() {
+	emit_test("Does a state imported into a fresh state carry on the stream, role included?");
+	emit_input_header();
+	emit_param("exported", "%s", "server, after one message each way");
+	emit_param("imported into", "%s", "a new state made with the client role");
+
+	CryptoPair pair;
+	std::string first, reply;
+	if (!seal_message(pair.client, "first", first) ||
+		!expect_open(pair.server, first, "first", true) ||
+		!seal_message(pair.server, "reply", reply) ||
+		!expect_open(pair.client, reply, "reply", true))
+	{
+		FAIL;
+	}
+
+	unsigned char buf[Condor_Crypt_AESGCM::STREAM_STATE_SIZE];
+	Condor_Crypt_AESGCM::exportStreamState(&pair.server, buf);
+	Condor_Crypto_State inherited(CONDOR_AESGCM, pair.key, true);
+	if (!Condor_Crypt_AESGCM::importStreamState(&inherited, buf)) {
+		emit_alert("importStreamState() failed");
+		FAIL;
+	}
+
+	std::string second, reply2;
+	if (!seal_message(pair.client, "second", second) ||
+		!expect_open(inherited, second, "second", true) ||
+		!seal_message(inherited, "reply2", reply2) ||
+		!expect_open(pair.client, reply2, "reply2", true))
+	{
+		FAIL;
+	}
+	PASS;
+}
+
+#endif /* HAVE_EXT_OPENSSL */
+
+bool OTEST_Condor_Crypt_AESGCM() {
+	emit_object("Condor_Crypt_AESGCM");
+	emit_comment("Condor_Crypt_AESGCM seals whole messages with AES-256-GCM, "
+		"with a separate key for each direction and a message counter in "
+		"the nonce.");
+
+#ifndef HAVE_EXT_OPENSSL
+	emit_skipped("built without OpenSSL");
+	return true;
+#else
+	FunctionDriver driver;
+	driver.register_function(test_round_trip);
+	driver.register_function(test_empty_message);
+	driver.register_function(test_altered_tag);
+	driver.register_function(test_altered_data);
+	driver.register_function(test_reordered);
+	driver.register_function(test_replayed);
+	driver.register_function(test_reflected);
+	driver.register_function(test_stream_state);
+
+	return driver.do_all_functions();
+#endif
+}
@@ -0,0 +1,310 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test the delta ClassAds used for delta updates to the collector:
+ * making a delta and applying it, and refusing a delta made against a
+ * generation of the ad the receiver doesn't have.
+ */
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "condor_attributes.h"
+#include "classad_merge.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+
+#include <string>
+
+	// the ad as the sender first sends it
+static void base_ad(ClassAd &ad) {
+	ad.Assign("Name", "slot1@example.org");
+	ad.Assign("State", "Unclaimed");
+	ad.Assign("LoadAvg", 0.25);
+	ad.Assign("HasGpus", true);
+	ad.AssignExpr("Rank", "Owner == \"alice\"");
+}
+
+	// the same ad, some time later
+static void changed_ad(ClassAd &ad) {
+	ad.Assign("Name", "slot1@example.org");
+	ad.Assign("State", "Claimed");
+	ad.Assign("LoadAvg", 1.0);
+	ad.AssignExpr("Rank", "Owner == \"alice\"");
+	ad.AssignExpr("Busy", "State == \"Claimed\"");
+}
+
+	// do the two ads have the same attributes, with the same values?
+static bool same_ads(ClassAd &expected, ClassAd &actual) {
+	std::string expected_str, actual_str;
+	sPrintAd(expected_str, expected);
+	sPrintAd(actual_str, actual);
+	emit_output_expected_header();
+	emit_param("ad", "%s", expected_str.c_str());
+	emit_output_actual_header();
+	emit_param("ad", "%s", actual_str.c_str());
+
+	if (expected.size() != actual.size()) {
+		return false;
+	}
+	for (auto itr = expected.begin(); itr != expected.end(); itr++) {
+		ExprTree *expr = actual.Lookup(itr->first);
+		if (!expr || !expr->SameAs(itr->second)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+	// what a daemon sends: the delta from base to next, made against
+	// generation base_gen, where next is generation gen
+static void make_update(ClassAd &base, long long base_gen, ClassAd &next,
+	long long gen, ClassAd &delta)
+{
+	base.Assign(ATTR_UPDATE_GENERATION, base_gen);
+	next.Assign(ATTR_UPDATE_GENERATION, gen);
+	std::string removed;
+	MakeDeltaClassAd(base, next, delta, removed);
+	CopyAttribute(ATTR_NAME, delta, next);
+	delta.Assign(ATTR_UPDATE_DELTA_BASE, base_gen);
+	if (!removed.empty()) {
+		delta.Assign(ATTR_UPDATE_DELTA_REMOVED, removed);
+	}
+}
+
+static bool test_round_trip() {
+	emit_test("Does applying a delta to its base ad give the new ad?");
+	emit_input_header();
+	emit_param("changes", "%s", "State and LoadAvg changed, HasGpus removed, Busy added");
+
+	ClassAd base, next, delta;
+	base_ad(base);
+	changed_ad(next);
+	std::string removed;
+	int changed = MakeDeltaClassAd(base, next, delta, removed);
+
+	emit_output_expected_header();
+	emit_param("changed", "%d", 4);
+	emit_param("removed", "%s", "HasGpus");
+	emit_output_actual_header();
+	emit_param("changed", "%d", changed);
+	emit_param("removed", "%s", removed.c_str());
+	if (changed != 4 || removed != "HasGpus" || delta.size() != 3) {
+		FAIL;
+	}
+
+	ClassAd received(base);
+	AttrNameSet ignore;
+	ApplyDeltaClassAd(received, delta, removed.c_str(), ignore);
+	if (!same_ads(next, received)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_no_change() {
+	emit_test("Is the delta between two identical ads empty?");
+	ClassAd base, next, delta;
+	base_ad(base);
+	base_ad(next);
+	std::string removed;
+	int changed = MakeDeltaClassAd(base, next, delta, removed);
+
+	emit_output_expected_header();
+	emit_param("changed", "%d", 0);
+	emit_output_actual_header();
+	emit_param("changed", "%d", changed);
+	if (changed != 0 || delta.size() != 0 || !removed.empty()) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_ignore() {
+	emit_test("Are the attributes in the ignore set left out when a delta is applied?");
+	emit_input_header();
+	emit_param("ignore", "%s", ATTR_UPDATE_DELTA_BASE);
+
+	ClassAd base, next, delta;
+	base_ad(base);
+	changed_ad(next);
+	std::string removed;
+	MakeDeltaClassAd(base, next, delta, removed);
+	delta.Assign(ATTR_UPDATE_DELTA_BASE, 1);
+
+	ClassAd received(base);
+	AttrNameSet ignore = { ATTR_UPDATE_DELTA_BASE };
+	ApplyDeltaClassAd(received, delta, removed.c_str(), ignore);
+	if (!same_ads(next, received)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_dirty() {
+	emit_test("Does a delta made from the dirty attributes match a full comparison?");
+	emit_input_header();
+	emit_param("dirty", "%s", "LoadAvg changed, State assigned its old value");
+
+	ClassAd base, next;
+	base_ad(base);
+	base_ad(next);
+	next.ClearAllDirtyFlags();
+	next.EnableDirtyTracking();
+	next.Assign("LoadAvg", 2.5);
+	next.Assign("State", "Unclaimed");
+
+	ClassAd sender_base(base), delta;
+	int changed = MakeDeltaClassAdFromDirty(sender_base, next, delta);
+
+	emit_output_expected_header();
+	emit_param("changed", "%d", 1);
+	emit_output_actual_header();
+	emit_param("changed", "%d", changed);
+	if (changed != 1 || delta.size() != 1 || !delta.Lookup("LoadAvg")) {
+		FAIL;
+	}
+	if (!same_ads(next, sender_base)) {
+		FAIL;
+	}
+
+	ClassAd received(base);
+	AttrNameSet ignore;
+	ApplyDeltaClassAd(received, delta, "", ignore);
+	if (!same_ads(next, received)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_dirty_removed() {
+	emit_test("Does a delta from the dirty attributes refuse an ad that lost an attribute?");
+	emit_input_header();
+	emit_param("dirty", "%s", "LoadAvg changed, HasGpus deleted");
+
+	ClassAd base, next;
+	base_ad(base);
+	base_ad(next);
+	next.ClearAllDirtyFlags();
+	next.EnableDirtyTracking();
+	next.Assign("LoadAvg", 2.5);
+	next.Delete("HasGpus");
+
+	ClassAd sender_base(base), delta;
+	int changed = MakeDeltaClassAdFromDirty(sender_base, next, delta);
+
+	emit_output_expected_header();
+	emit_param("changed", "%d", -1);
+	emit_output_actual_header();
+	emit_param("changed", "%d", changed);
+	if (changed != -1) {
+		FAIL;
+	}
+	if (!same_ads(base, sender_base)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_expand_matching_generation() {
+	emit_test("Is a delta made against the generation the receiver has applied?");
+	emit_input_header();
+	emit_param("stored generation", "%d", 1);
+	emit_param("delta against", "%d", 1);
+
+	ClassAd stored, next, delta;
+	base_ad(stored);
+	changed_ad(next);
+	make_update(stored, 1, next, 2, delta);
+
+	ClassAd full;
+	if (!ExpandDeltaClassAd(stored, delta, full)) {
+		emit_alert("ExpandDeltaClassAd() refused the delta");
+		FAIL;
+	}
+	if (!same_ads(next, full)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_resync() {
+	emit_test("Is a delta against a lost generation refused, and the next one "
+		"after a full update applied?");
+	emit_input_header();
+	emit_param("stored generation", "%d", 1);
+	emit_param("lost update", "%s", "generation 2");
+	emit_param("delta against", "%d", 2);
+
+		// generation 2 never reaches the receiver
+	ClassAd stored, second, third, delta;
+	base_ad(stored);
+	stored.Assign(ATTR_UPDATE_GENERATION, 1);
+	changed_ad(second);
+	changed_ad(third);
+	third.Assign("LoadAvg", 3.0);
+	make_update(second, 2, third, 3, delta);
+
+	ClassAd full;
+	bool applied = ExpandDeltaClassAd(stored, delta, full);
+	emit_output_expected_header();
+	emit_param("applied", "%s", "no");
+	emit_output_actual_header();
+	emit_param("applied", "%s", applied ? "yes" : "no");
+	if (applied) {
+		FAIL;
+	}
+
+		// so the receiver asks for the whole ad, and the delta after
+		// that one applies
+	stored = third;
+	ClassAd fourth, next_delta;
+	changed_ad(fourth);
+	fourth.Assign("State", "Unclaimed");
+	make_update(third, 3, fourth, 4, next_delta);
+
+	ClassAd full2;
+	if (!ExpandDeltaClassAd(stored, next_delta, full2)) {
+		emit_alert("ExpandDeltaClassAd() refused the delta after the resync");
+		FAIL;
+	}
+	if (!same_ads(fourth, full2)) {
+		FAIL;
+	}
+	PASS;
+}
+
+bool OTEST_Delta_Classads() {
+	emit_object("Delta ClassAds");
+	emit_comment("Daemons updating the collector with deltas send only the "
+		"attributes that changed since the previous update, tagged with the "
+		"generation of the ad they were made against.  The collector applies "
+		"a delta only to that generation.");
+
+	FunctionDriver driver;
+	driver.register_function(test_round_trip);
+	driver.register_function(test_no_change);
+	driver.register_function(test_ignore);
+	driver.register_function(test_dirty);
+	driver.register_function(test_dirty_removed);
+	driver.register_function(test_expand_matching_generation);
+	driver.register_function(test_resync);
+
+	return driver.do_all_functions();
+}
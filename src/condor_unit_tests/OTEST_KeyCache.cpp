@@ -0,0 +1,128 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test the expiry queue of the security session cache.
+ */
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "KeyCache.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+
+#include <string>
+
+	// add a session that expires the given number of seconds from now
+static bool insert_session( KeyCache &cache, const char *id, int expires_in ) {
+	ClassAd policy;
+	KeyCacheEntry entry( id, NULL, NULL, &policy, (int)time(NULL) + expires_in, 0 );
+	return cache.insert( entry );
+}
+
+	// the expired session ids, comma separated, as getExpiredKeys()
+	// returns them
+static std::string expired_keys( KeyCache &cache ) {
+	StringList *list = cache.getExpiredKeys();
+	char *str = list->print_to_string();
+	std::string result = str ? str : "";
+	free( str );
+	delete list;
+	return result;
+}
+
+static bool check_expired( KeyCache &cache, const char *expected ) {
+	std::string actual = expired_keys( cache );
+	emit_output_expected_header();
+	emit_param( "expired", "%s", expected );
+	emit_output_actual_header();
+	emit_param( "expired", "%s", actual.c_str() );
+	return actual == expected;
+}
+
+static bool test_expired_reported() {
+	emit_test( "Does getExpiredKeys() report the sessions that have expired, and only those?" );
+	emit_input_header();
+	emit_param( "old", "%s", "expired 10 seconds ago" );
+	emit_param( "new", "%s", "expires in an hour" );
+
+	KeyCache cache;
+	if( !insert_session( cache, "old", -10 ) || !insert_session( cache, "new", 3600 ) ) {
+		emit_alert( "insert() failed" );
+		FAIL;
+	}
+	if( !check_expired( cache, "old" ) ) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_kept_reported_again() {
+	emit_test( "Is an expired session that was not removed reported again?" );
+	emit_input_header();
+	emit_param( "old", "%s", "expired 10 seconds ago, left in the cache" );
+
+	KeyCache cache;
+	if( !insert_session( cache, "old", -10 ) ) {
+		emit_alert( "insert() failed" );
+		FAIL;
+	}
+	if( !check_expired( cache, "old" ) || !check_expired( cache, "old" ) ) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_removed_not_reported() {
+	emit_test( "Is an expired session that was removed not reported again?" );
+	emit_input_header();
+	emit_param( "old", "%s", "expired 10 seconds ago, then removed" );
+
+	KeyCache cache;
+	if( !insert_session( cache, "old", -10 ) ) {
+		emit_alert( "insert() failed" );
+		FAIL;
+	}
+	if( !check_expired( cache, "old" ) ) {
+		FAIL;
+	}
+	cache.remove( "old" );
+	if( !check_expired( cache, "" ) ) {
+		FAIL;
+	}
+	emit_param( "expiry queue size", "%d", cache.expiryQueueSize() );
+	if( cache.expiryQueueSize() != 0 ) {
+		FAIL;
+	}
+	PASS;
+}
+
+bool OTEST_KeyCache() {
+	emit_object( "KeyCache" );
+	emit_comment( "The security session cache keeps its sessions in a queue "
+		"ordered by expiration, so that getExpiredKeys() need not look at "
+		"every session." );
+
+	FunctionDriver driver;
+	driver.register_function( test_expired_reported );
+	driver.register_function( test_kept_reported_again );
+	driver.register_function( test_removed_not_reported );
+
+	return driver.do_all_functions();
+}
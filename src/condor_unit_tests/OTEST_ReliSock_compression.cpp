@@ -0,0 +1,271 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test the framing of compressed ReliSock messages over a loopback
+ * socket pair.
+ */
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "reli_sock.h"
+#include "CryptKey.h"
+#include "condor_secman.h"
+#include "condor_commands.h"
+#include "command_strings.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+
+#include <string>
+
+static const unsigned char test_key[] = "0123456789abcdef0123456789abcdef";
+
+	// connect a pair of sockets and turn on compression (and optionally
+	// encryption) on both ends
+static bool setup_pair(ReliSock &client, ReliSock &server, Protocol crypto) {
+	if (!client.connect_socketpair(server)) {
+		emit_alert("connect_socketpair() failed");
+		return false;
+	}
+	client.timeout(10);
+	server.timeout(10);
+	if (crypto != CONDOR_NO_PROTOCOL) {
+		KeyInfo key(test_key, sizeof(test_key) - 1, crypto);
+		if (!client.set_crypto_key(true, &key) || !server.set_crypto_key(true, &key)) {
+			emit_alert("set_crypto_key() failed");
+			return false;
+		}
+	}
+	if (!client.set_compression(true) || !server.set_compression(true)) {
+		emit_alert("set_compression() failed");
+		return false;
+	}
+	return true;
+}
+
+	// send an int and a string as one message
+static bool send_message(ReliSock &sock, int num, const std::string &str) {
+	sock.encode();
+	std::string copy = str;
+	return sock.code(num) && sock.code(copy) && sock.end_of_message();
+}
+
+static bool receive_message(ReliSock &sock, int expected_num, const std::string &expected_str) {
+	int num = -1;
+	std::string str;
+	sock.decode();
+	bool ok = sock.code(num) && sock.code(str) && sock.end_of_message();
+
+	emit_output_expected_header();
+	emit_param("int", "%d", expected_num);
+	emit_param("string length", "%d", (int)expected_str.size());
+	emit_output_actual_header();
+	emit_param("received", "%s", ok ? "yes" : "NO");
+	emit_param("int", "%d", num);
+	emit_param("string length", "%d", (int)str.size());
+
+	return ok && num == expected_num && str == expected_str;
+}
+
+	// some repetitive data, so that it actually compresses, and is
+	// bigger than one compression buffer
+static std::string payload(int n) {
+	std::string str;
+	for (int i = 0; i < 2000; i++) {
+		str += "line ";
+		str += std::to_string((i * n) % 97);
+		str += " of the compressed payload\n";
+	}
+	return str;
+}
+
+static bool round_trip(Protocol crypto) {
+	ReliSock client, server;
+	if (!setup_pair(client, server, crypto)) {
+		return false;
+	}
+	for (int i = 1; i <= 3; i++) {
+		if (!send_message(client, i, payload(i))) {
+			emit_alert("send failed");
+			return false;
+		}
+		if (!receive_message(server, i, payload(i))) {
+			return false;
+		}
+	}
+		// and the other way
+	if (!send_message(server, 42, "reply")) {
+		emit_alert("send failed");
+		return false;
+	}
+	return receive_message(client, 42, "reply");
+}
+
+static bool test_compressed_messages() {
+	emit_test("Do several compressed messages arrive intact in both directions?");
+	emit_input_header();
+	emit_param("encryption", "%s", "none");
+	if (!round_trip(CONDOR_NO_PROTOCOL)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_compressed_encrypted_messages() {
+	emit_test("Do compressed messages arrive intact when the socket is also encrypted?");
+	emit_input_header();
+	emit_param("encryption", "%s", "BLOWFISH");
+	if (!round_trip(CONDOR_BLOWFISH)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_compressed_aes_messages() {
+	emit_test("Do compressed messages arrive intact when the socket is sealed with AES-GCM?");
+	emit_input_header();
+	emit_param("encryption", "%s", "AES");
+#ifndef HAVE_EXT_OPENSSL
+	emit_skipped("built without OpenSSL");
+	PASS;
+#else
+	if (!round_trip(CONDOR_AESGCM)) {
+		FAIL;
+	}
+	PASS;
+#endif
+}
+
+static bool test_partial_read() {
+	emit_test("Does end_of_message() skip the unread rest of a compressed message?");
+	ReliSock client, server;
+	if (!setup_pair(client, server, CONDOR_NO_PROTOCOL)) {
+		FAIL;
+	}
+	emit_input_header();
+	emit_param("message 1", "%s", "int and a long string, only the int is read");
+	emit_param("message 2", "%s", "int and a short string");
+	if (!send_message(client, 1, payload(1)) || !send_message(client, 2, "second")) {
+		emit_alert("send failed");
+		FAIL;
+	}
+
+	int num = -1;
+	server.decode();
+	if (!server.code(num) || num != 1 || !server.end_of_message()) {
+		emit_alert("failed to read the first int");
+		FAIL;
+	}
+	if (!receive_message(server, 2, "second")) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_copy_continues_stream() {
+	emit_test("Does a copy of a compressed ReliSock carry on decompressing the stream?");
+	ReliSock client, server;
+	if (!setup_pair(client, server, CONDOR_NO_PROTOCOL)) {
+		FAIL;
+	}
+	emit_input_header();
+	emit_param("message 1", "%s", "read by the original");
+	emit_param("message 2", "%s", "read by the copy");
+	if (!send_message(client, 1, payload(1)) || !receive_message(server, 1, payload(1))) {
+		FAIL;
+	}
+
+	ReliSock *copy = new ReliSock(server);
+	copy->timeout(10);
+	bool ok = send_message(client, 2, payload(2)) && receive_message(*copy, 2, payload(2));
+	delete copy;
+	if (!ok) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_serialize_refused() {
+	emit_test("Does serialize() refuse a compressed socket?");
+	ReliSock client, server;
+	if (!setup_pair(client, server, CONDOR_NO_PROTOCOL)) {
+		FAIL;
+	}
+	char *state = server.serialize();
+	emit_output_expected_header();
+	emit_param("serialize()", "%s", "NULL");
+	emit_output_actual_header();
+	emit_param("serialize()", "%s", state ? state : "NULL");
+	if (state) {
+		delete [] state;
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_passed_on_commands() {
+	emit_test("Is compression left off for the commands whose sockets are passed to another process?");
+	struct { int cmd; bool allowed; } cmds[] = {
+		{ACTIVATE_CLAIM, false},
+		{QUERY_SCHEDD_HISTORY, false},
+		{GET_HISTORY, false},
+		{REPLICATION_TRANSFER_FILE_NEW, false},
+		{QUERY_STARTD_ADS, true},
+	};
+	bool ok = true;
+	emit_output_expected_header();
+	for (auto &c : cmds) {
+		emit_param(getCommandStringSafe(c.cmd), "%s", c.allowed ? "allowed" : "refused");
+	}
+	emit_output_actual_header();
+	for (auto &c : cmds) {
+		bool allowed = SecMan::commandAllowsCompression(c.cmd);
+		emit_param(getCommandStringSafe(c.cmd), "%s", allowed ? "allowed" : "refused");
+		if (allowed != c.allowed) {
+			ok = false;
+		}
+	}
+	if (!ok) {
+		FAIL;
+	}
+	PASS;
+}
+
+bool OTEST_ReliSock_compression() {
+	emit_object("ReliSock compression");
+	emit_comment("A ReliSock can compress its messages with zlib, underneath "
+		"any encryption.  These tests send messages over a loopback socket "
+		"pair with compression turned on at both ends.");
+
+#if !defined(HAVE_LIBZ)
+	emit_skipped("built without zlib");
+	return true;
+#endif
+
+	FunctionDriver driver;
+	driver.register_function(test_compressed_messages);
+	driver.register_function(test_compressed_encrypted_messages);
+	driver.register_function(test_compressed_aes_messages);
+	driver.register_function(test_partial_read);
+	driver.register_function(test_copy_continues_stream);
+	driver.register_function(test_serialize_refused);
+	driver.register_function(test_passed_on_commands);
+
+	return driver.do_all_functions();
+}
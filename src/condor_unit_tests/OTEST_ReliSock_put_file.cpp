@@ -0,0 +1,170 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2020, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test ReliSock::put_file() over a loopback socket pair, in particular
+ * what it sends when the file is truncated while it is being sent.
+ */
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "reli_sock.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+
+#include <thread>
+
+static const char *test_file = "tmp_put_file_test";
+
+	// the file is big enough that the sender is still busy, well past
+	// the point we cut it to, when the receiver has read that much
+static const int file_words = 16 * 1024 * 1024;
+static const int truncate_bytes = 8 * 1024 * 1024;
+static const int block_words = 1024;
+
+	// each 32-bit word of the test file holds its own index, so any
+	// data sent from the wrong place in the file shows up
+static bool write_test_file() {
+	int fd = safe_open_wrapper_follow( test_file, O_WRONLY | O_CREAT | O_TRUNC, 0600 );
+	if( fd < 0 ) {
+		emit_alert( "failed to create the test file" );
+		return false;
+	}
+	uint32_t block[block_words];
+	for( int i = 0; i < file_words; i += block_words ) {
+		for( int j = 0; j < block_words; j++ ) {
+			block[j] = i + j;
+		}
+		if( full_write( fd, block, sizeof(block) ) != (int)sizeof(block) ) {
+			emit_alert( "failed to write the test file" );
+			close( fd );
+			return false;
+		}
+	}
+	close( fd );
+	return true;
+}
+
+static bool test_truncated_while_sending( const char *zero_copy ) {
+	emit_input_header();
+	emit_param( "file size", "%d", file_words * 4 );
+	emit_param( "truncated to", "%d", truncate_bytes );
+	emit_param( "ENABLE_ZERO_COPY_FILE_TRANSFER", "%s", zero_copy );
+
+	param_insert( "ENABLE_ZERO_COPY_FILE_TRANSFER", zero_copy );
+	if( !write_test_file() ) {
+		return false;
+	}
+	int fd = safe_open_wrapper_follow( test_file, O_RDONLY );
+	if( fd < 0 ) {
+		emit_alert( "failed to open the test file" );
+		return false;
+	}
+
+	ReliSock client, server;
+	if( !client.connect_socketpair( server ) ) {
+		emit_alert( "connect_socketpair() failed" );
+		close( fd );
+		return false;
+	}
+	client.timeout( 10 );
+	server.timeout( 10 );
+
+	int put_rc = 0;
+	std::thread sender( [&client, &put_rc, fd]() {
+		filesize_t size = 0;
+		client.encode();
+		put_rc = client.put_file( &size, fd, 0 );
+		client.close();
+	} );
+
+	filesize_t announced = 0;
+	server.decode();
+	server.code( announced );
+	server.end_of_message();
+
+		// read a block at a time, checking that each word is where it
+		// belongs; once truncate_bytes are in, cut the file down to
+		// that much
+	long long received = 0;
+	long long misplaced = 0;
+	uint32_t block[block_words];
+	while( server.get_bytes_nobuffer( (char *)block, sizeof(block), 0 ) == (int)sizeof(block) ) {
+		for( int j = 0; j < block_words; j++ ) {
+			if( block[j] != (uint32_t)(received / 4 + j) ) {
+				misplaced++;
+			}
+		}
+		received += sizeof(block);
+		if( received == truncate_bytes ) {
+			if( truncate( test_file, truncate_bytes ) < 0 ) {
+				emit_alert( "failed to truncate the test file" );
+			}
+		}
+	}
+
+	sender.join();
+	close( fd );
+	unlink( test_file );
+	param_insert( "ENABLE_ZERO_COPY_FILE_TRANSFER", "true" );
+
+	emit_output_expected_header();
+	emit_param( "put_file()", "%s", "< 0" );
+	emit_param( "bytes announced", "%d", file_words * 4 );
+	emit_param( "misplaced words", "%d", 0 );
+	emit_output_actual_header();
+	emit_param( "put_file()", "%d", put_rc );
+	emit_param( "bytes announced", "%lld", (long long)announced );
+	emit_param( "bytes received", "%lld", received );
+	emit_param( "misplaced words", "%lld", misplaced );
+
+	return put_rc < 0 && announced == (filesize_t)file_words * 4 &&
+		received < announced && misplaced == 0;
+}
+
+static bool test_truncated_sendfile() {
+	emit_test( "Does put_file() fail, rather than resend the start of the file, "
+		"when the file shrinks during a sendfile() transfer?" );
+	if( !test_truncated_while_sending( "true" ) ) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_truncated_read() {
+	emit_test( "Does put_file() fail when the file shrinks during a read() transfer?" );
+	if( !test_truncated_while_sending( "false" ) ) {
+		FAIL;
+	}
+	PASS;
+}
+
+bool OTEST_ReliSock_put_file() {
+	emit_object( "ReliSock put_file" );
+	emit_comment( "put_file() announces the size of the file, then sends its "
+		"contents, with sendfile() on Linux when the socket isn't encrypted.  "
+		"If the file shrinks part way through, it must fail rather than send "
+		"anything but the file's own bytes in order." );
+
+	FunctionDriver driver;
+	driver.register_function( test_truncated_sendfile );
+	driver.register_function( test_truncated_read );
+
+	return driver.do_all_functions();
+}
@@ -63,6 +63,12 @@ bool OTEST_TmpDir(void);
 bool OTEST_StatInfo(void);
 bool OTEST_condor_sockaddr();
 bool OTEST_ranger();
+bool OTEST_ReliSock_compression();
+bool OTEST_ReliSock_put_file();
+bool OTEST_Condor_Crypt_AESGCM();
+bool OTEST_Delta_Classads();
+bool OTEST_Classad_Function_Guard();
+bool OTEST_KeyCache();
 
 	// function map that maps testing function names to testing functions
 const static struct {
@@ -98,6 +104,12 @@ const static struct {
 	map(OTEST_StatInfo),
 	map(OTEST_condor_sockaddr),
 	map(OTEST_ranger),
+	map(OTEST_ReliSock_compression),
+	map(OTEST_ReliSock_put_file),
+	map(OTEST_Condor_Crypt_AESGCM),
+	map(OTEST_Delta_Classads),
+	map(OTEST_Classad_Function_Guard),
+	map(OTEST_KeyCache),
 };
 int function_map_num_elems = sizeof(function_map) / sizeof(function_map[0]);
 
@@ -24,6 +24,9 @@
 #include "condor_attributes.h"
 #include "internet.h"
 
+#include <algorithm>
+#include <functional>
+
 KeyCacheEntry::KeyCacheEntry( char const *id_param, const condor_sockaddr * addr_param, KeyInfo* key_param, ClassAd * policy_param, int expiration_param, int lease_interval ) {
 	if (id_param) {
 		_id = strdup(id_param);
@@ -53,6 +56,8 @@ KeyCacheEntry::KeyCacheEntry( char const *id_param, const condor_sockaddr * addr
 	_lease_interval = lease_interval;
 	_lease_expiration = 0;
 	_lingering = false;
+	_queued_expiration = 0;
+	_footprint = 0;
 	renewLease();
 }
 
@@ -123,6 +128,29 @@ void KeyCacheEntry::renewLease() {
 	}
 }
 
+size_t KeyCacheEntry::footprint() const {
+		// This is an estimate; the allocator overhead and the internals
+		// of the policy ad are not visible from here.
+	size_t bytes = sizeof(*this);
+	if (_id) {
+		bytes += strlen(_id) + 1;
+	}
+	if (_addr) {
+		bytes += sizeof(*_addr);
+	}
+	if (_key) {
+		bytes += sizeof(*_key) + _key->getKeyLength();
+	}
+	if (_policy) {
+		bytes += sizeof(*_policy);
+		for (auto itr = _policy->begin(); itr != _policy->end(); itr++) {
+				// name, expression node and hash bucket
+			bytes += itr->first.size() + 64;
+		}
+	}
+	return bytes;
+}
+
 void KeyCacheEntry::copy_storage(const KeyCacheEntry &copy) {
 	if (copy._id) {
 		_id = strdup(copy._id);
@@ -152,6 +180,8 @@ void KeyCacheEntry::copy_storage(const KeyCacheEntry &copy) {
 	_lease_interval = copy._lease_interval;
 	_lease_expiration = copy._lease_expiration;
 	_lingering = copy._lingering;
+	_queued_expiration = 0;
+	_footprint = 0;
 }
 
 
@@ -171,22 +201,16 @@ void KeyCacheEntry::delete_storage() {
 }
 
 
-KeyCache::KeyCache() {
-	key_table = new HashTable<MyString, KeyCacheEntry*>(hashFunction);
-	m_index = new KeyCacheIndex(hashFunction);
-	dprintf ( D_SECURITY|D_FULLDEBUG, "KEYCACHE: created: %p\n", key_table );
+KeyCache::KeyCache() : m_entry_bytes(0), m_index_bytes(0), m_queue_id_bytes(0) {
+	dprintf ( D_SECURITY|D_FULLDEBUG, "KEYCACHE: created: %p\n", this );
 }
 
-KeyCache::KeyCache(const KeyCache& k) {
-	key_table = new HashTable<MyString, KeyCacheEntry*>(hashFunction);
-	m_index = new KeyCacheIndex(hashFunction);
+KeyCache::KeyCache(const KeyCache& k) : m_entry_bytes(0), m_index_bytes(0), m_queue_id_bytes(0) {
 	copy_storage(k);
 }
 
 KeyCache::~KeyCache() {
 	delete_storage();
-	delete key_table;
-	delete m_index;
 }
 	    
 const KeyCache& KeyCache::operator=(const KeyCache& k) {
@@ -199,42 +223,29 @@ const KeyCache& KeyCache::operator=(const KeyCache& k) {
 
 
 void KeyCache::copy_storage(const KeyCache &copy) {
-	dprintf ( D_SECURITY|D_FULLDEBUG, "KEYCACHE: created: %p\n", key_table );
+	dprintf ( D_SECURITY|D_FULLDEBUG, "KEYCACHE: created: %p\n", this );
 
 	// manually iterate all entries from the hash.  they are
 	// pointers, and we need to copy that object.
-	KeyCacheEntry* key_entry;
-	copy.key_table->startIterations();
-	while (copy.key_table->iterate(key_entry)) {
-		insert(*key_entry);
+	for (auto itr = copy.key_table.begin(); itr != copy.key_table.end(); itr++) {
+		insert(*itr->second);
 	}
 }
 
 
 void KeyCache::delete_storage()
 {
-	if( key_table ) {
-			// Delete all entries from the hash
-		KeyCacheEntry* key_entry;
-		key_table->startIterations();
-		while( key_table->iterate(key_entry) ) {
-			if( key_entry ) {
-				delete key_entry;
-			}
-		}
-		key_table->clear();
-		dprintf( D_SECURITY|D_FULLDEBUG, "KEYCACHE: deleted: %p\n", key_table );
-	}
-	if( m_index ) {
-		MyString index;
-		SimpleList<KeyCacheEntry *> *keylist=NULL;
-
-		m_index->startIterations();
-		while( m_index->iterate(index,keylist) ) {
-			delete keylist;
-		}
-		m_index->clear();
+		// Delete all entries from the hash
+	for (auto itr = key_table.begin(); itr != key_table.end(); itr++) {
+		delete itr->second;
 	}
+	key_table.clear();
+	m_index.clear();
+	m_expiry_queue.clear();
+	m_entry_bytes = 0;
+	m_index_bytes = 0;
+	m_queue_id_bytes = 0;
+	dprintf( D_SECURITY|D_FULLDEBUG, "KEYCACHE: deleted: %p\n", this );
 }
 
 
@@ -245,28 +256,25 @@ void KeyCache::clear()
 
 bool KeyCache::insert(KeyCacheEntry &e) {
 
-	// the key_table member is a HashTable which maps
-	// MyString's to KeyCacheEntry*'s.  (note the '*')
+	// the key_table member is a hash map which maps
+	// session ids to KeyCacheEntry*'s.  (note the '*')
 
-	// the map_table member is a HashTable which maps
-	// MyString's to MyString's.
+	if (!e.id() || key_table.find(e.id()) != key_table.end()) {
+		return false;
+	}
 
 	// create a new entry
 	KeyCacheEntry *new_ent = new KeyCacheEntry(e);
 
 	// stick a pointer to the entry in the table
-	// NOTE: HashTable's insert returns ZERO on SUCCESS!!!
-	bool retval = (key_table->insert(new_ent->id(), new_ent) == 0);
+	key_table[new_ent->id()] = new_ent;
+	addToIndex(new_ent);
+	queueExpiration(new_ent);
 
-	if (!retval) {
-		// key was not inserted... delete
-		delete new_ent;
-	}
-	else {
-		addToIndex(new_ent);
-	}
+	new_ent->_footprint = new_ent->footprint();
+	m_entry_bytes += new_ent->_footprint;
 
-	return retval;
+	return true;
 }
 
 void
@@ -286,17 +294,17 @@ bool KeyCache::lookup(const char *key_id, KeyCacheEntry *&e_ptr) {
 	// use a temp pointer so that e_ptr is not modified
 	// if a match is not found
 
-	KeyCacheEntry *tmp_ptr = NULL;
-
-	// NOTE: HashTable's lookup returns ZERO on SUCCESS
-	bool res = (key_table->lookup(key_id, tmp_ptr) == 0);
-
-	if (res) {
-		// hand over the pointer
-		e_ptr = tmp_ptr;
+	if (!key_id) {
+		return false;
+	}
+	auto itr = key_table.find(key_id);
+	if (itr == key_table.end()) {
+		return false;
 	}
 
-	return res;
+	// hand over the pointer
+	e_ptr = itr->second;
+	return true;
 }
 
 void
@@ -315,11 +323,11 @@ KeyCache::addToIndex(KeyCacheEntry *key)
 
 	if (key->addr())
 		peer_addr = key->addr()->to_sinful();
-	addToIndex(m_index,peer_addr,key);
-	addToIndex(m_index,server_addr,key);
+	addToIndex(&m_index,peer_addr,key);
+	addToIndex(&m_index,server_addr,key);
 
 	makeServerUniqueId(parent_id,server_pid,&server_unique_id);
-	addToIndex(m_index,server_unique_id,key);
+	addToIndex(&m_index,server_unique_id,key);
 }
 
 void
@@ -339,11 +347,11 @@ KeyCache::removeFromIndex(KeyCacheEntry *key)
 
 	if (key->addr())
 		peer_addr = key->addr()->to_sinful();
-	removeFromIndex(m_index,peer_addr,key);
-	removeFromIndex(m_index,server_addr,key);
+	removeFromIndex(&m_index,peer_addr,key);
+	removeFromIndex(&m_index,server_addr,key);
 
 	makeServerUniqueId(parent_id,server_pid,&server_unique_id);
-	removeFromIndex(m_index,server_unique_id,key);
+	removeFromIndex(&m_index,server_unique_id,key);
 }
 
 void
@@ -354,53 +362,58 @@ KeyCache::addToIndex(KeyCacheIndex *hash,MyString const &index,KeyCacheEntry *ke
 	}
 	ASSERT( key );
 
-	SimpleList<KeyCacheEntry *> *keylist=NULL;
-	if( hash->lookup(index,keylist)!=0 ) {
-		keylist = new SimpleList<KeyCacheEntry *>;
-		ASSERT( keylist );
-		bool inserted = hash->insert(index,keylist)==0;
-		ASSERT(inserted);
+	auto itr = hash->find(index.Value());
+	if( itr == hash->end() ) {
+		itr = hash->emplace(index.Value(), std::unordered_set<KeyCacheEntry *>()).first;
+		m_index_bytes += indexNodeBytes(itr->first);
+	}
+	if( itr->second.insert(key).second ) {
+		m_index_bytes += indexMemberBytes();
 	}
-	bool appended = keylist->Append(key);
-	ASSERT( appended );
 }
 
 void
 KeyCache::removeFromIndex(KeyCacheIndex *hash,MyString const &index,KeyCacheEntry *key)
 {
-	SimpleList<KeyCacheEntry *> *keylist=NULL;
-	if( hash->lookup(index,keylist)!=0 ) {
+	auto itr = hash->find(index.Value());
+	if( itr == hash->end() ) {
 		return;
 	}
-	bool deleted = keylist->Delete(key);
+	bool deleted = itr->second.erase(key) > 0;
 	ASSERT( deleted );
+	m_index_bytes -= indexMemberBytes();
 
-	if( keylist->Length() == 0 ) {
-		delete keylist;
-		bool removed = hash->remove(index)==0;
-		ASSERT( removed );
+	if( itr->second.empty() ) {
+		m_index_bytes -= indexNodeBytes(itr->first);
+		hash->erase(itr);
 	}
 }
 
 bool KeyCache::remove(const char *key_id) {
 	// to remove a key:
 	// you first need to do a lookup, so we can get the pointer to delete.
-	KeyCacheEntry *tmp_ptr = NULL;
+	if (!key_id) {
+		return false;
+	}
+	auto itr = key_table.find(key_id);
+	if (itr == key_table.end()) {
+		return false;
+	}
+	KeyCacheEntry *tmp_ptr = itr->second;
 
-	// NOTE: HashTable's lookup returns ZERO on SUCCESS
-	bool res = (key_table->lookup(key_id, tmp_ptr) == 0);
+	removeFromIndex( tmp_ptr );
+	m_entry_bytes -= tmp_ptr->_footprint;
 
-	if (res) {
-		removeFromIndex( tmp_ptr );
+	// ** HEY **
+	// key_id could be pointing to the string tmp_ptr->id.  so, we'd
+	// better finish using key_id *before* we delete tmp_ptr.
+	// Any item for this entry in the expiry queue is left to go stale.
+	key_table.erase(itr);
+	delete tmp_ptr;
 
-		// ** HEY **
-		// key_id could be pointing to the string tmp_ptr->id.  so, we'd
-		// better finish using key_id *before* we delete tmp_ptr.
-		res = (key_table->remove(key_id) == 0);
-		delete tmp_ptr;
-	}
+	compactExpiryQueue();
 
-	return res;
+	return true;
 }
 
 void KeyCache::expire(KeyCacheEntry *e) {
@@ -417,22 +430,91 @@ void KeyCache::expire(KeyCacheEntry *e) {
 	free( key_id );
 }
 
+void KeyCache::queueExpiration(KeyCacheEntry *e) {
+	time_t expiration = e->expiration();
+	e->_queued_expiration = expiration;
+	if (!expiration) {
+		return;
+	}
+	m_expiry_queue.emplace_back(expiration, e->id());
+	m_queue_id_bytes += m_expiry_queue.back().second.size();
+	std::push_heap(m_expiry_queue.begin(), m_expiry_queue.end(), std::greater<ExpiryItem>());
+}
+
+void KeyCache::updateExpiration(KeyCacheEntry *e) {
+	time_t expiration = e->expiration();
+	if (!expiration || expiration == e->_queued_expiration) {
+		return;
+	}
+		// A later expiration is picked up when the queued item comes
+		// due, so only an earlier (or first) one needs a new item.
+	if (!e->_queued_expiration || expiration < e->_queued_expiration) {
+		queueExpiration(e);
+		compactExpiryQueue();
+	}
+}
+
+void KeyCache::compactExpiryQueue() {
+		// Sessions that are removed or rescheduled before they expire
+		// leave stale items behind.  Rebuild the queue from the live
+		// entries once those outnumber them, so that the queue stays
+		// proportional to the cache.
+	if (m_expiry_queue.size() < 1024 || m_expiry_queue.size() < 2 * key_table.size()) {
+		return;
+	}
+	m_expiry_queue.clear();
+	m_queue_id_bytes = 0;
+	for (auto itr = key_table.begin(); itr != key_table.end(); itr++) {
+		KeyCacheEntry *e = itr->second;
+		e->_queued_expiration = e->expiration();
+		if (e->_queued_expiration) {
+			m_expiry_queue.emplace_back(e->_queued_expiration, itr->first);
+			m_queue_id_bytes += itr->first.size();
+		}
+	}
+	std::make_heap(m_expiry_queue.begin(), m_expiry_queue.end(), std::greater<ExpiryItem>());
+}
+
 StringList * KeyCache::getExpiredKeys() {
 
 	// draw the line
     StringList * list = new StringList();
 	time_t cutoff_time = time(0);
 
-	// iterate through all entries from the hash
-	KeyCacheEntry* key_entry;
-    MyString id;
-	key_table->startIterations();
-	while (key_table->iterate(id, key_entry)) {
+	// Only the items at the top of the expiry queue are examined.
+	// An item is stale if its session is gone or has been queued again
+	// under a different time; a session whose lease was renewed since
+	// it was queued goes back in under its new expiration.  Expired
+	// sessions also go back in, since our caller may decline to remove
+	// some of them (such as the family session); the items of those it
+	// does remove are discarded as stale next time.
+	std::vector<ExpiryItem> expired;
+	while (!m_expiry_queue.empty() && m_expiry_queue.front().first <= cutoff_time) {
+		std::pop_heap(m_expiry_queue.begin(), m_expiry_queue.end(), std::greater<ExpiryItem>());
+		ExpiryItem item = m_expiry_queue.back();
+		m_expiry_queue.pop_back();
+		m_queue_id_bytes -= item.second.size();
+
+		auto itr = key_table.find(item.second);
+		if (itr == key_table.end() || itr->second->_queued_expiration != item.first) {
+			continue;
+		}
+		KeyCacheEntry *key_entry = itr->second;
+
 		// check the freshness date on that key
 		if (key_entry->expiration() && key_entry->expiration() <= cutoff_time) {
-            list->append(id.Value());
+			list->append(item.second.c_str());
+			expired.push_back(item);
 			//expire(key_entry);
 		}
+		else {
+			queueExpiration(key_entry);
+		}
+	}
+	for (auto &item : expired) {
+		m_queue_id_bytes += item.second.size();
+		m_expiry_queue.push_back(std::move(item));
+		std::push_heap(m_expiry_queue.begin(), m_expiry_queue.end(), std::greater<ExpiryItem>());
 	}
     return list;
 }
@@ -443,17 +525,14 @@ KeyCache::getKeysForPeerAddress(char const *addr)
 	if( !addr || !*addr ) {
 		return NULL;
 	}
-	SimpleList<KeyCacheEntry*> *keylist=NULL;
-	if( m_index->lookup(addr,keylist)!=0 ) {
+	auto itr = m_index.find(addr);
+	if( itr == m_index.end() ) {
 		return NULL;
 	}
-	ASSERT( keylist );
 
 	StringList *keyids = new StringList;
-	KeyCacheEntry *key=NULL;
 
-	keylist->Rewind();
-	while( keylist->Next(key) ) {
+	for( KeyCacheEntry *key : itr->second ) {
 		std::string server_addr,peer_addr;
 		ClassAd *policy = key->policy();
 
@@ -476,17 +555,14 @@ KeyCache::getKeysForProcess(char const *parent_unique_id,int pid)
 	MyString server_unique_id;
 	makeServerUniqueId(parent_unique_id,pid,&server_unique_id);
 
-	SimpleList<KeyCacheEntry*> *keylist=NULL;
-	if( m_index->lookup(server_unique_id,keylist)!=0 ) {
+	auto itr = m_index.find(server_unique_id.Value());
+	if( itr == m_index.end() ) {
 		return NULL;
 	}
-	ASSERT( keylist );
 
 	StringList *keyids = new StringList;
-	KeyCacheEntry *key=NULL;
 
-	keylist->Rewind();
-	while( keylist->Next(key) ) {
+	for( KeyCacheEntry *key : itr->second ) {
 		std::string this_parent_id;
 		MyString this_server_unique_id;
 		int this_server_pid=0;
@@ -507,6 +583,23 @@ KeyCache::getKeysForProcess(char const *parent_unique_id,int pid)
 }
 
 int KeyCache::count() {
-	ASSERT( key_table );
-	return key_table->getNumElements();
+	return (int)key_table.size();
+}
+
+size_t KeyCache::indexNodeBytes(const std::string &index) {
+	return sizeof(KeyCacheIndex::value_type) + index.size() + 2 * sizeof(void*);
+}
+
+size_t KeyCache::indexMemberBytes() {
+	return 3 * sizeof(void*);
+}
+
+size_t KeyCache::memoryFootprint() const {
+		// Everything but the session table nodes and the expiry queue's
+		// storage is counted as it's added and removed, so this doesn't
+		// have to walk the cache each time the statistics are published.
+	size_t bytes = m_entry_bytes + m_index_bytes + m_queue_id_bytes;
+	bytes += key_table.size() * (sizeof(std::string) + sizeof(KeyCacheEntry*) + 2 * sizeof(void*));
+	bytes += m_expiry_queue.capacity() * sizeof(ExpiryItem);
+	return bytes;
 }
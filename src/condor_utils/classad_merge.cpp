@@ -21,6 +21,8 @@
 #include "condor_common.h"
 #include "condor_classad.h"
 #include "classad_merge.h"
+#include "string_list.h"
+#include "condor_attributes.h"
 
 void MergeClassAds(ClassAd *merge_into, ClassAd *merge_from, 
 				   bool merge_conflicts, bool mark_dirty,
@@ -104,3 +106,104 @@ int MergeClassAdsIgnoring(ClassAd *merge_into, ClassAd *merge_from, const AttrNa
 	return cMerged;
 }
 
+
+int MakeDeltaClassAd(ClassAd & base_ad, ClassAd & new_ad,
+					 ClassAd & delta_ad, std::string & removed)
+{
+	int cChanged = 0;
+	for ( auto itr = new_ad.begin(); itr != new_ad.end(); itr++ ) {
+		ExprTree *base_expr = base_ad.Lookup(itr->first);
+		if ( !base_expr || !base_expr->SameAs(itr->second) ) {
+			delta_ad.Insert(itr->first, itr->second->Copy());
+			++cChanged;
+		}
+	}
+
+	removed.clear();
+	for ( auto itr = base_ad.begin(); itr != base_ad.end(); itr++ ) {
+		if ( !new_ad.Lookup(itr->first) ) {
+			if ( !removed.empty() ) { removed += ","; }
+			removed += itr->first;
+			++cChanged;
+		}
+	}
+	return cChanged;
+}
+
+
+int MakeDeltaClassAdFromDirty(ClassAd & base_ad, ClassAd & new_ad,
+							  ClassAd & delta_ad)
+{
+	ClassAd changed_ad;
+	int cAdded = 0;
+	for ( auto itr = new_ad.dirtyBegin(); itr != new_ad.dirtyEnd(); itr++ ) {
+		ExprTree *expr = new_ad.Lookup(*itr);
+		if ( !expr ) {
+			continue;
+		}
+		ExprTree *base_expr = base_ad.Lookup(*itr);
+		if ( !base_expr ) {
+			++cAdded;
+		}
+		if ( !base_expr || !base_expr->SameAs(expr) ) {
+			changed_ad.Insert(*itr, expr->Copy());
+		}
+	}
+
+		// An attribute deleted from new_ad is no longer dirty, so make
+		// sure the two ads will end up with the same attributes.
+	if ( new_ad.size() != base_ad.size() + cAdded ) {
+		return -1;
+	}
+	for ( auto itr = base_ad.begin(); itr != base_ad.end(); itr++ ) {
+		if ( !new_ad.Lookup(itr->first) ) {
+			return -1;
+		}
+	}
+
+	int cChanged = 0;
+	for ( auto itr = changed_ad.begin(); itr != changed_ad.end(); itr++ ) {
+		base_ad.Insert(itr->first, itr->second->Copy());
+		delta_ad.Insert(itr->first, itr->second->Copy());
+		++cChanged;
+	}
+	return cChanged;
+}
+
+
+void ApplyDeltaClassAd(ClassAd & ad, ClassAd & delta_ad, const char * removed,
+					   const AttrNameSet & ignore)
+{
+	MergeClassAdsIgnoring(&ad, &delta_ad, ignore);
+
+	if ( removed && *removed ) {
+		StringList names(removed, ",");
+		names.rewind();
+		const char *name;
+		while ( (name = names.next()) ) {
+			ad.Delete(name);
+		}
+	}
+}
+
+
+bool ExpandDeltaClassAd(ClassAd & stored_ad, ClassAd & delta_ad, ClassAd & full_ad)
+{
+		// The generation is bumped with every update, so a delta made
+		// against anything but what we have would leave us with a
+		// mixture of two versions of the ad.
+	long long base_gen = -1, stored_gen = -2;
+	delta_ad.LookupInteger(ATTR_UPDATE_DELTA_BASE, base_gen);
+	stored_ad.LookupInteger(ATTR_UPDATE_GENERATION, stored_gen);
+	if ( base_gen != stored_gen ) {
+		return false;
+	}
+
+	std::string removed;
+	delta_ad.LookupString(ATTR_UPDATE_DELTA_REMOVED, removed);
+
+	static const AttrNameSet markers = { ATTR_UPDATE_DELTA_BASE, ATTR_UPDATE_DELTA_REMOVED };
+	full_ad = stored_ad;
+	ApplyDeltaClassAd(full_ad, delta_ad, removed.c_str(), markers);
+	return true;
+}
@@ -52,4 +52,46 @@ void MergeClassAdsCleanly(ClassAd *merge_into, ClassAd *merge_from);
 int MergeClassAdsIgnoring(ClassAd *merge_into, ClassAd *merge_from,
 						  const AttrNameSet & ignore, bool mark_dirty = true);
 
+/** Compute the difference between two versions of an ad, for sending
+ *  as a delta update.
+ *  @param base_ad The version the receiver already has
+ *  @param new_ad The current version
+ *  @param delta_ad Receives copies of the attributes of new_ad that are
+ *         missing from or different in base_ad
+ *  @param removed Receives a comma separated list of the attributes of
+ *         base_ad which are missing from new_ad
+ *  @return The number of attributes added, changed or removed
+ */
+int MakeDeltaClassAd(ClassAd & base_ad, ClassAd & new_ad,
+					 ClassAd & delta_ad, std::string & removed);
+
+/** Like MakeDeltaClassAd(), for an unchained new_ad with dirty tracking
+ *  turned on by a sender which marked everything that changed since
+ *  base_ad.
+ *  Only the dirty attributes are compared, and base_ad is brought up to
+ *  date with them.  Attributes can't be removed this way.
+ *  @return The number of attributes added or changed, or -1 if base_ad
+ *          and new_ad still differ, in which case base_ad is left as it
+ *          was and the caller must use MakeDeltaClassAd() instead
+ */
+int MakeDeltaClassAdFromDirty(ClassAd & base_ad, ClassAd & new_ad,
+							  ClassAd & delta_ad);
+
+/** Apply a delta made by MakeDeltaClassAd() to a copy of its base ad.
+ *  Attributes of delta_ad in the ignore set are skipped.
+ */
+void ApplyDeltaClassAd(ClassAd & ad, ClassAd & delta_ad, const char * removed,
+					   const AttrNameSet & ignore);
+
+/** Rebuild the whole ad from a delta update (one with UpdateDeltaBase)
+ *  and the receiver's copy of the sender's ad.
+ *  @param stored_ad The ad the receiver has
+ *  @param delta_ad The delta update
+ *  @param full_ad Receives the whole ad
+ *  @return false if stored_ad is not the UpdateGeneration the delta was
+ *          made against, in which case the receiver must ask for the
+ *          whole ad
+ */
+bool ExpandDeltaClassAd(ClassAd & stored_ad, ClassAd & delta_ad, ClassAd & full_ad);
+
 #endif
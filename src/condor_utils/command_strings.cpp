@@ -74,6 +74,7 @@ const struct Translation DCTranslation[] = {
 //	{ "GIVE_PRIORITY", GIVE_PRIORITY },				/* Not used */
 	{ "MATCH_INFO", MATCH_INFO },
 	{ "ALIVE", ALIVE },
+	{ "ALIVE_BATCH", ALIVE_BATCH },
 	{ "REQUEST_CLAIM", REQUEST_CLAIM },
 	{ "RELEASE_CLAIM", RELEASE_CLAIM },
 	{ "ACTIVATE_CLAIM", ACTIVATE_CLAIM },
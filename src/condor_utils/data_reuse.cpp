@@ -36,6 +36,14 @@
 
 #include <openssl/evp.h>
 
+#ifdef LINUX
+#include <sys/ioctl.h>
+	// From linux/fs.h, which conflicts with the glibc mount headers.
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
+
 using namespace htcondor;
 
 
@@ -444,6 +452,7 @@ DataReuseDirectory::HandleEvent(ULogEvent &event, CondorError & err)
 
 			auto util_iter = m_space_utilization.insert({iter->second->getTag(), SpaceUtilization()});
 			util_iter.first->second.incWritten(comEvent.getSize());
+			util_iter.first->second.incMisses(1);
 		}
 	}
 		break;
@@ -463,6 +472,7 @@ DataReuseDirectory::HandleEvent(ULogEvent &event, CondorError & err)
 
 			auto util_iter = m_space_utilization.insert({(*iter)->tag(), SpaceUtilization()});
 			util_iter.first->second.incUsed((*iter)->size());
+			util_iter.first->second.incHits(1);
 
 			return true;
 		}
@@ -505,6 +515,60 @@ DataReuseDirectory::HandleEvent(ULogEvent &event, CondorError & err)
 }
 
 
+	// Give dest_fd the contents of source_fd and feed every byte of them to
+	// mdctx.  Where the filesystem holding both files supports it (XFS,
+	// btrfs), dest_fd shares the blocks of source_fd via a reflink instead
+	// of getting a copy; the two are still separate files, and a later
+	// write to either gets its own blocks without changing the other.  After
+	// a reflink the digest is computed by reading dest_fd back, which must
+	// then be open for reading, so that it covers exactly what dest_fd holds
+	// even if the source changed underneath us.  DATA_REUSE_CLONE_FILES
+	// turns the reflink off.  Returns false, with errno set, on a read or
+	// write error.
+static bool
+reflink_or_copy(int source_fd, int dest_fd, const std::string &source, EVP_MD_CTX *mdctx,
+	bool extra_debug)
+{
+	bool cloned = false;
+#ifdef LINUX
+	if (param_boolean("DATA_REUSE_CLONE_FILES", true)) {
+		if (0 == ioctl(dest_fd, FICLONE, source_fd)) {
+			cloned = true;
+		} else if (extra_debug) {
+			dprintf(D_FULLDEBUG, "Unable to reflink %s; will copy it instead: %s\n",
+				source.c_str(), strerror(errno));
+		}
+	}
+#endif
+
+	int read_fd = source_fd;
+	if (cloned) {
+		if (lseek(dest_fd, 0, SEEK_SET) < 0) {
+			return false;
+		}
+		read_fd = dest_fd;
+	}
+
+	std::vector<char> memory_buffer(64*1024);
+	while (true) {
+		ssize_t bytes = _condor_full_read(read_fd, &memory_buffer[0], memory_buffer.size());
+		if (bytes < 0) {
+			return false;
+		}
+		if (bytes == 0) {
+			return true;
+		}
+		if (!cloned) {
+			auto write_bytes = _condor_full_write(dest_fd, &memory_buffer[0], bytes);
+			if (write_bytes != bytes) {
+				return false;
+			}
+		}
+		EVP_DigestUpdate(mdctx, &memory_buffer[0], bytes);
+	}
+}
+
+
 bool
 DataReuseDirectory::CacheFile(const std::string &source, const std::string &checksum,
 	const std::string &checksum_type, const std::string &uuid,
@@ -590,22 +654,7 @@ DataReuseDirectory::CacheFile(const std::string &source, const std::string &chec
 	auto mdctx = EVP_MD_CTX_create();
 	EVP_DigestInit_ex(mdctx, md, NULL);
 
-	std::vector<char> memory_buffer;
-	memory_buffer.reserve(64*1024);
-	ssize_t bytes;
-	while (true) {
-		bytes = _condor_full_read(source_fd, &memory_buffer[0], 64*1024);
-		if (bytes <= 0) {
-			break;
-		}
-		auto write_bytes = _condor_full_write(dest_fd, &memory_buffer[0], bytes);
-		if (write_bytes != bytes) {
-			bytes = -1;
-			break;
-		}
-		EVP_DigestUpdate(mdctx, &memory_buffer[0], write_bytes);
-	}
-	if (bytes < 0) {
+	if (!reflink_or_copy(source_fd, dest_fd, source, mdctx, GetExtraDebug())) {
 		err.pushf("DataReuse", errno, "Failure when copying the file to cache directory: %s",
 			strerror(errno));
 		close(dest_fd);
@@ -774,7 +823,7 @@ DataReuseDirectory::RetrieveFile(const std::string &destination, const std::stri
 	int dest_fd = -1;
 	{
 		TemporaryPrivSentry sentry(PRIV_USER);
-		dest_fd = safe_open_wrapper(destination.c_str(), O_EXCL | O_CREAT | O_WRONLY);
+		dest_fd = safe_open_wrapper(destination.c_str(), O_EXCL | O_CREAT | O_RDWR);
 	}
 	if (dest_fd == -1) {
 		err.pushf("DataReuse", errno, "Unable to open cache file destination (%s): %s",
@@ -794,22 +843,7 @@ DataReuseDirectory::RetrieveFile(const std::string &destination, const std::stri
 	auto mdctx = EVP_MD_CTX_create();
 	EVP_DigestInit_ex(mdctx, md, NULL);
 
-	std::vector<char> memory_buffer;
-	memory_buffer.reserve(64*1024);
-	ssize_t bytes;
-	while (true) {
-		bytes = _condor_full_read(source_fd, &memory_buffer[0], 64*1024);
-		if (bytes <= 0) {
-			break;
-		}
-		auto write_bytes = _condor_full_write(dest_fd, &memory_buffer[0], bytes);
-		if (write_bytes != bytes) {
-			bytes = -1;
-			break;
-		}
-		EVP_DigestUpdate(mdctx, &memory_buffer[0], write_bytes);
-	}
-	if (bytes < 0) {
+	if (!reflink_or_copy(source_fd, dest_fd, source, mdctx, GetExtraDebug())) {
 		err.pushf("DataReuse", errno, "Failure when copying the file to destination: %s",
 			strerror(errno));
 		close(dest_fd);
@@ -989,6 +1023,8 @@ DataReuseDirectory::Publish(classad::ClassAd &ad)
 		global_util.incUsed(entry.second.used());
 		global_util.incWritten(entry.second.written());
 		global_util.incDeleted(entry.second.deleted());
+		global_util.incHits(entry.second.hits());
+		global_util.incMisses(entry.second.misses());
 	}
 	retval &= ad.InsertAttr("DataReuseAggregateWrittenMB",
 		static_cast<double>(global_util.written())/1000000.0);
@@ -996,6 +1032,10 @@ DataReuseDirectory::Publish(classad::ClassAd &ad)
 		static_cast<double>(global_util.used())/1000000.0);
 	retval &= ad.InsertAttr("DataReuseAggregateDeletedMB",
 		static_cast<double>(global_util.deleted())/1000000.0);
+	retval &= ad.InsertAttr("DataReuseHits",
+		static_cast<long long>(global_util.hits()));
+	retval &= ad.InsertAttr("DataReuseMisses",
+		static_cast<long long>(global_util.misses()));
 	for (const auto &entry : per_user_lifetime) {
 		retval &= ad.InsertAttr("DataReuse_" + entry.first + "_AggregateWrittenMB",
 			static_cast<double>(entry.second.written())/1000000.0);
@@ -145,14 +145,22 @@ private:
 		uint64_t used() const {return m_used;}
 		uint64_t written() const {return m_written;}
 		uint64_t deleted() const {return m_deleted;}
+		uint64_t hits() const {return m_hits;}
+		uint64_t misses() const {return m_misses;}
 
 		void incUsed(uint64_t used) {m_used += used;}
 		void incWritten(uint64_t written) {m_written += written;}
 		void incDeleted(uint64_t deleted) {m_deleted += deleted;}
+		void incHits(uint64_t hits) {m_hits += hits;}
+		void incMisses(uint64_t misses) {m_misses += misses;}
 	private:
 		uint64_t m_used{0};
 		uint64_t m_written{0};
 		uint64_t m_deleted{0};
+			// Files retrieved from the cache and files which had to be
+			// transferred and were then added to it.
+		uint64_t m_hits{0};
+		uint64_t m_misses{0};
 	};
 
 	bool ClearSpace(uint64_t size, LogSentry &sentry, CondorError &err);
@@ -52,6 +52,15 @@
 
 #include <fstream>
 #include <algorithm>
+
+#include <openssl/evp.h>
+#ifdef LINUX
+#include <sys/ioctl.h>
+	// From linux/fs.h, which conflicts with the glibc mount headers.
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -82,6 +91,9 @@ const char * const StderrRemapName = "_condor_stderr";
 //     files available.
 // 9 - ClassAd contains a list of URLs that need to be signed for the uploader
 //     to proceed.
+// 10 - ClassAd describes a file which will be sent as the chunks that differ
+//     from the download side's copy.  This command requires a response with
+//     the digests of the download side's chunks.
 enum class TransferCommand {
 	Unknown = -1,
 	Finished = 0,
@@ -98,9 +110,16 @@ enum class TransferSubCommand {
 	Unknown = -1,
 	UploadUrl = 7,
 	ReuseInfo = 8,
-	SignUrls = 9
+	SignUrls = 9,
+	DeltaFile = 10
 };
 
+	// Chunk size for delta transfers of checkpoint files, and the smallest
+	// file worth sending that way.
+static const int DELTA_CHUNK_SIZE = 1024*1024;
+static const filesize_t DELTA_MIN_FILE_SIZE = 16*DELTA_CHUNK_SIZE;
+static const int DELTA_DIGEST_SIZE = 32; // sha256
+
 #define COMMIT_FILENAME ".ccommit.con"
 
 // Filenames are case insensitive on Win32, but case sensitive on Unix
@@ -2671,6 +2690,35 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 				}
 				s->decode();
 				continue;
+			} else if (subcommand == TransferSubCommand::DeltaFile) {
+					// Files downloaded into TmpSpoolSpace replace the
+					// committed ones in SpoolSpace, so compare with those.
+				MyString delta_base = fullname;
+				size_t tmp_len = TmpSpoolSpace ? strlen(TmpSpoolSpace) : 0;
+				if (tmp_len && SpoolSpace && strncmp(fullname.Value(), TmpSpoolSpace, tmp_len) == 0 &&
+					fullname[tmp_len] == DIR_DELIM_CHAR)
+				{
+					delta_base.formatstr("%s%s", SpoolSpace, fullname.Value() + tmp_len);
+				}
+				filesize_t saved_bytes = 0;
+				rc = DownloadFileDelta(s, fullname.Value(), delta_base.Value(), file_info, this_file_max_bytes, &xfer_queue, &bytes, &saved_bytes);
+				if (rc == 1) {
+						// We have no usable copy; the whole file follows.
+					if (TransferFilePermissions) {
+						rc = s->get_file_with_permissions( &bytes, fullname.Value(), false, this_file_max_bytes, &xfer_queue );
+					} else {
+						rc = s->get_file( &bytes, fullname.Value(), false, false, this_file_max_bytes, &xfer_queue );
+					}
+				}
+				else if (rc == 0) {
+					double seconds = condor_gettimestamp_double() - thisFileStats.TransferStartTime;
+					pluginStatsAd.InsertAttr("TransferDeltaBytesSaved", (long long)saved_bytes);
+					if (bytes > 0 && seconds > 0) {
+						pluginStatsAd.InsertAttr("TransferDeltaSecondsSaved", saved_bytes * seconds / bytes);
+					}
+					dprintf(D_FULLDEBUG, "DoDownload: received %lld changed bytes of %s, saving %lld bytes\n",
+					        (long long)bytes, fullname.Value(), (long long)saved_bytes);
+				}
 			} else {
 				// unrecongized subcommand
 				dprintf(D_ALWAYS, "FILETRANSFER: unrecognized subcommand %i! skipping!\n", static_cast<int>(subcommand));
@@ -3714,6 +3762,12 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 	bool I_go_ahead_always = false;
 	bool peer_goes_ahead_always = false;
 	DCTransferQueue xfer_queue(m_xfer_queue_contact_info);
+		// Once neither side waits for a GoAhead per file, the headers
+		// and contents of the files are streamed back to back; cork
+		// the socket then, so many small files fill whole packets.
+	bool coalesce_writes = param_boolean("FILE_TRANSFER_COALESCE_WRITES", true);
+	bool corked = false;
+	bool delta_checkpoints = param_boolean("FILE_TRANSFER_DELTA_CHECKPOINTS", true);
 
 		// Declaration to make the return_and_reset_priv macro happy.
         std::string reservation_id;
@@ -4259,6 +4313,16 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 			currentUploadDeferred = 0;
 		}
 
+			// Self-checkpointing jobs often rewrite large checkpoint
+			// files of which little has changed; send only the changes.
+		if( file_command == TransferCommand::XferFile && uploadCheckpointFiles &&
+			PeerDoesDeltaFiles && delta_checkpoints && !fileitem.isDirectory() &&
+			fileitem.fileSize() >= DELTA_MIN_FILE_SIZE )
+		{
+			file_command = TransferCommand::Other;
+			file_subcommand = TransferSubCommand::DeltaFile;
+		}
+
 		bool fail_because_mkdir_not_supported = false;
 		bool fail_because_symlink_not_supported = false;
 		if( fileitem.isDirectory() ) {
@@ -4364,6 +4428,15 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 		// then this would provide a natural synchronization point.
 		bool can_defer_uploads = !PeerDoesGoAhead || (peer_goes_ahead_always && I_go_ahead_always);
 
+			// The x509 delegation and delta protocols wait for replies,
+			// so do not hold their messages back.
+		bool want_cork = coalesce_writes && can_defer_uploads &&
+			file_command != TransferCommand::XferX509 &&
+			file_subcommand != TransferSubCommand::DeltaFile;
+		if( want_cork != corked ) {
+			corked = s->set_tcp_cork( want_cork ) && want_cork;
+		}
+
 		UpdateXferStatus(XFER_STATUS_ACTIVE);
 
 		filesize_t this_file_max_bytes = -1;
@@ -4487,6 +4560,22 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 					sPrintAd(junkbuf, file_info);
 					bytes = junkbuf.Length();
 				}
+			} else if (file_subcommand == TransferSubCommand::DeltaFile) {
+				file_info.Assign("Filename", dest_filename.Value());
+				filesize_t saved_bytes = 0;
+				rc = UploadFileDelta(s, fullname.Value(), file_info, this_file_max_bytes, &xfer_queue, &bytes, &saved_bytes);
+				if (rc == 1) {
+						// The receiver has no usable copy; send the whole file.
+					if ( TransferFilePermissions ) {
+						rc = s->put_file_with_permissions( &bytes, fullname.Value(), this_file_max_bytes, &xfer_queue );
+					} else {
+						rc = s->put_file( &bytes, fullname.Value(), 0, this_file_max_bytes, &xfer_queue );
+					}
+				}
+				else if (rc == 0) {
+					dprintf(D_FULLDEBUG, "DoUpload: sent %lld changed bytes of %s, saving %lld bytes\n",
+					        (long long)bytes, fullname.Value(), (long long)saved_bytes);
+				}
 			} else {
 				dprintf( D_ALWAYS, "DoUpload: invalid subcommand %i, skipping %s.",
 						static_cast<int>(file_subcommand), filename.c_str());
@@ -4658,6 +4747,11 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 			Info.addSpooledFile( dest_filename.Value() );
 		}
 	}
+	if( corked ) {
+		s->set_tcp_cork( false );
+		corked = false;
+	}
+
 	// Release transfer queue slot after file has been put but before the
 	// final transfer statistics are done.  The remote side (typically, the starter),
 	// currently does multifile transfer plugins during this time and we do not want
@@ -5034,6 +5128,303 @@ FileTransfer::DoReceiveTransferGoAhead(
 	return true;
 }
 
+	// Reads the whole file, appending the sha256 digest of each chunk,
+	// and copying it to copy_fd if that is not -1.
+static bool
+ComputeChunkDigests(int fd, int chunk_size, std::vector<unsigned char> &digests, int copy_fd)
+{
+	std::vector<char> buf(chunk_size);
+	while (true) {
+		ssize_t n = _condor_full_read(fd, &buf[0], chunk_size);
+		if (n < 0) {
+			return false;
+		}
+		if (n == 0) {
+			return true;
+		}
+		unsigned char md[EVP_MAX_MD_SIZE];
+		unsigned int md_len = 0;
+		if (!EVP_Digest(&buf[0], n, md, &md_len, EVP_sha256(), NULL) || md_len != DELTA_DIGEST_SIZE) {
+			return false;
+		}
+		digests.insert(digests.end(), md, md + md_len);
+		if (copy_fd != -1 && _condor_full_write(copy_fd, &buf[0], n) != n) {
+			return false;
+		}
+		if (n < chunk_size) {
+			return true;
+		}
+	}
+}
+
+int
+FileTransfer::UploadFileDelta(ReliSock *s, const char *fullname, ClassAd &file_info, filesize_t max_bytes, DCTransferQueue *xfer_queue, filesize_t *bytes, filesize_t *saved_bytes)
+{
+	*bytes = 0;
+	*saved_bytes = 0;
+
+		// If we cannot read the file, or it is bigger than we may send,
+		// the receiver is told there is no file and asks for the whole
+		// thing, and put_file() reports the error.
+	filesize_t file_size = -1;
+	int fd = safe_open_wrapper_follow(fullname, O_RDONLY | _O_BINARY, 0);
+	if (fd >= 0) {
+		struct stat st;
+		if (fstat(fd, &st) == 0 && (max_bytes < 0 || st.st_size <= max_bytes)) {
+			file_size = st.st_size;
+#ifndef WIN32
+			if (TransferFilePermissions) {
+				file_info.Assign("FileMode", (int)(st.st_mode & 07777));
+			}
+#endif
+		} else {
+			close(fd);
+			fd = -1;
+		}
+	}
+	file_info.Assign("FileSize", file_size);
+	file_info.Assign("ChunkSize", DELTA_CHUNK_SIZE);
+	if (!putClassAd(s, file_info) || !s->end_of_message()) {
+		dprintf(D_ALWAYS, "DoUpload: failed to send delta transfer request for %s\n", fullname);
+		if (fd >= 0) close(fd);
+		return -1;
+	}
+
+	ClassAd reply;
+	int result = 1;
+	int count = 0;
+	s->decode();
+	if (!getClassAd(s, reply) || !s->code(count) || count < 0) {
+		dprintf(D_ALWAYS, "DoUpload: failed to receive chunk digests for %s\n", fullname);
+		if (fd >= 0) close(fd);
+		return -1;
+	}
+	reply.LookupInteger("Result", result);
+	std::vector<unsigned char> digests((size_t)count * DELTA_DIGEST_SIZE);
+	if ((count && s->get_bytes(&digests[0], (int)digests.size()) != (int)digests.size()) ||
+		!s->end_of_message())
+	{
+		dprintf(D_ALWAYS, "DoUpload: failed to receive chunk digests for %s\n", fullname);
+		if (fd >= 0) close(fd);
+		return -1;
+	}
+	s->encode();
+
+	if (result != 0 || fd < 0) {
+		if (fd >= 0) close(fd);
+		return 1;
+	}
+
+		// ReliSock holds a whole message in memory on the receiving
+		// side, so each changed chunk goes in its own message.  Chunks
+		// past the size we announced are not sent; the terminating
+		// index is ended by our caller.
+	std::vector<char> buf(DELTA_CHUNK_SIZE);
+	filesize_t sent = 0;
+	filesize_t offset = 0;
+	for (int64_t index = 0; offset < file_size; index++) {
+		ssize_t n = _condor_full_read(fd, &buf[0], DELTA_CHUNK_SIZE);
+		if (n < 0) {
+			dprintf(D_ALWAYS, "DoUpload: failed to read %s: %s\n", fullname, strerror(errno));
+			close(fd);
+			return -1;
+		}
+		if (n == 0) {
+			break;
+		}
+		if (n > file_size - offset) {
+			n = file_size - offset;
+		}
+		offset += n;
+		unsigned char md[EVP_MAX_MD_SIZE];
+		unsigned int md_len = 0;
+		EVP_Digest(&buf[0], n, md, &md_len, EVP_sha256(), NULL);
+		if (index >= count || md_len != DELTA_DIGEST_SIZE ||
+			memcmp(md, &digests[index * DELTA_DIGEST_SIZE], DELTA_DIGEST_SIZE) != 0)
+		{
+			int len = (int)n;
+			if (!s->code(index) || !s->code(len) || s->put_bytes(&buf[0], len) != len ||
+				!s->end_of_message())
+			{
+				dprintf(D_ALWAYS, "DoUpload: failed to send chunk of %s\n", fullname);
+				close(fd);
+				return -1;
+			}
+			sent += n;
+			if (xfer_queue) {
+				xfer_queue->AddBytesSent(len);
+				xfer_queue->ConsiderSendingReport();
+			}
+		}
+		if (n < DELTA_CHUNK_SIZE) {
+			break;
+		}
+	}
+	close(fd);
+	if (offset < file_size) {
+			// the receiver would keep the end of its old copy
+		dprintf(D_ALWAYS, "DoUpload: %s shrank while it was being sent\n", fullname);
+		return -1;
+	}
+
+	int64_t done = -1;
+	if (!s->code(done)) {
+		return -1;
+	}
+	*bytes = sent;
+	*saved_bytes = file_size > sent ? file_size - sent : 0;
+	return 0;
+}
+
+int
+FileTransfer::DownloadFileDelta(ReliSock *s, const char *fullname, const char *base_name, ClassAd &file_info, filesize_t max_bytes, DCTransferQueue *xfer_queue, filesize_t *bytes, filesize_t *saved_bytes)
+{
+	*bytes = 0;
+	*saved_bytes = 0;
+
+	long long file_size = -1;
+	int chunk_size = 0;
+	file_info.LookupInteger("FileSize", file_size);
+	file_info.LookupInteger("ChunkSize", chunk_size);
+	if (!s->end_of_message()) {
+		return -1;
+	}
+
+		// Without an existing copy to start from, ask for the whole file.
+		// The chunks are compared with base_name, which for a download
+		// into TmpSpoolSpace is the committed copy in SpoolSpace; the
+		// result is written to fullname, so that the committed copy is
+		// untouched until the transfer is committed.  Where the
+		// filesystem supports it, fullname starts out as a reflink of
+		// base_name, sharing its blocks; otherwise base_name is copied,
+		// which costs a local write of the whole file, but still not
+		// sending it.
+	int result = 1;
+	int fd = -1;
+	std::vector<unsigned char> digests;
+#ifndef WIN32
+	if (file_size >= 0 && chunk_size > 0 && chunk_size <= 64*DELTA_CHUNK_SIZE &&
+		(max_bytes < 0 || file_size <= max_bytes) && strcmp(fullname, NULL_FILE) != 0)
+	{
+		if (strcmp(base_name, fullname) == 0) {
+			fd = safe_open_wrapper_follow(fullname, O_RDWR, 0);
+			if (fd >= 0 && ComputeChunkDigests(fd, chunk_size, digests, -1)) {
+				result = 0;
+			}
+		} else {
+			int base_fd = safe_open_wrapper_follow(base_name, O_RDONLY, 0);
+			if (base_fd >= 0) {
+				fd = safe_open_wrapper_follow(fullname, O_RDWR | O_CREAT | O_TRUNC, 0600);
+				if (fd >= 0) {
+					bool cloned = false;
+#ifdef LINUX
+					cloned = ioctl(fd, FICLONE, base_fd) == 0;
+					if (!cloned) {
+						dprintf(D_FULLDEBUG, "DoDownload: unable to reflink %s; will copy it instead: %s\n",
+						        base_name, strerror(errno));
+					}
+#endif
+					if (cloned) {
+						if (lseek(fd, 0, SEEK_SET) == 0 &&
+							ComputeChunkDigests(fd, chunk_size, digests, -1))
+						{
+							result = 0;
+						}
+					} else if (ComputeChunkDigests(base_fd, chunk_size, digests, fd)) {
+						result = 0;
+					}
+				}
+				close(base_fd);
+			}
+		}
+	}
+#endif
+
+	ClassAd reply;
+	reply.InsertAttr("Result", result);
+	int count = result == 0 ? (int)(digests.size() / DELTA_DIGEST_SIZE) : 0;
+	s->encode();
+	if (!putClassAd(s, reply) || !s->code(count) ||
+		(count && s->put_bytes(&digests[0], (int)digests.size()) != (int)digests.size()) ||
+		!s->end_of_message())
+	{
+		dprintf(D_ALWAYS, "DoDownload: failed to send chunk digests for %s\n", fullname);
+		if (fd >= 0) close(fd);
+		return -1;
+	}
+	s->decode();
+
+	if (result != 0) {
+		if (fd >= 0) close(fd);
+		return 1;
+	}
+
+		// Patch the changed chunks in.  Every chunk must lie within the
+		// file size announced, which we checked against max_bytes.  On a
+		// write error, keep reading so the wire protocol stays in a well
+		// defined state.
+	int64_t num_chunks = (file_size + chunk_size - 1) / chunk_size;
+	std::vector<char> buf(chunk_size);
+	filesize_t received = 0;
+	int write_errno = 0;
+	while (true) {
+		int64_t index = -1;
+		int len = 0;
+		if (!s->code(index)) {
+			close(fd);
+			return -1;
+		}
+		if (index < 0) {
+			break;
+		}
+		if (index >= num_chunks || !s->code(len) ||
+			len <= 0 || len > chunk_size || len > file_size - index * chunk_size)
+		{
+			dprintf(D_ALWAYS, "DoDownload: received invalid chunk %lld (length %d) of %s, which is %lld bytes\n",
+			        (long long)index, len, fullname, file_size);
+			close(fd);
+			return -1;
+		}
+		if (s->get_bytes(&buf[0], len) != len || !s->end_of_message()) {
+			dprintf(D_ALWAYS, "DoDownload: failed to receive chunk of %s\n", fullname);
+			close(fd);
+			return -1;
+		}
+		received += len;
+		if (xfer_queue) {
+			xfer_queue->AddBytesReceived(len);
+			xfer_queue->ConsiderSendingReport();
+		}
+#ifndef WIN32
+		if (!write_errno && pwrite(fd, &buf[0], len, (off_t)index * chunk_size) != len) {
+			write_errno = errno ? errno : EIO;
+		}
+#endif
+	}
+	if (!write_errno && ftruncate(fd, file_size) < 0) {
+		write_errno = errno;
+	}
+#ifndef WIN32
+	int file_mode = 0;
+	if (!write_errno && file_info.LookupInteger("FileMode", file_mode) && file_mode > 0) {
+		if (fchmod(fd, (mode_t)(file_mode & 07777)) < 0) {
+			write_errno = errno;
+		}
+	}
+#endif
+	if (close(fd) < 0 && !write_errno) {
+		write_errno = errno;
+	}
+
+	*bytes = received;
+	if (write_errno) {
+		errno = write_errno;
+		return GET_FILE_WRITE_FAILED;
+	}
+	*saved_bytes = file_size > received ? file_size - received : 0;
+	return 0;
+}
+
 int
 FileTransfer::ExitDoUpload(const filesize_t *total_bytes, int numFiles, ReliSock *s, priv_state saved_priv, bool socket_default_crypto, bool upload_success, bool do_upload_ack, bool do_download_ack, bool try_again, int hold_code, int hold_subcode, char const *upload_error_desc,int DoUpload_exit_line)
 {
@@ -5045,6 +5436,9 @@ FileTransfer::ExitDoUpload(const filesize_t *total_bytes, int numFiles, ReliSock
 
 	dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",DoUpload_exit_line);
 
+		// we may be about to wait for the peer's ack
+	s->set_tcp_cork( false );
+
 	if( saved_priv != PRIV_UNKNOWN ) {
 		_set_priv(saved_priv,__FILE__,DoUpload_exit_line,1);
 	}
@@ -5338,6 +5732,7 @@ FileTransfer::setPeerVersion( const CondorVersionInfo &peer_version )
 
 	PeerDoesReuseInfo = peer_version.built_since_version(8,9,4);
 	PeerDoesS3Urls = peer_version.built_since_version(8,9,4);
+	PeerDoesDeltaFiles = peer_version.built_since_version(8,9,10);
 }
 
 
@@ -407,6 +407,7 @@ class FileTransfer final: public Service {
 	bool PeerDoesXferInfo{false};
 	bool PeerDoesReuseInfo{false};
 	bool PeerDoesS3Urls{false};
+	bool PeerDoesDeltaFiles{false};
 	bool TransferUserLog{false};
 	char* Iwd{nullptr};
 	StringList* ExceptionFiles{nullptr};
@@ -494,6 +495,16 @@ class FileTransfer final: public Service {
 	// called to lookup the catalog entry of file
 	bool LookupInFileCatalog(const char *fname, time_t *mod_time, filesize_t *filesize);
 
+	// Send only the chunks of a file which differ from the receiver's
+	// copy; used for checkpoint files.  Returns 0 on success, 1 if the
+	// receiver wants the whole file instead, or < 0 on failure.
+	int UploadFileDelta(ReliSock *s, const char *fullname, ClassAd &file_info, filesize_t max_bytes, DCTransferQueue *xfer_queue, filesize_t *bytes, filesize_t *saved_bytes);
+
+	// Receiving side of UploadFileDelta(): writes fullname from the
+	// chunks of base_name and the changed chunks from the peer.  The
+	// two may be the same file, which is then patched in place.
+	int DownloadFileDelta(ReliSock *s, const char *fullname, const char *base_name, ClassAd &file_info, filesize_t max_bytes, DCTransferQueue *xfer_queue, filesize_t *bytes, filesize_t *saved_bytes);
+
 	// Called internally by DoUpload() in order to handle common wrapup tasks.
 	int ExitDoUpload(const filesize_t *total_bytes, int numFiles, ReliSock *s, priv_state saved_priv, bool socket_default_crypto, bool upload_success, bool do_upload_ack, bool do_download_ack, bool try_again, int hold_code, int hold_subcode, char const *upload_error_desc,int DoUpload_exit_line);
 
@@ -236,6 +236,7 @@ ForkWork::Reaper( int exitPid, int /*exitStatus*/ )
 		if ( worker->getPid() == exitPid ) {
 			workerList.DeleteCurrent( );
 			delete worker;	
+			WorkerReaped( exitPid );
 		return 0;
 		}
 	}
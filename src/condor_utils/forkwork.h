@@ -67,6 +67,11 @@ class ForkWork : public Service
 	int DeleteAll( void );
 	int KillAll( bool force );
 
+  protected:
+	// Called in the parent after a worker exits, once it has been
+	// removed from the worker list, so a subclass can start more work
+	virtual void WorkerReaped( pid_t /*pid*/ ) { }
+
   private:
 	virtual int Reaper( int exitPid, int exitStatus );
 
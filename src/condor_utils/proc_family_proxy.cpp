@@ -534,6 +534,14 @@ ProcFamilyProxy::start_procd()
 		args.AppendArg(min_tracking_gid);
 		args.AppendArg(max_tracking_gid);
 	}
+
+	// track processes via the kernel's process events, only scanning
+	// all processes on the system every so often to reconcile
+	//
+	if (param_boolean("PROCD_USE_PROCESS_EVENTS", false)) {
+		args.AppendArg("-N");
+		args.AppendArg(param_integer("PROCD_RECONCILE_INTERVAL", 300, 1));
+	}
 #endif
 
 	// for the GLEXEC_JOB feature, we'll need to pass the ProcD paths